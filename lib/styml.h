@@ -39,12 +39,25 @@
 
 #include <stdarg.h>
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <cassert>
+#include <charconv>
 #include <climits>
 #include <cstring>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <map>
 #include <memory>
+#include <optional>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -53,13 +66,37 @@
 #pragma intrinsic(_umul128)  // For Wyhash
 #endif
 
-// Macros for likely and unlikely branching
+// Macros for likely and unlikely branching, and for memory prefetching
 #if defined(__GNUC__) || defined(__INTEL_COMPILER) || defined(__clang__)
 #define STYML_LIKELY(x)   __builtin_expect(!!(x), 1)
 #define STYML_UNLIKELY(x) __builtin_expect(!!(x), 0)
+#define STYML_PREFETCH(p) __builtin_prefetch(p)
 #else
 #define STYML_LIKELY(x)   (x)
 #define STYML_UNLIKELY(x) (x)
+#define STYML_PREFETCH(p) (void)(p)
+#endif
+
+// Macro to hint the processor inside a spin-wait loop
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#define STYML_CPU_RELAX() _mm_pause()
+#elif defined(_MSC_VER) && defined(_M_ARM64)
+#define STYML_CPU_RELAX() __yield()
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define STYML_CPU_RELAX() __builtin_ia32_pause()
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__aarch64__) || defined(__arm__))
+#define STYML_CPU_RELAX() __asm__ __volatile__("yield")
+#else
+#define STYML_CPU_RELAX() (void)0
+#endif
+
+// Macro to keep the rare paths out of the hot functions
+#if defined(__GNUC__) || defined(__clang__)
+#define STYML_NOINLINE __attribute__((noinline))
+#elif defined(_MSC_VER)
+#define STYML_NOINLINE __declspec(noinline)
+#else
+#define STYML_NOINLINE
 #endif
 
 // Macro to check the printf-like API and detect formatting mismatch at compile time
@@ -161,6 +198,157 @@ inline void STYML_PRINTF_CHECK(3, 4) throwParsing(int lineNbr, const char* lineS
 // Built-in conversions versus string
 // ==========================================================================================
 
+namespace detail
+{
+
+// Reference counted memory block, so that the storage of a context can be shared with its read-only snapshots. The counter and the
+// cache line aligned payload are in a single allocation
+class SharedBuffer
+{
+    static constexpr size_t CacheLineSize = 64;
+
+   public:
+    static SharedBuffer* create(size_t byteQty)
+    {
+        uint8_t* alloc = new uint8_t[sizeof(SharedBuffer) + byteQty + CacheLineSize];
+        return new (alloc) SharedBuffer(alloc);
+    }
+    SharedBuffer(const SharedBuffer& rhs)            = delete;
+    SharedBuffer& operator=(const SharedBuffer& rhs) = delete;
+
+    uint8_t* data() const { return _data; }
+    bool     isShared() const { return _refQty.load(std::memory_order_acquire) > 1; }
+    void     acquire() { _refQty.fetch_add(1, std::memory_order_relaxed); }
+
+    // Returns true if the last reference was released. The caller shall then destroy the payload and call 'destroy'
+    bool release() { return _refQty.fetch_sub(1, std::memory_order_acq_rel) == 1; }
+    void destroy()
+    {
+        this->~SharedBuffer();
+        delete[] (uint8_t*)this;
+    }
+
+   private:
+    explicit SharedBuffer(uint8_t* alloc)
+        : _data((uint8_t*)(((uintptr_t)alloc + sizeof(SharedBuffer) + CacheLineSize - 1) & ~(uintptr_t)(CacheLineSize - 1)))  // NOLINT
+    {
+    }
+    ~SharedBuffer() = default;
+
+    std::atomic<uint32_t> _refQty{1};
+    uint8_t*              _data;
+};
+
+// Append-only storage of the strings of a document. The buffer can be shared with read-only snapshots (see 'share'): the shared
+// bytes are never modified, as the new strings are written after them, in place or in a new buffer when the capacity is exceeded
+class Arena
+{
+   public:
+    Arena() = default;
+    Arena(const Arena& rhs)  // Deep copy
+    {
+        reserve(rhs._size);
+        if (rhs._size > 0) { memcpy(_data, rhs._data, rhs._size); }
+        _size = rhs._size;
+    }
+    Arena& operator=(const Arena& rhs) = delete;
+    ~Arena() { releaseBuffer(); }
+
+    uint8_t*       data() { return _data; }
+    const uint8_t* data() const { return _data; }
+    size_t         size() const { return _size; }
+    bool           empty() const { return _size == 0; }
+    uint8_t&       back() { return _data[_size - 1]; }
+
+    void reserve(size_t capacity)
+    {
+        if (capacity > _capacity) { reallocate(capacity); }
+    }
+
+    void resize(size_t size)
+    {
+        if (size > _capacity) {
+            reallocate(std::max(size, 2 * _capacity));
+        } else if (STYML_UNLIKELY(size < _sharedSize)) {
+            reallocate(_capacity);  // The truncated bytes may still be read by a snapshot
+        }
+        _size = size;
+    }
+
+    void push_back(uint8_t c)
+    {
+        resize(_size + 1);
+        _data[_size - 1] = c;
+    }
+
+    // Makes 'snapshot' a read-only arena reading the current bytes from the same buffer
+    void share(Arena& snapshot)
+    {
+        snapshot.releaseBuffer();
+        if (_buffer) { _buffer->acquire(); }
+        snapshot._buffer = _buffer;
+        snapshot._data   = _data;
+        snapshot._size   = _size;
+        snapshot.setReadOnly();
+        _sharedSize = _size;
+    }
+
+    // Makes any later write throw. Without spare capacity, all the writes go through 'reallocate', which performs the check
+    void setReadOnly()
+    {
+        _capacity   = _size;
+        _isReadOnly = true;
+    }
+
+   private:
+    STYML_NOINLINE void reallocate(size_t capacity)
+    {
+        if (_isReadOnly) { throw AccessException("Access error: a read-only document cannot be modified"); }
+        SharedBuffer* buffer = SharedBuffer::create(capacity);
+        if (_size > 0) { memcpy(buffer->data(), _data, std::min(_size, capacity)); }
+        releaseBuffer();
+        _buffer     = buffer;
+        _data       = buffer->data();
+        _capacity   = capacity;
+        _sharedSize = 0;
+    }
+
+    void releaseBuffer()
+    {
+        if (_buffer && _buffer->release()) { _buffer->destroy(); }
+        _buffer = nullptr;
+    }
+
+    SharedBuffer* _buffer     = nullptr;
+    uint8_t*      _data       = nullptr;
+    size_t        _size       = 0;
+    size_t        _capacity   = 0;
+    size_t        _sharedSize = 0;  // Bytes which may be read by a snapshot
+    bool          _isReadOnly = false;
+};
+
+}  // namespace detail
+
+// Appends an encoded value directly in the string storage of the document.
+// It is provided to the optional 'encodeTo' converter function, which avoids the temporary std::string of 'encode'
+class Writer
+{
+   public:
+    explicit Writer(detail::Arena& storage) : _storage(storage) {}
+
+    void write(const char* text, size_t textSize)
+    {
+        size_t startIdx = _storage.size();
+        _storage.resize(startIdx + textSize);
+        if (textSize > 0) { memcpy(_storage.data() + startIdx, text, textSize); }
+    }
+    void write(const char* text) { write(text, strlen(text)); }
+    void write(char c) { _storage.push_back((uint8_t)c); }
+
+   private:
+    detail::Arena& _storage;
+};
+
 template<class T, class Enable = void>
 struct convert {
     static std::string encode(const T& /*typedValue*/)
@@ -177,80 +365,320 @@ struct convert {
 template<>
 struct convert<const char*> {
     static std::string encode(const char* typedValue) { return std::string(typedValue); }
+    static void        encodeTo(const char* typedValue, Writer& writer) { writer.write(typedValue); }
     static void        decode(const char* strValue, const char*& typedValue) { typedValue = strValue; }
 };
 
 template<std::size_t N>
 struct convert<char[N]> {
     static std::string encode(const char* typedValue) { return std::string(typedValue); }
+    static void        encodeTo(const char* typedValue, Writer& writer) { writer.write(typedValue); }
 };
 
 template<>
 struct convert<std::string> {
     static std::string encode(const std::string& typedValue) { return typedValue; }
+    static void        encodeTo(const std::string& typedValue, Writer& writer) { writer.write(typedValue.data(), typedValue.size()); }
     static void        decode(const char* strValue, std::string& typedValue) { typedValue = strValue; }
 };
 
+namespace detail
+{
+
+enum class DecodeStatus { Ok, Invalid, TrailingChars, OutOfRange };
+
+// Parses 8 decimal digits at once (SWAR). Returns false if one of the characters is not a digit
+inline bool
+parseEightDigits(const char* text, uint64_t& value)
+{
+    uint64_t chunk;  // NOLINT(cppcoreguidelines-init-variables)
+    memcpy(&chunk, text, 8);
+    if ((chunk & 0xF0F0F0F0F0F0F0F0ULL) != 0x3030303030303030ULL ||
+        ((chunk + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) != 0x3030303030303030ULL) {
+        return false;
+    }
+    // Digits are combined by pairs, then quadruplets, then octets (the first character is the least significant byte)
+    chunk = (chunk & 0x0F0F0F0F0F0F0F0FULL) * 10 + ((chunk >> 8) & 0x0F0F0F0F0F0F0F0FULL);
+    chunk = (chunk & 0x000000FF000000FFULL) * 100 + ((chunk >> 16) & 0x000000FF000000FFULL);
+    value = (chunk & 0x000000000000FFFFULL) * 10000 + ((chunk >> 32) & 0x000000000000FFFFULL);
+    return true;
+}
+
+// Parses a plain decimal number. Returns false if the fast path does not apply (not only digits, or too many of them to be
+// sure that there is no overflow), in which case the generic parsing shall be used
+inline bool
+parseDecimalFast(const char* ptr, const char* endPtr, uint64_t& magnitude)
+{
+    if (ptr == endPtr || endPtr - ptr > 19) { return false; }
+    uint64_t value = 0;
+#if defined(_MSC_VER) || (defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+    uint64_t chunk = 0;
+    while (endPtr - ptr >= 8) {
+        if (!parseEightDigits(ptr, chunk)) { return false; }
+        value = value * 100000000ULL + chunk;
+        ptr += 8;
+    }
+#endif
+    while (ptr < endPtr) {
+        uint32_t digit = (uint32_t)(*ptr - '0');
+        if (digit > 9) { return false; }
+        value = value * 10 + digit;
+        ++ptr;
+    }
+    magnitude = value;
+    return true;
+}
+
+// Parses an integer with the same syntax as 'strtoll' in base 0 (optional sign, '0x' hexadecimal and '0' octal prefixes), but
+// locale-independent. The result is provided as a sign and a magnitude, so that it can be narrowed to any integer type
+inline DecodeStatus
+parseInteger(const char* strValue, uint32_t strSize, uint64_t& magnitude, bool& isNegative)
+{
+    const char* ptr    = strValue;
+    const char* endPtr = strValue + strSize;
+    isNegative         = false;
+    if (ptr < endPtr && (*ptr == '+' || *ptr == '-')) {
+        isNegative = (*ptr == '-');
+        ++ptr;
+    }
+    int base = 10;
+    if (endPtr - ptr >= 2 && ptr[0] == '0' && (ptr[1] == 'x' || ptr[1] == 'X')) {
+        base = 16;
+        ptr += 2;
+    } else if (endPtr - ptr >= 2 && ptr[0] == '0') {
+        base = 8;
+        ptr += 1;
+    }
+    if (base == 10 && parseDecimalFast(ptr, endPtr, magnitude)) { return DecodeStatus::Ok; }
+
+    auto [lastPtr, ec] = std::from_chars(ptr, endPtr, magnitude, base);
+    if (ec == std::errc::invalid_argument) { return DecodeStatus::Invalid; }
+    if (ec == std::errc::result_out_of_range) { return DecodeStatus::OutOfRange; }
+    if (lastPtr != endPtr) { return DecodeStatus::TrailingChars; }
+    return DecodeStatus::Ok;
+}
+
+inline DecodeStatus
+parseInteger(const char* strValue, uint64_t& magnitude, bool& isNegative)
+{
+    return parseInteger(strValue, (uint32_t)strlen(strValue), magnitude, isNegative);
+}
+
+// Range-checks a parsed integer against the target type
+template<class Int>
+inline DecodeStatus
+narrowInteger(uint64_t magnitude, bool isNegative, Int& typedValue)
+{
+    if constexpr (std::is_signed<Int>::value) {
+        if (isNegative) {
+            if (magnitude > (uint64_t)(std::numeric_limits<Int>::max)() + 1) { return DecodeStatus::OutOfRange; }
+            typedValue = (magnitude == 0) ? (Int)0 : (Int)(-(int64_t)(magnitude - 1) - 1);
+            return DecodeStatus::Ok;
+        }
+    } else {
+        if (isNegative && magnitude != 0) { return DecodeStatus::OutOfRange; }
+    }
+    if (magnitude > (uint64_t)(std::numeric_limits<Int>::max)()) { return DecodeStatus::OutOfRange; }
+    typedValue = (Int)magnitude;
+    return DecodeStatus::Ok;
+}
+
+template<class Int>
+inline DecodeStatus
+decodeInteger(const char* strValue, Int& typedValue)
+{
+    uint64_t     magnitude  = 0;
+    bool         isNegative = false;
+    DecodeStatus status     = parseInteger(strValue, magnitude, isNegative);
+    if (status != DecodeStatus::Ok) { return status; }
+    return narrowInteger(magnitude, isNegative, typedValue);
+}
+
+// Decodes a floating point, locale-independent. A leading '+' is accepted, as with 'strtod'
+template<class Float>
+inline DecodeStatus
+decodeFloat(const char* strValue, uint32_t strSize, Float& typedValue)
+{
+    const char* ptr    = strValue;
+    const char* endPtr = strValue + strSize;
+    if (ptr < endPtr && *ptr == '+') { ++ptr; }
+
+    auto [lastPtr, ec] = std::from_chars(ptr, endPtr, typedValue);
+    if (ec == std::errc::invalid_argument) { return DecodeStatus::Invalid; }
+    if (ec == std::errc::result_out_of_range) { return DecodeStatus::OutOfRange; }
+    if (lastPtr != endPtr) { return DecodeStatus::TrailingChars; }
+    return DecodeStatus::Ok;
+}
+
+template<class Float>
+inline DecodeStatus
+decodeFloat(const char* strValue, Float& typedValue)
+{
+    return decodeFloat(strValue, (uint32_t)strlen(strValue), typedValue);
+}
+
+// Decodes a boolean from the StrictYAML literals, case insensitive: 'true', 'yes', 'on', 'y' and '1', or 'false', 'no', 'off',
+// 'n' and '0'
+inline DecodeStatus
+decodeBool(const char* strValue, uint32_t strSize, bool& typedValue)
+{
+    constexpr const char* trueLiterals[]  = {"true", "yes", "on", "y", "1"};
+    constexpr const char* falseLiterals[] = {"false", "no", "off", "n", "0"};
+    char                  lowered[6]      = {0};
+    if (strSize >= sizeof(lowered)) { return DecodeStatus::Invalid; }
+    for (uint32_t i = 0; i < strSize; ++i) {
+        lowered[i] = (strValue[i] >= 'A' && strValue[i] <= 'Z') ? (char)(strValue[i] - 'A' + 'a') : strValue[i];
+    }
+    for (const char* literal : trueLiterals) {
+        if (strcmp(lowered, literal) == 0) {
+            typedValue = true;
+            return DecodeStatus::Ok;
+        }
+    }
+    for (const char* literal : falseLiterals) {
+        if (strcmp(lowered, literal) == 0) {
+            typedValue = false;
+            return DecodeStatus::Ok;
+        }
+    }
+    return DecodeStatus::Invalid;
+}
+
+// Decodes any built-in number from a string of known size
+template<class Number>
+inline DecodeStatus
+decodeNumber(const char* strValue, uint32_t strSize, Number& typedValue)
+{
+    if constexpr (std::is_same<Number, bool>::value) {
+        return decodeBool(strValue, strSize, typedValue);
+    } else if constexpr (std::is_integral<Number>::value) {
+        uint64_t     magnitude  = 0;
+        bool         isNegative = false;
+        DecodeStatus status     = parseInteger(strValue, strSize, magnitude, isNegative);
+        if (status != DecodeStatus::Ok) { return status; }
+        return narrowInteger(magnitude, isNegative, typedValue);
+    } else {
+        return decodeFloat(strValue, strSize, typedValue);
+    }
+}
+
+// Encodes a number with its shortest representation which round-trips exactly (also for floating points).
+// Returns the size of the encoded number in the provided buffer
+template<class Number>
+inline size_t
+encodeNumber(const Number& typedValue, char (&buffer)[64])
+{
+    using CharsType    = std::conditional_t<std::is_same<Number, bool>::value, int, Number>;  // 'to_chars' is deleted for bool
+    auto [lastPtr, ec] = std::to_chars(buffer, buffer + sizeof(buffer), (CharsType)typedValue);
+    if (ec != std::errc()) { throwMessage<ConvertException>("Convert error: unable to encode the number"); }
+    return (size_t)(lastPtr - buffer);
+}
+
+template<class Number>
+inline std::string
+encodeNumber(const Number& typedValue)
+{
+    char buffer[64];
+    return std::string(buffer, encodeNumber(typedValue, buffer));
+}
+
+template<class Number>
+inline void
+encodeNumberTo(const Number& typedValue, Writer& writer)
+{
+    char buffer[64];
+    writer.write(buffer, encodeNumber(typedValue, buffer));
+}
+
+inline void
+throwDecodeError(DecodeStatus status, const char* typeName, const char* strValue)
+{
+    if (status == DecodeStatus::TrailingChars) {
+        throwMessage<ConvertException>(
+            "Convert error: cannot convert the string into %s, as there are some extra trailing characters: '%s'", typeName, strValue);
+    }
+    if (status == DecodeStatus::OutOfRange) {
+        throwMessage<ConvertException>("Convert error: the string is out of range for %s: '%s'", typeName, strValue);
+    }
+    throwMessage<ConvertException>("Convert error: unable to convert the string into %s: '%s'", typeName, strValue);
+}
+
+}  // namespace detail
+
 template<class SignedInt>
 struct convert<SignedInt, std::enable_if_t<std::is_integral<SignedInt>::value && std::is_signed<SignedInt>::value, void>> {
-    static std::string encode(const SignedInt& typedValue) { return std::to_string(typedValue); }
+    static std::string encode(const SignedInt& typedValue) { return detail::encodeNumber(typedValue); }
+    static void        encodeTo(const SignedInt& typedValue, Writer& writer) { detail::encodeNumberTo(typedValue, writer); }
     static void        decode(const char* strValue, SignedInt& typedValue)
     {
-        errno            = 0;
-        char*     endptr = nullptr;
-        long long number = strtoll(strValue, &endptr, 0);
-        if (endptr == strValue || errno != 0) {
-            throwMessage<ConvertException>("Convert error: unable to convert the string into a signed integer: '%s'", strValue);
-        }
-        if (*endptr != 0) {
-            throwMessage<ConvertException>(
-                "Convert error: cannot convert the string into a signed integer, as there are some extra trailing characters: '%s'",
-                strValue);
-        }
-        typedValue = (SignedInt)number;
+        detail::DecodeStatus status = detail::decodeInteger(strValue, typedValue);
+        if (status != detail::DecodeStatus::Ok) { detail::throwDecodeError(status, "a signed integer", strValue); }
     }
 };
 
 template<class UnsignedInt>
 struct convert<UnsignedInt, std::enable_if_t<std::is_integral<UnsignedInt>::value && !std::is_signed<UnsignedInt>::value, void>> {
-    static std::string encode(const UnsignedInt& typedValue) { return std::to_string(typedValue); }
+    static std::string encode(const UnsignedInt& typedValue) { return detail::encodeNumber(typedValue); }
+    static void        encodeTo(const UnsignedInt& typedValue, Writer& writer) { detail::encodeNumberTo(typedValue, writer); }
     static void        decode(const char* strValue, UnsignedInt& typedValue)
     {
-        errno            = 0;
-        char*     endptr = nullptr;
-        long long number = strtoull(strValue, &endptr, 0);
-        if (endptr == strValue || errno != 0) {
-            throwMessage<ConvertException>("Convert error: unable to convert the string into an unsigned integer: '%s'", strValue);
-        }
-        if (*endptr != 0) {
-            throwMessage<ConvertException>(
-                "Convert error: cannot convert the string into an unsigned integer, as there are some extra trailing characters: '%s'",
-                strValue);
-        }
-        typedValue = (UnsignedInt)number;
+        detail::DecodeStatus status = detail::decodeInteger(strValue, typedValue);
+        if (status != detail::DecodeStatus::Ok) { detail::throwDecodeError(status, "an unsigned integer", strValue); }
+    }
+};
+
+// Booleans are encoded as '1' or '0', and decoded from the StrictYAML literals
+template<>
+struct convert<bool> {
+    static std::string encode(const bool& typedValue) { return detail::encodeNumber(typedValue); }
+    static void        encodeTo(const bool& typedValue, Writer& writer) { detail::encodeNumberTo(typedValue, writer); }
+    static void        decode(const char* strValue, bool& typedValue)
+    {
+        detail::DecodeStatus status = detail::decodeBool(strValue, (uint32_t)strlen(strValue), typedValue);
+        if (status != detail::DecodeStatus::Ok) { detail::throwDecodeError(status, "a boolean", strValue); }
     }
 };
 
 template<class Float>
 struct convert<Float, std::enable_if_t<std::is_floating_point<Float>::value, void>> {
-    static std::string encode(const Float& typedValue) { return std::to_string(typedValue); }
+    static std::string encode(const Float& typedValue) { return detail::encodeNumber(typedValue); }
+    static void        encodeTo(const Float& typedValue, Writer& writer) { detail::encodeNumberTo(typedValue, writer); }
     static void        decode(const char* strValue, Float& typedValue)
     {
-        errno         = 0;
-        char*  endptr = nullptr;
-        double number = strtod(strValue, &endptr);
-        if (endptr == strValue || errno != 0) {
-            throwMessage<ConvertException>("Convert error: unable to convert the string into a floating point: '%s'", strValue);
-        }
-        if (*endptr != 0) {
-            throwMessage<ConvertException>(
-                "Convert error: cannot convert the string into a floating point, as there are some extra trailing characters: '%s'",
-                strValue);
-        }
-        typedValue = (Float)number;
+        detail::DecodeStatus status = detail::decodeFloat(strValue, typedValue);
+        if (status != detail::DecodeStatus::Ok) { detail::throwDecodeError(status, "a floating point", strValue); }
     }
 };
 
+namespace detail
+{
+
+// Detects the optional 'encodeTo' function in a converter
+template<class T, class Enable = void>
+struct hasEncodeTo : std::false_type {};
+template<class T>
+struct hasEncodeTo<T, std::void_t<decltype(convert<T>::encodeTo(std::declval<const T&>(), std::declval<Writer&>()))>> : std::true_type {};
+
+}  // namespace detail
+
+class Node;
+
+namespace detail
+{
+
+// Detects the node level converters, which build or read a whole sub-tree instead of a string
+template<class T, class Enable = void>
+struct hasEncodeNode : std::false_type {};
+template<class T>
+struct hasEncodeNode<T, std::void_t<decltype(convert<T>::encodeNode(std::declval<const T&>(), std::declval<Node&>()))>> : std::true_type {};
+
+template<class T, class Enable = void>
+struct hasDecodeNode : std::false_type {};
+template<class T>
+struct hasDecodeNode<T, std::void_t<decltype(convert<T>::decodeNode(std::declval<const Node&>(), std::declval<T&>()))>> : std::true_type {};
+
+}  // namespace detail
+
 // ==========================================================================================
 // Public declarations
 // ==========================================================================================
@@ -285,6 +713,262 @@ to_string(NodeType t)
 namespace detail
 {
 
+// Counted B+tree holding the children of a large sequence in fixed-size blocks, so that inserting or removing an item at any
+// position moves at most one block instead of the whole tail. The leaves are linked together for the sequential iteration.
+class ChunkedSubs
+{
+   public:
+    static constexpr uint32_t LeafCapacity  = 512;  // 2 KB of element indexes
+    static constexpr uint32_t InnerCapacity = 64;
+
+    struct Leaf {
+        uint32_t qty;
+        Leaf*    next;
+        uint32_t items[LeafCapacity];
+    };
+
+    // Builds the tree from a flat array, with blocks filled at 3/4 so that the first insertions do not split them
+    ChunkedSubs(const uint32_t* subs, uint32_t subQty) : _size(subQty)
+    {
+        constexpr uint32_t    LeafFill  = 3 * LeafCapacity / 4;
+        constexpr uint32_t    InnerFill = 3 * InnerCapacity / 4;
+        std::vector<void*>    blocks;
+        std::vector<uint32_t> counts;
+        Leaf*                 prevLeaf = nullptr;
+        for (uint32_t start = 0; start < subQty || blocks.empty(); start += LeafFill) {
+            Leaf* leaf = new Leaf;
+            leaf->qty  = std::min(LeafFill, subQty - start);
+            leaf->next = nullptr;
+            memcpy(leaf->items, subs + start, leaf->qty * sizeof(uint32_t));
+            if (prevLeaf) { prevLeaf->next = leaf; }
+            prevLeaf = leaf;
+            blocks.push_back(leaf);
+            counts.push_back(leaf->qty);
+        }
+        while (blocks.size() > 1) {
+            std::vector<void*>    parentBlocks;
+            std::vector<uint32_t> parentCounts;
+            for (size_t start = 0; start < blocks.size(); start += InnerFill) {
+                Inner* inner = new Inner;
+                inner->qty   = (uint32_t)std::min((size_t)InnerFill, blocks.size() - start);
+                parentCounts.push_back(0);
+                for (uint32_t i = 0; i < inner->qty; ++i) {
+                    inner->children[i] = blocks[start + i];
+                    inner->counts[i]   = counts[start + i];
+                    parentCounts.back() += counts[start + i];
+                }
+                parentBlocks.push_back(inner);
+            }
+            blocks.swap(parentBlocks);
+            counts.swap(parentCounts);
+            ++_height;
+        }
+        _root = blocks[0];
+    }
+    ChunkedSubs(const ChunkedSubs&)            = delete;
+    ChunkedSubs& operator=(const ChunkedSubs&) = delete;
+    ~ChunkedSubs() { freeBlock(_root, _height); }
+
+    uint32_t size() const { return _size; }
+    uint32_t get(uint32_t idx) const { return *locate(idx); }
+    void     set(uint32_t idx, uint32_t value) { *locate(idx) = value; }
+
+    void insert(uint32_t idx, uint32_t value)
+    {
+        assert(idx <= _size);
+        uint32_t rightCount = 0;
+        void*    right      = insertInBlock(_root, _height, idx, value, rightCount);
+        ++_size;
+        if (right) {  // The root has been split, so the tree grows by one level
+            Inner* newRoot       = new Inner;
+            newRoot->qty         = 2;
+            newRoot->children[0] = _root;
+            newRoot->children[1] = right;
+            newRoot->counts[0]   = _size - rightCount;
+            newRoot->counts[1]   = rightCount;
+            _root                = newRoot;
+            ++_height;
+        }
+    }
+
+    void erase(uint32_t idx)
+    {
+        assert(idx < _size);
+        eraseInBlock(_root, _height, idx);
+        --_size;
+        while (_height > 0 && ((Inner*)_root)->qty == 1) {  // The root has a single child, so the tree shrinks by one level
+            Inner* oldRoot = (Inner*)_root;
+            _root          = oldRoot->children[0];
+            delete oldRoot;
+            --_height;
+        }
+    }
+
+    // Copies all items in order into an array of size() items
+    void copyTo(uint32_t* subs) const
+    {
+        for (const Leaf* leaf = getFirstLeaf(); leaf; leaf = leaf->next) {
+            memcpy(subs, leaf->items, leaf->qty * sizeof(uint32_t));
+            subs += leaf->qty;
+        }
+    }
+
+    // Leaves may be empty in rare cases, so iterations shall skip them
+    Leaf* getFirstLeaf() const
+    {
+        void* block = _root;
+        for (uint32_t h = _height; h > 0; --h) { block = ((Inner*)block)->children[0]; }
+        return (Leaf*)block;
+    }
+    Leaf* getLastLeaf() const
+    {
+        void* block = _root;
+        for (uint32_t h = _height; h > 0; --h) { block = ((Inner*)block)->children[((Inner*)block)->qty - 1]; }
+        return (Leaf*)block;
+    }
+
+   private:
+    struct Inner {
+        uint32_t qty;
+        uint32_t counts[InnerCapacity];  // Item quantity of each child subtree
+        void*    children[InnerCapacity];
+    };
+
+    uint32_t* locate(uint32_t idx) const
+    {
+        assert(idx < _size);
+        void* block = _root;
+        for (uint32_t h = _height; h > 0; --h) {
+            const Inner* inner = (const Inner*)block;
+            uint32_t     i     = 0;
+            while (idx >= inner->counts[i]) { idx -= inner->counts[i++]; }
+            block = inner->children[i];
+        }
+        return &((Leaf*)block)->items[idx];
+    }
+
+    // Returns the new right sibling if the block had to be split, and its item quantity in 'rightCount'
+    void* insertInBlock(void* block, uint32_t height, uint32_t idx, uint32_t value, uint32_t& rightCount)
+    {
+        if (height == 0) {
+            Leaf* leaf  = (Leaf*)block;
+            Leaf* right = nullptr;
+            if (leaf->qty == LeafCapacity) {
+                right       = new Leaf;
+                right->qty  = LeafCapacity / 2;
+                right->next = leaf->next;
+                memcpy(right->items, leaf->items + LeafCapacity / 2, right->qty * sizeof(uint32_t));
+                leaf->qty  = LeafCapacity / 2;
+                leaf->next = right;
+                if (idx > leaf->qty) {
+                    idx -= leaf->qty;
+                    leaf = right;
+                }
+            }
+            memmove(leaf->items + idx + 1, leaf->items + idx, (leaf->qty - idx) * sizeof(uint32_t));
+            leaf->items[idx] = value;
+            ++leaf->qty;
+            if (right) { rightCount = right->qty; }
+            return right;
+        }
+
+        Inner*   inner = (Inner*)block;
+        uint32_t i     = 0;
+        while (i + 1 < inner->qty && idx > inner->counts[i]) { idx -= inner->counts[i++]; }
+        uint32_t childRightCount = 0;
+        void*    childRight      = insertInBlock(inner->children[i], height - 1, idx, value, childRightCount);
+        inner->counts[i] += 1;
+        if (!childRight) { return nullptr; }
+        inner->counts[i] -= childRightCount;
+
+        // Insert the new child after the split one, splitting this block too if full
+        Inner*   right  = nullptr;
+        Inner*   target = inner;
+        uint32_t pos    = i + 1;
+        if (inner->qty == InnerCapacity) {
+            right      = new Inner;
+            right->qty = InnerCapacity / 2;
+            memcpy(right->counts, inner->counts + InnerCapacity / 2, right->qty * sizeof(uint32_t));
+            memcpy(right->children, inner->children + InnerCapacity / 2, right->qty * sizeof(void*));
+            inner->qty = InnerCapacity / 2;
+            if (pos > inner->qty) {
+                pos -= inner->qty;
+                target = right;
+            }
+        }
+        memmove(target->counts + pos + 1, target->counts + pos, (target->qty - pos) * sizeof(uint32_t));
+        memmove(target->children + pos + 1, target->children + pos, (target->qty - pos) * sizeof(void*));
+        target->counts[pos]   = childRightCount;
+        target->children[pos] = childRight;
+        ++target->qty;
+        if (right) {
+            rightCount = 0;
+            for (uint32_t j = 0; j < right->qty; ++j) { rightCount += right->counts[j]; }
+        }
+        return right;
+    }
+
+    // Returns true if the block is under-filled, so that the parent tries to merge it with a neighbor
+    bool eraseInBlock(void* block, uint32_t height, uint32_t idx)
+    {
+        if (height == 0) {
+            Leaf* leaf = (Leaf*)block;
+            memmove(leaf->items + idx, leaf->items + idx + 1, (leaf->qty - idx - 1) * sizeof(uint32_t));
+            --leaf->qty;
+            return (leaf->qty < LeafCapacity / 4);
+        }
+
+        Inner*   inner = (Inner*)block;
+        uint32_t i     = 0;
+        while (idx >= inner->counts[i]) { idx -= inner->counts[i++]; }
+        bool isUnderFilled = eraseInBlock(inner->children[i], height - 1, idx);
+        inner->counts[i] -= 1;
+        if (isUnderFilled && inner->qty > 1) { mergeChildren(inner, height, (i > 0) ? i - 1 : i); }
+        return (inner->qty < InnerCapacity / 4);
+    }
+
+    // Merges the children 'left' and 'left + 1' if their content fits in one block
+    void mergeChildren(Inner* inner, uint32_t height, uint32_t left)
+    {
+        if (height == 1) {
+            Leaf* leftLeaf  = (Leaf*)inner->children[left];
+            Leaf* rightLeaf = (Leaf*)inner->children[left + 1];
+            if (leftLeaf->qty + rightLeaf->qty > LeafCapacity) { return; }
+            memcpy(leftLeaf->items + leftLeaf->qty, rightLeaf->items, rightLeaf->qty * sizeof(uint32_t));
+            leftLeaf->qty += rightLeaf->qty;
+            leftLeaf->next = rightLeaf->next;
+            delete rightLeaf;
+        } else {
+            Inner* leftInner  = (Inner*)inner->children[left];
+            Inner* rightInner = (Inner*)inner->children[left + 1];
+            if (leftInner->qty + rightInner->qty > InnerCapacity) { return; }
+            memcpy(leftInner->counts + leftInner->qty, rightInner->counts, rightInner->qty * sizeof(uint32_t));
+            memcpy(leftInner->children + leftInner->qty, rightInner->children, rightInner->qty * sizeof(void*));
+            leftInner->qty += rightInner->qty;
+            delete rightInner;
+        }
+        inner->counts[left] += inner->counts[left + 1];
+        memmove(inner->counts + left + 1, inner->counts + left + 2, (inner->qty - left - 2) * sizeof(uint32_t));
+        memmove(inner->children + left + 1, inner->children + left + 2, (inner->qty - left - 2) * sizeof(void*));
+        --inner->qty;
+    }
+
+    void freeBlock(void* block, uint32_t height)
+    {
+        if (height == 0) {
+            delete (Leaf*)block;
+            return;
+        }
+        Inner* inner = (Inner*)block;
+        for (uint32_t i = 0; i < inner->qty; ++i) { freeBlock(inner->children[i], height - 1); }
+        delete inner;
+    }
+
+    void*    _root   = nullptr;
+    uint32_t _height = 0;  // Zero when the root is a leaf
+    uint32_t _size   = 0;
+};
+
 // This structure represent one element of the tree, with a type (key, map, sequence or value), value or sub elements
 #pragma pack(push, 1)
 class Element
@@ -292,6 +976,7 @@ class Element
     static constexpr uint32_t TypeShift    = 29;                    // Type is on 3 bits
     static constexpr uint32_t CompoundMask = (1 << TypeShift) - 1;  // The 29 remaining bits are for the first data
    public:
+    Element() : Element(UNKNOWN) {}
     Element(NodeType kind) : d(((uint32_t)kind) << TypeShift), typed{0, 0, 0} {}
     Element(NodeType kind, uint32_t stringIdx, uint32_t stringSize)
         : d((((uint32_t)kind) << TypeShift) | (stringSize & CompoundMask)), typed{stringIdx, 0, 0}
@@ -310,11 +995,91 @@ class Element
         memset((char*)&rhs, 0, sizeof(Element));
     }
     Element(const Element& rhs) = delete;
+    Element& operator=(Element&& rhs) noexcept
+    {
+        if (this != &rhs) {
+            if (getType() == SEQUENCE || getType() == MAP) { clearSubs(); }
+            memcpy(this, (char*)&rhs, sizeof(Element));
+            memset((char*)&rhs, 0, sizeof(Element));
+        }
+        return *this;
+    }
     ~Element()
     {
         if (getType() == MAP || getType() == SEQUENCE) { clearSubs(); }
     }
 
+    // Copy of the node content without its links (children, key value and comments), which are added afterwards. The storage for
+    // the children is reserved, and the holes of a map are not counted
+    void cloneContentFrom(const Element& rhs)
+    {
+        assert(getType() == UNKNOWN);
+        if (rhs.getType() == SEQUENCE || rhs.getType() == MAP) {
+            d = ((uint32_t)rhs.getType()) << TypeShift;
+            if (rhs.getLiveSubQty() > 0) { setSubCapacity(rhs.getLiveSubQty()); }
+            return;
+        }
+        memcpy(this, (const char*)&rhs, sizeof(Element));
+        if (getType() == KEY) {
+            typed.key.eltIdx     = 0;
+            typed.key.commentIdx = 0;
+        } else if (getType() == VALUE) {
+            typed.value.commentIdx = 0;
+        } else if (getType() == COMMENT) {
+            typed.comment.commentIdx = 0;
+        }
+    }
+
+    // Deep copy into an element without storage. A chunked sequence is copied as a flat array
+    void cloneFrom(const Element& rhs)
+    {
+        memcpy(this, (const char*)&rhs, sizeof(Element));
+        if (getType() != SEQUENCE && getType() != MAP) { return; }
+        if (rhs.isChunked()) {
+            uint32_t subCapacity = rhs.typed.container.subQty;
+            typed.container.subs = new uint32_t[subCapacity + 1];
+            rhs.typed.container.chunks->copyTo(typed.container.subs);
+            typed.container.subs[subCapacity] = 0;  // No holes in sequences
+            setCompound(subCapacity);
+        } else if (rhs.typed.container.subs) {
+            typed.container.subs = new uint32_t[getCompound() + 1];
+            memcpy(typed.container.subs, rhs.typed.container.subs, typed.container.subQty * sizeof(uint32_t));
+            typed.container.subs[getCompound()] = rhs.typed.container.subs[getCompound()];  // Quantity of holes
+        }
+    }
+
+    // Shifts the element and string indexes, when the whole storage is appended to another context. Zero indexes mean none
+    void rebase(uint32_t eltOffset, uint32_t stringOffset)
+    {
+        auto shift = [eltOffset](uint32_t& eltIdx) {
+            if (eltIdx != 0) { eltIdx += eltOffset; }
+        };
+        if (getType() == KEY) {
+            typed.key.stringIdx += stringOffset;
+            shift(typed.key.eltIdx);
+            shift(typed.key.commentIdx);
+        } else if (getType() == VALUE) {
+            typed.value.stringIdx += stringOffset;
+            shift(typed.value.commentIdx);
+        } else if (getType() == COMMENT) {
+            typed.comment.stringIdx += stringOffset;
+            shift(typed.comment.commentIdx);
+        } else if (getType() == MAP || getType() == SEQUENCE) {
+            auto shiftSubs = [eltOffset](uint32_t* subs, uint32_t subQty) {
+                for (uint32_t i = 0; i < subQty; ++i) {
+                    if (subs[i] != Hole) { subs[i] += eltOffset; }
+                }
+            };
+            if (isChunked()) {
+                for (ChunkedSubs::Leaf* leaf = typed.container.chunks->getFirstLeaf(); leaf; leaf = leaf->next) {
+                    shiftSubs(leaf->items, leaf->qty);
+                }
+            } else if (typed.container.subQty) {
+                shiftSubs(typed.container.subs, typed.container.subQty);
+            }
+        }
+    }
+
     void reset(NodeType kind)
     {
         if (getType() == SEQUENCE || getType() == MAP) { clearSubs(); }
@@ -328,6 +1093,10 @@ class Element
             typed.key.eltIdx = eltIdx;
         } else {
             assert(getType() == SEQUENCE || getType() == MAP);
+            if (isChunked()) {
+                typed.container.chunks->insert(typed.container.subQty++, eltIdx);
+                return;
+            }
             ensureSpaceForOne();
             typed.container.subs[typed.container.subQty++] = eltIdx;
         }
@@ -341,6 +1110,12 @@ class Element
     {
         assert(getType() == SEQUENCE || getType() == MAP);
         assert(idx <= typed.container.subQty);
+        if (needsChunking(idx < typed.container.subQty)) { setChunked(true); }
+        if (isChunked()) {
+            typed.container.chunks->insert(idx, eltIdx);
+            ++typed.container.subQty;
+            return;
+        }
         ensureSpaceForOne();
         if (idx < typed.container.subQty) {
             memmove(typed.container.subs + idx + 1, typed.container.subs + idx, (typed.container.subQty - idx) * sizeof(int));
@@ -352,20 +1127,97 @@ class Element
     {
         assert(getType() == SEQUENCE || getType() == MAP);
         assert(idx < typed.container.subQty);
+        if (needsChunking(idx + 1 < typed.container.subQty)) { setChunked(true); }
+        if (isChunked()) {
+            typed.container.chunks->erase(idx);
+            if (--typed.container.subQty <= FlatMaxQty) { setChunked(false); }
+            return;
+        }
         if (idx < (--typed.container.subQty)) {
             memmove(typed.container.subs + idx, typed.container.subs + idx + 1, (typed.container.subQty - idx) * sizeof(int));
         }
     }
+    // Drops the last children. They shall not contain holes
+    void truncate(uint32_t subQty)
+    {
+        assert(getType() == SEQUENCE || getType() == MAP);
+        assert(subQty <= typed.container.subQty);
+        if (isChunked()) { setChunked(false); }
+        typed.container.subQty = subQty;
+    }
+    // The range operations work on the flat storage, with a single move of the next children
+    void eraseRange(uint32_t first, uint32_t count)
+    {
+        assert(getType() == SEQUENCE);
+        assert(first + count <= typed.container.subQty);
+        if (isChunked()) { setChunked(false); }
+        uint32_t* subs = typed.container.subs;
+        memmove(subs + first, subs + first + count, (typed.container.subQty - first - count) * sizeof(uint32_t));
+        typed.container.subQty -= count;
+    }
+    void insertRange(uint32_t idx, const uint32_t* eltIdxs, uint32_t count)
+    {
+        assert(getType() == SEQUENCE);
+        assert(idx <= typed.container.subQty);
+        if (isChunked()) { setChunked(false); }
+        if (typed.container.subQty + count > getCompound()) { setSubCapacity(std::max(typed.container.subQty + count, 2 * getCompound())); }
+        uint32_t* subs = typed.container.subs;
+        memmove(subs + idx + count, subs + idx, (typed.container.subQty - idx) * sizeof(uint32_t));
+        memcpy(subs + idx, eltIdxs, count * sizeof(uint32_t));
+        typed.container.subQty += count;
+    }
+    // Removes a map child without shifting the next ones, as their indexes are stored in the key hashtable.
+    // The slot becomes a hole, skipped by the readers until the array is compacted. Trailing holes are trimmed directly.
+    void punchHole(uint32_t idx)
+    {
+        assert(getType() == MAP);
+        assert(idx < typed.container.subQty);
+        typed.container.subs[idx] = Hole;
+        uint32_t& holeQty         = typed.container.subs[getCompound()];
+        ++holeQty;
+        while (typed.container.subQty > 0 && typed.container.subs[typed.container.subQty - 1] == Hole) {
+            --typed.container.subQty;
+            --holeQty;
+        }
+    }
+    // Removes all holes while preserving the order of the children. The callback is called for each moved child as
+    // (childEltIdx, oldIdx, newIdx), while the old slot is still readable, so that external indexes can be fixed in the same pass
+    template<class MoveCallback>
+    void compact(MoveCallback&& onMove)
+    {
+        assert(getType() == MAP);
+        if (getHoleQty() == 0) { return; }
+        uint32_t newIdx = 0;
+        for (uint32_t oldIdx = 0; oldIdx < typed.container.subQty; ++oldIdx) {
+            uint32_t childEltIdx = typed.container.subs[oldIdx];
+            if (childEltIdx == Hole) { continue; }
+            if (newIdx != oldIdx) {
+                typed.container.subs[newIdx] = childEltIdx;
+                onMove(childEltIdx, oldIdx, newIdx);
+            }
+            ++newIdx;
+        }
+        typed.container.subQty              = newIdx;
+        typed.container.subs[getCompound()] = 0;  // No more holes
+    }
     void replace(uint32_t idx, uint32_t newEltIdx)  // NOLINT
     {
         assert(getType() == SEQUENCE || getType() == MAP);
         assert(idx < typed.container.subQty);
+        if (isChunked()) {
+            typed.container.chunks->set(idx, newEltIdx);
+            return;
+        }
         typed.container.subs[idx] = newEltIdx;
     }
     void clearSubs()
     {
         assert(getType() == SEQUENCE || getType() == MAP);
-        delete[] typed.container.subs;
+        if (isChunked()) {
+            delete typed.container.chunks;
+        } else {
+            delete[] typed.container.subs;
+        }
         typed.container.subs   = nullptr;
         typed.container.subQty = 0;
         setCompound(0);  // Clear capacity
@@ -373,7 +1225,7 @@ class Element
 
     void setString(uint32_t stringIdx, uint32_t stringSize)
     {
-        assert(getType() == KEY || getType() == VALUE);
+        assert(getType() == KEY || getType() == VALUE || getType() == COMMENT);
         setCompound(stringSize);
         typed.key.stringIdx = stringIdx;
     }
@@ -433,34 +1285,114 @@ class Element
     {
         if (getType() == KEY) { return (typed.key.eltIdx == 0) ? 0 : 1; }
         assert(getType() == MAP || getType() == SEQUENCE);
-        return typed.container.subQty;
+        return typed.container.subQty;  // Includes the holes of a map
+    }
+    uint32_t getHoleQty() const
+    {
+        assert(getType() == MAP || getType() == SEQUENCE);
+        return (getType() == MAP && typed.container.subs) ? typed.container.subs[getCompound()] : 0;
+    }
+    uint32_t getLiveSubQty() const
+    {
+        if (getType() == KEY) { return getSubQty(); }
+        return getSubQty() - getHoleQty();
     }
 
+    // Only valid on the flat storage. The chunked one is accessed with getChunks()
     uint32_t* getSubs() const
     {
         assert(getType() == MAP || getType() == SEQUENCE);
+        assert(!isChunked());
         return typed.container.subs;
     }
     uint32_t getSub(uint32_t idx) const
     {
         assert(getType() == MAP || getType() == SEQUENCE);
         assert(idx < typed.container.subQty);
+        if (STYML_UNLIKELY(isChunked())) { return typed.container.chunks->get(idx); }
         return typed.container.subs[idx];
     }
 
+    // Large sequences which are edited in their middle switch to a chunked storage, so that the edit cost does not grow with
+    // their size. They come back to the flat array when they get small again.
+    bool         isChunked() const { return (getCompound() == ChunkedCapacity && getType() == SEQUENCE); }
+    ChunkedSubs* getChunks() const
+    {
+        assert(isChunked());
+        return typed.container.chunks;
+    }
+
+    // Calls 'fn(const uint32_t* subs, uint32_t subQty)' on each contiguous block of children, in order
+    template<class Fn>
+    void forEachSubBlock(Fn&& fn) const
+    {
+        assert(getType() == MAP || getType() == SEQUENCE);
+        if (isChunked()) {
+            for (const ChunkedSubs::Leaf* leaf = typed.container.chunks->getFirstLeaf(); leaf; leaf = leaf->next) {
+                if (leaf->qty) { fn(leaf->items, leaf->qty); }
+            }
+        } else if (typed.container.subQty) {
+            fn(typed.container.subs, typed.container.subQty);
+        }
+    }
+
+    uint32_t getSubCapacity() const { return getCompound(); }  // Chunked storage has the maximum capacity
+
+    void reserve(uint32_t subCapacity)
+    {
+        assert(getType() == SEQUENCE || getType() == MAP);
+        assert(subCapacity < ChunkedCapacity);
+        if (!isChunked() && subCapacity > getCompound()) { setSubCapacity(subCapacity); }
+    }
+
+    static constexpr uint32_t Hole = 0;  // Marks a removed map child. Element 0 is the root, so it is never a child
+
    private:
-    void ensureSpaceForOne()
+    static constexpr uint32_t ChunkedMinQty   = 4096;          // Minimum size for a sequence edited in its middle to become chunked
+    static constexpr uint32_t FlatMaxQty      = 1024;          // Maximum size for a chunked sequence to become flat again
+    static constexpr uint32_t ChunkedCapacity = CompoundMask;  // Capacity value marking the chunked storage
+
+    bool needsChunking(bool isMiddleEdit) const
     {
-        if (typed.container.subQty >= getCompound()) {
-            uint32_t subCapacity = std::max((uint32_t)1, 2 * getCompound());
-            setCompound(subCapacity);
-            uint32_t* newSubs = new uint32_t[subCapacity];
-            if (typed.container.subQty) { memcpy(newSubs, typed.container.subs, typed.container.subQty * sizeof(uint32_t)); }
+        return (isMiddleEdit && getType() == SEQUENCE && typed.container.subQty >= ChunkedMinQty && !isChunked());
+    }
+
+    void setChunked(bool state)
+    {
+        assert(getType() == SEQUENCE && state != isChunked());
+        if (state) {
+            ChunkedSubs* chunks = new ChunkedSubs(typed.container.subs, typed.container.subQty);
             delete[] typed.container.subs;
-            typed.container.subs = newSubs;
+            typed.container.chunks = chunks;
+            setCompound(ChunkedCapacity);
+        } else {
+            uint32_t  subCapacity = typed.container.subQty;
+            uint32_t* subs        = new uint32_t[subCapacity + 1];
+            typed.container.chunks->copyTo(subs);
+            subs[subCapacity] = 0;  // No holes in sequences
+            delete typed.container.chunks;
+            typed.container.subs = subs;
+            setCompound(subCapacity);
         }
     }
 
+    void ensureSpaceForOne()
+    {
+        if (typed.container.subQty >= getCompound()) { setSubCapacity(std::max((uint32_t)1, 2 * getCompound())); }
+    }
+
+    void setSubCapacity(uint32_t subCapacity)
+    {
+        assert(subCapacity >= typed.container.subQty);
+        uint32_t holeQty = getHoleQty();
+        setCompound(subCapacity);
+        uint32_t* newSubs = new uint32_t[subCapacity + 1];  // The extra last slot stores the quantity of holes
+        if (typed.container.subQty) { memcpy(newSubs, typed.container.subs, typed.container.subQty * sizeof(uint32_t)); }
+        newSubs[subCapacity] = holeQty;
+        delete[] typed.container.subs;
+        typed.container.subs = newSubs;
+    }
+
     // Untyped structures
     uint32_t getCompound() const { return (d & CompoundMask); }  // Semantic depends on the type
     void     setCompound(uint32_t value) { d = (d & (~CompoundMask)) | (value & CompoundMask); }
@@ -482,9 +1414,12 @@ class Element
         uint32_t commentIdx;  // 0 means None
     };
     struct TypeContainer {
-        // Compound is subCapacity
-        uint32_t  subQty;
-        uint32_t* subs;
+        // Compound is subCapacity (ChunkedCapacity if chunked). subs[subCapacity] is the quantity of holes (removed map children)
+        uint32_t subQty;
+        union {
+            uint32_t*    subs;
+            ChunkedSubs* chunks;
+        };
     };
     struct TypeComment {
         // Compound is stringSize
@@ -505,6 +1440,200 @@ class Element
 };
 #pragma pack(pop)
 
+// Array split in fixed-size pages, which can be shared with the read-only snapshots of a context (see 'share'). A shared page is
+// copied on the first non-const access to it, so that the cost of a new version is proportional to the quantity of modified pages.
+// The const accessors never copy, and only them shall be used on a snapshot. A single page grows geometrically up to the full
+// page size, so that the small documents stay cheap
+template<class T, uint32_t PageBitQty>
+class PagedStore
+{
+    static constexpr uint32_t PageSize        = 1 << PageBitQty;
+    static constexpr uint32_t PageMask        = PageSize - 1;
+    static constexpr uint32_t MinPageCapacity = 16;
+
+   public:
+    PagedStore() = default;
+    PagedStore(const PagedStore& rhs) : _size(rhs._size), _capacity(rhs._capacity)  // Deep copy
+    {
+        for (size_t pageIdx = 0; pageIdx < rhs._pages.size(); ++pageIdx) {
+            addPage(rhs._pages[pageIdx].capacity);
+            copyPage(_items.back(), rhs._items[pageIdx], rhs._pages[pageIdx].capacity);
+        }
+    }
+    PagedStore(PagedStore&& rhs) noexcept { swap(rhs); }
+    PagedStore& operator=(const PagedStore& rhs) = delete;
+    PagedStore& operator=(PagedStore&& rhs) noexcept
+    {
+        PagedStore tmp(std::move(rhs));
+        swap(tmp);
+        return *this;
+    }
+    ~PagedStore()
+    {
+        for (size_t pageIdx = 0; pageIdx < _pages.size(); ++pageIdx) { releasePage(_items[pageIdx], _pages[pageIdx]); }
+    }
+
+    T& operator[](size_t idx)
+    {
+        size_t pageIdx = idx >> PageBitQty;
+        if (STYML_UNLIKELY(_sharedPageQty > 0)) { unshare(pageIdx); }
+        return _items[pageIdx][idx & PageMask];
+    }
+    const T& operator[](size_t idx) const { return _items[idx >> PageBitQty][idx & PageMask]; }
+
+    T&       back() { return (*this)[_size - 1]; }
+    const T& back() const { return (*this)[_size - 1]; }
+    size_t   size() const { return _size; }
+    bool     empty() const { return _size == 0; }
+    size_t   capacity() const { return _capacity; }
+
+    void reserve(size_t capacity)
+    {
+        _items.reserve((capacity + PageMask) >> PageBitQty);
+        _pages.reserve((capacity + PageMask) >> PageBitQty);
+    }
+
+    // The new items are default constructed
+    void resize(size_t size)
+    {
+        assert(size >= _size);
+        if (STYML_UNLIKELY(_isReadOnly)) { throwReadOnly(); }
+        while (_capacity < size) { grow(size); }
+        _size = size;
+    }
+
+    template<class... Args>
+    void emplace_back(Args&&... args)
+    {
+        if (STYML_UNLIKELY(_isReadOnly)) { throwReadOnly(); }
+        if (_size == _capacity) { grow(_size + 1); }
+        (*this)[_size] = T(std::forward<Args>(args)...);
+        ++_size;
+    }
+
+    // Makes 'snapshot' a read-only store sharing all the current pages. They are copied on the next non-const access to this store
+    void share(PagedStore& snapshot)
+    {
+        PagedStore tmp;
+        snapshot.swap(tmp);
+        snapshot._items = _items;
+        snapshot._pages = _pages;
+        for (PageRef& page : snapshot._pages) {
+            page.buffer->acquire();
+            page.isShared = false;
+        }
+        snapshot._size     = _size;
+        snapshot._capacity = _size;
+        snapshot.setReadOnly();
+        for (PageRef& page : _pages) { page.isShared = true; }
+        _sharedPageQty = _pages.size();
+    }
+
+    // Makes any later non-const access throw. Such accesses are routed to 'unshare' as if a page were shared, so that the check
+    // costs nothing on the access path
+    void setReadOnly()
+    {
+        _isReadOnly    = true;
+        _sharedPageQty = SIZE_MAX;
+    }
+
+   private:
+    struct PageRef {
+        SharedBuffer* buffer;
+        uint32_t      capacity;
+        bool          isShared;  // Still shared with a snapshot
+    };
+
+    void swap(PagedStore& rhs) noexcept
+    {
+        std::swap(_items, rhs._items);
+        std::swap(_pages, rhs._pages);
+        std::swap(_sharedPageQty, rhs._sharedPageQty);
+        std::swap(_size, rhs._size);
+        std::swap(_capacity, rhs._capacity);
+        std::swap(_isReadOnly, rhs._isReadOnly);
+    }
+
+    static PageRef createPage(uint32_t capacity, T*& items)
+    {
+        SharedBuffer* buffer = SharedBuffer::create(capacity * sizeof(T));
+        items                = (T*)buffer->data();
+        for (uint32_t i = 0; i < capacity; ++i) { new (&items[i]) T(); }
+        return {buffer, capacity, false};
+    }
+
+    void addPage(uint32_t capacity)
+    {
+        _items.push_back(nullptr);
+        _pages.push_back(createPage(capacity, _items.back()));
+        _capacity = (_pages.size() - 1) * PageSize + capacity;
+    }
+
+    static void releasePage(T* items, PageRef& page)
+    {
+        if (!page.buffer->release()) { return; }
+        for (uint32_t i = 0; i < page.capacity; ++i) { items[i].~T(); }
+        page.buffer->destroy();
+    }
+
+    static void copyPage(T* dstItems, const T* srcItems, uint32_t itemQty)
+    {
+        if constexpr (std::is_trivially_copyable<T>::value) {
+            memcpy((void*)dstItems, (const void*)srcItems, itemQty * sizeof(T));
+        } else {
+            for (uint32_t i = 0; i < itemQty; ++i) { dstItems[i].cloneFrom(srcItems[i]); }
+        }
+    }
+
+    STYML_NOINLINE void grow(size_t minCapacity)
+    {
+        if (_pages.empty()) {
+            addPage((uint32_t)std::min(std::max(minCapacity, (size_t)MinPageCapacity), (size_t)PageSize));
+        } else if (_capacity < PageSize) {
+            // Enlarge the single page
+            T*      items = nullptr;
+            PageRef page  = createPage((uint32_t)std::min(std::max(minCapacity, 2 * _capacity), (size_t)PageSize), items);
+            if (_pages[0].isShared && _pages[0].buffer->isShared()) {
+                copyPage(items, _items[0], _pages[0].capacity);
+            } else {
+                for (size_t i = 0; i < _size; ++i) { items[i] = std::move(_items[0][i]); }
+            }
+            if (_pages[0].isShared) { --_sharedPageQty; }
+            releasePage(_items[0], _pages[0]);
+            _items[0] = items;
+            _pages[0] = page;
+            _capacity = page.capacity;
+        } else {
+            addPage(PageSize);
+        }
+    }
+
+    STYML_NOINLINE void unshare(size_t pageIdx)
+    {
+        if (_isReadOnly) { throwReadOnly(); }
+        PageRef& page = _pages[pageIdx];
+        if (!page.isShared) { return; }
+        page.isShared = false;
+        --_sharedPageQty;
+        if (!page.buffer->isShared()) { return; }  // The snapshots sharing it have been released
+        T*      items = nullptr;
+        PageRef copy  = createPage(page.capacity, items);
+        copyPage(items, _items[pageIdx], page.capacity);
+        releasePage(_items[pageIdx], page);
+        _items[pageIdx] = items;
+        page            = copy;
+    }
+
+    [[noreturn]] static void throwReadOnly() { throw AccessException("Access error: a read-only document cannot be modified"); }
+
+    std::vector<T*>      _items;  // Items of each page, kept apart for a compact access path
+    std::vector<PageRef> _pages;
+    size_t               _sharedPageQty = 0;
+    size_t               _size          = 0;
+    size_t               _capacity      = 0;
+    bool                 _isReadOnly    = false;
+};
+
 // ==========================================================================================
 // Wyhash https://github.com/wangyi-fudan/wyhash/tree/master (18a25157b modified)
 // This is free and unencumbered software released into the public domain under The Unlicense
@@ -611,7 +1740,13 @@ class Context
     // Also, it makes it fit the cache line (KeyDirAssocQty*sizeof(Entry) = 64 = (usual) CacheLineSize)
     static constexpr uint32_t KeyDirAssocQty = 8;
 
+    // Sizes of the copy-on-write pages: 64 KB of elements and 32 KB of index entries (a multiple of the associativity)
+    static constexpr uint32_t ElementPageBitQty = 12;
+    static constexpr uint32_t EntryPageBitQty   = 12;
+
    public:
+    using Elements = PagedStore<Element, ElementPageBitQty>;
+
     Context(size_t arenaStartReserveSize = 1024)
     {
         constexpr uint32_t InitMapSize = 16;
@@ -619,7 +1754,46 @@ class Context
         resize(InitMapSize);
     }
 
-    ~Context() { delete[] _alignedAlloc; }
+    // Deep copy, with the same element indexes so that the map index is copied as is
+    Context(const Context& rhs)
+        : elements(rhs.elements),
+          arena(rhs.arena),
+          sessionStartIdx(rhs.sessionStartIdx),
+          _isTypedValueCacheEnabled(rhs._isTypedValueCacheEnabled),
+          _typedValues(rhs._typedValues),
+          _parentIdxs(rhs._parentIdxs),
+          _entries(rhs._entries),
+          _entryQty(rhs._entryQty),
+          _maxEntryQty(rhs._maxEntryQty)
+    {
+    }
+    Context& operator=(const Context& rhs) = delete;
+
+    // Read-only context sharing the elements, the strings and the map index of this one. The shared pages are copied when this
+    // context modifies them, so the snapshot is not impacted. Any modification of the snapshot throws an AccessException. The typed
+    // value cache is disabled, as the snapshot may be read concurrently
+    Context* createSnapshot()
+    {
+        Context* snapshot = new Context(0);
+        elements.share(snapshot->elements);
+        arena.share(snapshot->arena);
+        _entries.share(snapshot->_entries);
+        snapshot->_entryQty    = _entryQty;
+        snapshot->_maxEntryQty = _maxEntryQty;
+        snapshot->setReadOnly();
+        return snapshot;
+    }
+
+    // Makes any later modification of the elements, the strings or the map index throw an AccessException.
+    // The parent index is then built at most once, on first use, and can be used concurrently
+    void setReadOnly()
+    {
+        elements.setReadOnly();
+        arena.setReadOnly();
+        _entries.setReadOnly();
+        _isReadOnly = true;
+        _parentIndexState.store((_parentIdxs.size() == elements.size()) ? ParentIndexBuilt : ParentIndexAbsent);
+    }
 
     // String building
     // ===============
@@ -633,14 +1807,41 @@ class Context
         arena.back() = 0;  // So that using as 'const char*' works properly
     }
 
-    void addString(const char* text, uint32_t textSize, Element* elt)
+    void addString(const char* text, uint32_t textSize, uint32_t eltIdx)
     {
         uint32_t stringIdx  = (int)arena.size();
         uint32_t stringSize = textSize + 1;
         arena.resize(arena.size() + stringSize);
         memcpy(arena.data() + stringIdx, text, textSize * sizeof(char));
         arena.back() = 0;
-        elt->setString(stringIdx, stringSize);
+        setString(eltIdx, stringIdx, stringSize);
+    }
+
+    void setString(uint32_t eltIdx, uint32_t stringIdx, uint32_t stringSize)
+    {
+        elements[eltIdx].setString(stringIdx, stringSize);
+        invalidateTypedValue(eltIdx);
+    }
+
+    // Encodes the value with its converter directly in the arena if 'encodeTo' is available, else through 'encode'.
+    // ConvertException is propagated and leaves the arena unchanged
+    template<class T>
+    void addEncodedString(const T& typedValue, uint32_t& stringIdx, uint32_t& stringSize)
+    {
+        if constexpr (hasEncodeTo<T>::value) {
+            startStringSession();
+            try {
+                Writer writer(arena);
+                convert<T>::encodeTo(typedValue, writer);
+            } catch (...) {
+                arena.resize(sessionStartIdx);
+                throw;
+            }
+            commitSession(stringIdx, stringSize);
+        } else {
+            std::string encodedValue = convert<T>::encode(typedValue);
+            addString(encodedValue.data(), (uint32_t)encodedValue.size(), stringIdx, stringSize);
+        }
     }
 
     void startStringSession() { sessionStartIdx = (uint32_t)arena.size(); }
@@ -662,17 +1863,332 @@ class Context
 
     const char* getString(int stringIdx) const { return (const char*)(arena.data() + stringIdx); }
 
+    // Typed value cache
+    // =================
+
+    void enableTypedValueCache(bool state)
+    {
+        _isTypedValueCacheEnabled = state;
+        if (!state) { std::vector<TypedValue>().swap(_typedValues); }
+    }
+
+    bool isTypedValueCacheEnabled() const { return _isTypedValueCacheEnabled; }
+
+    void invalidateTypedValue(uint32_t eltIdx)
+    {
+        if (eltIdx < _typedValues.size()) { _typedValues[eltIdx].kind = TypedValue::Empty; }
+    }
+
+    // Decodes the VALUE element with the built-in integer or floating point rules, and memoizes the parsed number.
+    // Returns false if the string is not decodable, so that the caller can report the error through the converter
+    template<class T>
+    bool getTypedValue(uint32_t eltIdx, T& typedValue)
+    {
+        const Element& elt = std::as_const(elements)[eltIdx];
+        assert(_isTypedValueCacheEnabled && elt.getType() == VALUE);
+        if (eltIdx >= _typedValues.size()) { _typedValues.resize(elements.capacity()); }
+        TypedValue& tv = _typedValues[eltIdx];
+
+        if constexpr (std::is_integral<T>::value) {
+            if (tv.kind != TypedValue::Integer && tv.kind != TypedValue::NegativeInteger) {
+                uint64_t magnitude  = 0;
+                bool     isNegative = false;
+                if (parseInteger(getString(elt.getStringIdx()), magnitude, isNegative) != DecodeStatus::Ok) { return false; }
+                tv = {magnitude, isNegative ? TypedValue::NegativeInteger : TypedValue::Integer};
+            }
+            return (narrowInteger(tv.bits, tv.kind == TypedValue::NegativeInteger, typedValue) == DecodeStatus::Ok);
+        } else {
+            static_assert(std::is_same<T, float>::value || std::is_same<T, double>::value, "Not a cacheable type");
+            constexpr uint8_t Kind = std::is_same<T, float>::value ? TypedValue::Float : TypedValue::Double;
+            if (tv.kind != Kind) {
+                T number = 0;
+                if (decodeFloat(getString(elt.getStringIdx()), number) != DecodeStatus::Ok) { return false; }
+                tv.bits = 0;
+                memcpy(&tv.bits, &number, sizeof(T));
+                tv.kind = Kind;
+            }
+            memcpy(&typedValue, &tv.bits, sizeof(T));
+            return true;
+        }
+    }
+
+    // Sub-tree copy
+    // =============
+
+    // Copies the sub-tree of an element of the source context (which can be this one) at the end of the elements, and returns the
+    // index of the copied root. The strings are shared inside the same context, as they are never modified in place
+    uint32_t cloneSubTree(const Context& src, uint32_t srcRootIdx)
+    {
+        struct Pending {
+            uint32_t srcEltIdx;
+            uint32_t dstParentIdx;
+            bool     isComment;
+        };
+        std::vector<Pending>  pendings = {{srcRootIdx, UINT_MAX, false}};
+        std::vector<uint32_t> dstMapIdxs;
+        uint32_t              dstRootIdx = (uint32_t)elements.size();
+
+        // Depth-first with the children in order, so that the copy has the element layout of a parsed document. It matters for the
+        // map index, whose hash mixes the map element index with the key: the maps shall not be packed together
+        while (!pendings.empty()) {
+            Pending pending = pendings.back();
+            pendings.pop_back();
+            uint32_t dstEltIdx = (uint32_t)elements.size();
+            elements.emplace_back(UNKNOWN);
+            const Element& srcElt = src.elements[pending.srcEltIdx];  // After the insertion, as the source can be this context
+            Element&       dstElt = elements.back();
+            NodeType       type   = srcElt.getType();
+            dstElt.cloneContentFrom(srcElt);
+            if ((type == KEY || type == VALUE || type == COMMENT) && &src != this) {
+                uint32_t stringIdx = 0, stringSize = 0;
+                addString(src.getString(srcElt.getStringIdx()), srcElt.getStringSize() - 1, stringIdx, stringSize);
+                dstElt.setString(stringIdx, stringSize);
+            }
+
+            if (pending.dstParentIdx != UINT_MAX) {
+                if (pending.isComment) {
+                    elements[pending.dstParentIdx].setComment(dstEltIdx);
+                } else {
+                    elements[pending.dstParentIdx].add(dstEltIdx);
+                }
+            }
+            if (srcElt.getNextCommentIndex() != 0) { pendings.push_back({srcElt.getNextCommentIndex(), dstEltIdx, true}); }
+            if (type == KEY && srcElt.getKeyValue() != 0) { pendings.push_back({srcElt.getKeyValue(), dstEltIdx, false}); }
+            if (type == MAP || type == SEQUENCE) {
+                if (type == MAP) { dstMapIdxs.push_back(dstEltIdx); }
+                size_t firstIdx = pendings.size();
+                srcElt.forEachSubBlock([&pendings, dstEltIdx](const uint32_t* subs, uint32_t subQty) {
+                    for (uint32_t i = 0; i < subQty; ++i) {
+                        if (subs[i] != Element::Hole) { pendings.push_back({subs[i], dstEltIdx, false}); }
+                    }
+                });
+                std::reverse(pendings.begin() + (ptrdiff_t)firstIdx, pendings.end());  // Popped in order
+            }
+        }
+
+        for (uint32_t mapEltIdx : dstMapIdxs) { indexMapChildren(mapEltIdx, true); }
+        return dstRootIdx;
+    }
+
+    // Moves all the elements and strings of another context at the end of this one, and returns the index of the moved root
+    // value, which is the source element 0 or its value if it is the root key. The indexes are rebased in one pass over the moved
+    // elements, so the elements which are not reachable anymore in the source are moved too. Only the map index is built again, as
+    // its hash mixes the map element index with the key.
+    // The strings are copied with a single memcpy instead of adopting the source buffer: the arena is one contiguous buffer
+    // addressed by offsets, and adopting pages would require a paged arena with an extra indirection on every string access
+    uint32_t adoptContext(Context& src)
+    {
+        uint32_t eltOffset    = (uint32_t)elements.size();
+        uint32_t stringOffset = (uint32_t)arena.size();
+        arena.resize(arena.size() + src.arena.size());
+        memcpy(arena.data() + stringOffset, src.arena.data(), src.arena.size());
+
+        uint32_t srcEltQty = (uint32_t)src.elements.size();
+        elements.reserve(elements.size() + srcEltQty);
+        for (uint32_t srcEltIdx = 0; srcEltIdx < srcEltQty; ++srcEltIdx) {
+            elements.emplace_back(std::move(src.elements[srcEltIdx]));  // The children storage is moved, not copied
+            elements.back().rebase(eltOffset, stringOffset);
+        }
+        reserveMapChildIndex(src._entryQty);
+        for (uint32_t eltIdx = eltOffset; eltIdx < eltOffset + srcEltQty; ++eltIdx) {
+            if (std::as_const(elements)[eltIdx].getType() == MAP) { indexMapChildren(eltIdx, true); }
+        }
+
+        const Element& rootElt = std::as_const(elements)[eltOffset];
+        if (rootElt.getType() != KEY) { return eltOffset; }  // Root of a document assigned a structural type
+        return rootElt.getKeyValue();                         // The source root key is left unreachable
+    }
+
+    // Moves the detached element 'newEltIdx' into the element 'targetEltIdx', whose previous content becomes unreachable.
+    // A zero element index gives an empty value. Only the indexes of the first level keys depend on the map element index
+    void replaceElement(uint32_t targetEltIdx, uint32_t newEltIdx)
+    {
+        if (std::as_const(elements)[targetEltIdx].getType() == MAP) { indexMapChildren(targetEltIdx, false); }
+        invalidateTypedValue(targetEltIdx);
+        invalidateParentIndex();
+        if (newEltIdx == 0) {
+            elements[targetEltIdx].reset(VALUE);
+            addString("", 0, targetEltIdx);
+            return;
+        }
+        bool isMap = (std::as_const(elements)[newEltIdx].getType() == MAP);
+        if (isMap) { indexMapChildren(newEltIdx, false); }
+        elements[targetEltIdx] = std::move(elements[newEltIdx]);
+        if (isMap) { indexMapChildren(targetEltIdx, true); }
+    }
+
+    // Map child lookup which first compares the few children from 'childIndexHint', as the keys of two layers of the same
+    // configuration are often in the same order. It avoids the random access to the map index in this case
+    uint32_t findMapChild(uint32_t mapEltIdx, const char* key, uint32_t keySize, uint32_t childIndexHint) const
+    {
+        constexpr uint32_t ScannedChildQty = 8;
+        const Element&     mapElt          = elements[mapEltIdx];
+        uint32_t           endChildIndex   = std::min(childIndexHint + ScannedChildQty, mapElt.getSubQty());
+        for (uint32_t childIndex = childIndexHint; childIndex < endChildIndex; ++childIndex) {
+            uint32_t childEltIdx = mapElt.getSub(childIndex);
+            if (childEltIdx == Element::Hole) { continue; }
+            const Element& childElt = elements[childEltIdx];
+            if (childElt.getType() == KEY && childElt.getStringSize() == keySize + 1 &&  // +1 due to zero termination included
+                memcmp(getString(childElt.getStringIdx()), key, keySize) == 0) {
+                return childIndex;
+            }
+        }
+        return getMapChildIndex(mapEltIdx, key, keySize, &mapElt);
+    }
+
+    // Deep merge of the sub-tree of an element of another context into an element of this one, walking both trees in lockstep.
+    // The keys of the source maps are looked up in the map index of this context: the missing ones are copied with their sub-tree,
+    // and the present ones are merged recursively. Two sequences are concatenated if 'isSequenceAppended', and the other source
+    // items replace the destination ones. Unchanged values are left untouched, so they do not consume arena space
+    void mergeSubTree(uint32_t dstRootIdx, const Context& src, uint32_t srcRootIdx, bool isSequenceAppended)
+    {
+        assert(&src != this);
+        struct Pending {
+            uint32_t dstEltIdx;
+            uint32_t srcEltIdx;
+        };
+        std::vector<Pending> pendings = {{dstRootIdx, srcRootIdx}};
+
+        while (!pendings.empty()) {
+            Pending pending = pendings.back();
+            pendings.pop_back();
+            const Element& srcElt  = src.elements[pending.srcEltIdx];
+            NodeType       srcType = srcElt.getType();
+            NodeType       dstType = std::as_const(elements)[pending.dstEltIdx].getType();
+
+            if (srcType == MAP && dstType == MAP) {
+                uint32_t dstMapIdx      = pending.dstEltIdx;
+                uint32_t nextChildIndex = 0;      // Hint for the lookup of the next key
+                bool     isAdding       = false;  // The comments following an added key are added with it
+                srcElt.forEachSubBlock([&](const uint32_t* subs, uint32_t subQty) {
+                    for (uint32_t i = 0; i < subQty; ++i) {
+                        if (subs[i] == Element::Hole) { continue; }
+                        const Element& srcChildElt = src.elements[subs[i]];
+                        if (srcChildElt.getType() != KEY) {
+                            if (isAdding) { elements[dstMapIdx].add(cloneSubTree(src, subs[i])); }
+                            continue;
+                        }
+                        const char* key        = src.getString(srcChildElt.getStringIdx());
+                        uint32_t    keySize    = srcChildElt.getStringSize() - 1;
+                        uint32_t    childIndex = findMapChild(dstMapIdx, key, keySize, nextChildIndex);
+                        isAdding               = (childIndex == UINT_MAX);
+                        if (!isAdding) {
+                            const Element& dstKeyElt   = std::as_const(elements)[std::as_const(elements)[dstMapIdx].getSub(childIndex)];
+                            uint32_t       dstValueIdx = dstKeyElt.getKeyValue();
+                            if (srcChildElt.getKeyValue() != 0 && dstValueIdx != 0) {
+                                pendings.push_back({dstValueIdx, srcChildElt.getKeyValue()});
+                            }
+                            nextChildIndex = childIndex + 1;
+                            continue;
+                        }
+                        uint32_t keyEltIdx = cloneSubTree(src, subs[i]);  // With its value and comments
+                        elements[dstMapIdx].add(keyEltIdx);
+                        addMapChildIndex(dstMapIdx, getString(std::as_const(elements)[keyEltIdx].getStringIdx()), keySize,
+                                         &elements[dstMapIdx], std::as_const(elements)[dstMapIdx].getSubQty() - 1);
+                    }
+                });
+            } else if (srcType == SEQUENCE && dstType == SEQUENCE && isSequenceAppended) {
+                srcElt.forEachSubBlock([this, &src, dstSeqIdx = pending.dstEltIdx](const uint32_t* subs, uint32_t subQty) {
+                    for (uint32_t i = 0; i < subQty; ++i) {
+                        uint32_t itemEltIdx = cloneSubTree(src, subs[i]);
+                        elements[dstSeqIdx].add(itemEltIdx);
+                    }
+                });
+                invalidateParentIndex();
+            } else if (srcType == VALUE && dstType == VALUE) {
+                const Element& dstElt = std::as_const(elements)[pending.dstEltIdx];
+                if (dstElt.getStringSize() != srcElt.getStringSize() ||
+                    memcmp(getString(dstElt.getStringIdx()), src.getString(srcElt.getStringIdx()), srcElt.getStringSize()) != 0) {
+                    addString(src.getString(srcElt.getStringIdx()), srcElt.getStringSize() - 1, pending.dstEltIdx);  // In place
+                }
+            } else {
+                replaceElement(pending.dstEltIdx, cloneSubTree(src, pending.srcEltIdx));
+            }
+        }
+    }
+
+    // Parent index
+    // ============
+    // Built on demand in one pass over the elements. It is rebuilt when elements have been added since its build, or after an
+    // explicit invalidation by the operations which move existing elements under another parent.
+    // A read-only context may be read by several threads: the first one builds the index and the others wait for it
+
+    uint32_t getParent(uint32_t eltIdx)
+    {
+        if (_isReadOnly) {
+            if (STYML_UNLIKELY(_parentIndexState.load(std::memory_order_acquire) != ParentIndexBuilt)) { buildSharedParentIndex(); }
+        } else if (_parentIdxs.size() != elements.size()) {
+            buildParentIndex();
+        }
+        return _parentIdxs[eltIdx];
+    }
+
+    STYML_NOINLINE void buildSharedParentIndex()
+    {
+        uint32_t state = ParentIndexAbsent;
+        if (_parentIndexState.compare_exchange_strong(state, ParentIndexBuilding, std::memory_order_acquire)) {
+            try {
+                buildParentIndex();
+            } catch (...) {
+                _parentIndexState.store(ParentIndexAbsent, std::memory_order_release);
+                throw;
+            }
+            _parentIndexState.store(ParentIndexBuilt, std::memory_order_release);
+            return;
+        }
+        while ((state = _parentIndexState.load(std::memory_order_acquire)) != ParentIndexBuilt) {
+            if (state == ParentIndexAbsent) { return buildSharedParentIndex(); }  // The build failed in the other thread
+            STYML_CPU_RELAX();
+        }
+    }
+
+    void invalidateParentIndex()
+    {
+        _parentIdxs.clear();
+        _parentIndexState.store(ParentIndexAbsent, std::memory_order_relaxed);
+    }
+
+    // Keeps a built index valid when an existing element is moved under another parent
+    void setParent(uint32_t eltIdx, uint32_t parentEltIdx)
+    {
+        if (_parentIdxs.size() == elements.size()) { _parentIdxs[eltIdx] = parentEltIdx; }
+    }
+
+    void buildParentIndex()
+    {
+        _parentIdxs.assign(elements.size(), UINT_MAX);
+        for (uint32_t eltIdx = 0; eltIdx < (uint32_t)elements.size(); ++eltIdx) {
+            const Element& elt = std::as_const(elements)[eltIdx];  // Does not unshare the pages
+            if (elt.getType() == KEY) {
+                if (elt.getKeyValue() != 0) { _parentIdxs[elt.getKeyValue()] = eltIdx; }
+            } else if (elt.getType() == MAP || elt.getType() == SEQUENCE) {
+                elt.forEachSubBlock([this, eltIdx](const uint32_t* subs, uint32_t subQty) {
+                    for (uint32_t i = 0; i < subQty; ++i) {
+                        if (subs[i] != Element::Hole) { _parentIdxs[subs[i]] = eltIdx; }
+                    }
+                });
+            }
+        }
+    }
+
     // Accelerated map access
     // ======================
 
-    uint32_t getMapChildIndex(uint32_t parentEltIdx, const char* key, uint32_t keySize, Element* parentElt)
+    uint32_t getMapChildIndex(uint32_t parentEltIdx, const char* key, uint32_t keySize, const Element* parentElt) const
+    {
+        return getMapChildIndex(parentEltIdx, (uint32_t)wyhash(key, keySize), key, keySize, parentElt);
+    }
+
+    // Same as above, with the already computed hash of the key string
+    uint32_t getMapChildIndex(uint32_t parentEltIdx, uint32_t keyStringHash, const char* key, uint32_t keySize,
+                              const Element* parentElt) const
     {
         // Important: This definition of keyHash ensures that there is no ambiguity on the retrieved value.
         // Indeed, value presence implies that both the hash and the key string match.
         // Matching hash and keys mathematically implies (due to XOR) that parentEltIdx matches too, so
         // the retrieved couple (parentEltIdx, childIndex) is unique.
         // In short, the parentEltIdx is implicitely stored in the hash, without extra storage.
-        uint32_t keyHash = parentEltIdx ^ (uint32_t)wyhash(key, keySize);
+        uint32_t keyHash = parentEltIdx ^ keyStringHash;
         if (keyHash < FirstValid) keyHash += FirstValid;  // Infinitesimal pessimisation of a few first values of hash. Worth it.
 
         uint32_t mask      = (_maxEntryQty - 1) & (~(KeyDirAssocQty - 1));
@@ -680,13 +2196,14 @@ class Context
         uint32_t probeIncr = 1;
 
         while (true) {
-            uint32_t cellId = 0;
-            for (; cellId < KeyDirAssocQty && _entries[idx + cellId].hash >= Tombstone; ++cellId) {
-                if (_entries[idx + cellId].hash != keyHash || _entries[idx + cellId].childIndex >= parentElt->getSubQty()) continue;
-                detail::Element* childElt = &elements[parentElt->getSub(_entries[idx + cellId].childIndex)];
+            const Entry* line   = &_entries[idx];  // The associative set is a cache line inside a page
+            uint32_t     cellId = 0;
+            for (; cellId < KeyDirAssocQty && line[cellId].hash >= Tombstone; ++cellId) {
+                if (line[cellId].hash != keyHash || line[cellId].childIndex >= parentElt->getSubQty()) continue;
+                const detail::Element* childElt = &elements[parentElt->getSub(line[cellId].childIndex)];
                 if (childElt->getType() == KEY && childElt->getStringSize() == keySize + 1 &&  // +1 due to zero termination included
                     strncmp(getString(childElt->getStringIdx()), key, keySize) == 0) {
-                    return _entries[idx + cellId].childIndex;
+                    return line[cellId].childIndex;
                 }
             }
 
@@ -710,12 +2227,13 @@ class Context
         uint32_t cellId    = 0;
 
         while (true) {
-            for (cellId = 0; cellId < KeyDirAssocQty && _entries[idx + cellId].hash >= FirstValid; ++cellId) {
-                if (_entries[idx + cellId].hash != keyHash || _entries[idx + cellId].childIndex >= parentElt->getSubQty()) continue;
-                detail::Element* childElt = &elements[parentElt->getSub(_entries[idx + cellId].childIndex)];
+            Entry* line = &_entries[idx];  // The associative set is a cache line inside a page
+            for (cellId = 0; cellId < KeyDirAssocQty && line[cellId].hash >= FirstValid; ++cellId) {
+                if (line[cellId].hash != keyHash || line[cellId].childIndex >= parentElt->getSubQty()) continue;
+                detail::Element* childElt = &elements[parentElt->getSub(line[cellId].childIndex)];
                 if (childElt->getType() == KEY && childElt->getStringSize() == keySize + 1 &&  // +1 due to zero termination included
                     strncmp(getString(childElt->getStringIdx()), key, keySize) == 0) {
-                    _entries[idx + cellId].childIndex = childIndex;
+                    line[cellId].childIndex = childIndex;
                     return false;  // Replace previous value
                 }
             }
@@ -732,7 +2250,9 @@ class Context
         return true;  // New value added
     }
 
-    uint32_t removeMapChildIndex(uint32_t parentEltIdx, const char* key, uint32_t keySize, Element* parentElt)
+    // Adds the index of a map child only if the key is not present, with a single probing sequence.
+    // Returns UINT_MAX if added, else the child index of the present key (the table is then unchanged)
+    uint32_t addMapChildIndexIfAbsent(uint32_t parentEltIdx, const char* key, uint32_t keySize, Element* parentElt, uint32_t childIndex)
     {
         uint32_t keyHash = parentEltIdx ^ (uint32_t)wyhash(key, keySize);
         if (keyHash < FirstValid) keyHash += FirstValid;
@@ -740,48 +2260,161 @@ class Context
         uint32_t mask      = (_maxEntryQty - 1) & (~(KeyDirAssocQty - 1));
         int      idx       = keyHash & mask;
         uint32_t probeIncr = 1;
+        Entry*   freeEntry = nullptr;  // First reusable cell on the probing sequence
 
         while (true) {
+            Entry*   line   = &_entries[idx];  // The associative set is a cache line inside a page
             uint32_t cellId = 0;
-            for (; cellId < KeyDirAssocQty && _entries[idx + cellId].hash >= Tombstone; ++cellId) {
-                if (_entries[idx + cellId].hash != keyHash || _entries[idx + cellId].childIndex >= parentElt->getSubQty()) continue;
-                detail::Element* childElt = &elements[parentElt->getSub(_entries[idx + cellId].childIndex)];
+            for (; cellId < KeyDirAssocQty && line[cellId].hash >= Tombstone; ++cellId) {
+                if (line[cellId].hash == Tombstone) {
+                    if (!freeEntry) { freeEntry = &line[cellId]; }
+                    continue;
+                }
+                if (line[cellId].hash != keyHash || line[cellId].childIndex >= parentElt->getSubQty()) continue;
+                detail::Element* childElt = &elements[parentElt->getSub(line[cellId].childIndex)];
                 if (childElt->getType() == KEY && childElt->getStringSize() == keySize + 1 &&  // +1 due to zero termination included
                     strncmp(getString(childElt->getStringIdx()), key, keySize) == 0) {
-                    int oldChildIndex      = _entries[idx + cellId].childIndex;
-                    _entries[idx + cellId] = {Tombstone, UINT_MAX};
-                    return oldChildIndex;
+                    return line[cellId].childIndex;
                 }
             }
 
-            if (cellId < KeyDirAssocQty) { break; }  // Empty space spotted on this cache line, so key has not been found
+            if (cellId < KeyDirAssocQty) {  // Empty space spotted on this cache line, so key has not been found
+                if (!freeEntry) {
+                    freeEntry = &line[cellId];
+                    _entryQty += 1;
+                }
+                break;
+            }
             idx = (idx + (probeIncr * KeyDirAssocQty)) & mask;
             ++probeIncr;  // Between linear and quadratic probing
         }
 
-        // Key not present (weird in current project)
-        assert(false && "Key not present");
+        // Key not present: add a new entry
+        *freeEntry = {keyHash, childIndex};
+        if ((uint64_t)128 * _entryQty > _maxLoad128th * _maxEntryQty) { resize(2 * _maxEntryQty); }
         return UINT_MAX;
     }
 
-    // Public fields
-    std::vector<Element> elements;
-    std::vector<uint8_t> arena;
-
-   private:
-    void resize(uint32_t newMaxSize)
+    uint32_t removeMapChildIndex(uint32_t parentEltIdx, const char* key, uint32_t keySize, Element* parentElt)
     {
-        // Allocate the new table
-        uint8_t* newAlignedAlloc = new uint8_t[newMaxSize * sizeof(Entry) + CacheLineSize];
-        Entry*   newArray        = (Entry*)(((uintptr_t)newAlignedAlloc + CacheLineSize - 1) & ~(CacheLineSize - 1));  // NOLINT
-        memset(newArray, 0, newMaxSize * sizeof(Entry));
+        uint32_t keyHash = parentEltIdx ^ (uint32_t)wyhash(key, keySize);
+        if (keyHash < FirstValid) keyHash += FirstValid;
 
-        // Transfer the data
-        uint32_t newMask = (newMaxSize - 1) & (~(KeyDirAssocQty - 1));
-        for (uint32_t oldIdx = 0; oldIdx < _maxEntryQty; ++oldIdx) {
-            if (_entries[oldIdx].hash < FirstValid) continue;
+        uint32_t mask      = (_maxEntryQty - 1) & (~(KeyDirAssocQty - 1));
+        int      idx       = keyHash & mask;
+        uint32_t probeIncr = 1;
+
+        while (true) {
+            Entry*   line   = &_entries[idx];  // The associative set is a cache line inside a page
+            uint32_t cellId = 0;
+            for (; cellId < KeyDirAssocQty && line[cellId].hash >= Tombstone; ++cellId) {
+                if (line[cellId].hash != keyHash || line[cellId].childIndex >= parentElt->getSubQty()) continue;
+                detail::Element* childElt = &elements[parentElt->getSub(line[cellId].childIndex)];
+                if (childElt->getType() == KEY && childElt->getStringSize() == keySize + 1 &&  // +1 due to zero termination included
+                    strncmp(getString(childElt->getStringIdx()), key, keySize) == 0) {
+                    int oldChildIndex = line[cellId].childIndex;
+                    line[cellId]      = {Tombstone, UINT_MAX};
+                    return oldChildIndex;
+                }
+            }
+
+            if (cellId < KeyDirAssocQty) { break; }  // Empty space spotted on this cache line, so key has not been found
+            idx = (idx + (probeIncr * KeyDirAssocQty)) & mask;
+            ++probeIncr;  // Between linear and quadratic probing
+        }
+
+        // Key not present
+        return UINT_MAX;
+    }
+
+    // Updates the index entry of a map child moved from 'oldChildIndex' to 'newChildIndex'.
+    // The old slot must still contain the child, as it is used to check the key
+    void moveMapChildIndex(uint32_t parentEltIdx, const char* key, uint32_t keySize, Element* parentElt, uint32_t oldChildIndex,
+                           uint32_t newChildIndex)
+    {
+        uint32_t keyHash = parentEltIdx ^ (uint32_t)wyhash(key, keySize);
+        if (keyHash < FirstValid) keyHash += FirstValid;
+
+        uint32_t mask      = (_maxEntryQty - 1) & (~(KeyDirAssocQty - 1));
+        int      idx       = keyHash & mask;
+        uint32_t probeIncr = 1;
+
+        while (true) {
+            Entry*   line   = &_entries[idx];  // The associative set is a cache line inside a page
+            uint32_t cellId = 0;
+            for (; cellId < KeyDirAssocQty && line[cellId].hash >= Tombstone; ++cellId) {
+                if (line[cellId].hash != keyHash || line[cellId].childIndex != oldChildIndex) continue;
+                detail::Element* childElt = &elements[parentElt->getSub(oldChildIndex)];
+                if (childElt->getType() == KEY && childElt->getStringSize() == keySize + 1 &&  // +1 due to zero termination included
+                    strncmp(getString(childElt->getStringIdx()), key, keySize) == 0) {
+                    line[cellId].childIndex = newChildIndex;
+                    return;
+                }
+            }
+
+            if (cellId < KeyDirAssocQty) { break; }  // Empty space spotted on this cache line, so key has not been found
+            idx = (idx + (probeIncr * KeyDirAssocQty)) & mask;
+            ++probeIncr;  // Between linear and quadratic probing
+        }
+        assert(false && "Moved key not present");
+    }
+
+    // Adds or removes the index entries of all the keys of a map, when its children are moved to another map element
+    void indexMapChildren(uint32_t parentEltIdx, bool isAdded)
+    {
+        Element* parentElt = &elements[parentEltIdx];
+        for (uint32_t childIndex = 0; childIndex < parentElt->getSubQty(); ++childIndex) {
+            uint32_t childEltIdx = parentElt->getSub(childIndex);
+            if (childEltIdx == Element::Hole || elements[childEltIdx].getType() != KEY) { continue; }
+            const Element& childElt = elements[childEltIdx];
+            const char* key = getString(childElt.getStringIdx());
+            if (isAdded) {
+                addMapChildIndex(parentEltIdx, key, childElt.getStringSize() - 1, parentElt, childIndex);
+            } else {
+                removeMapChildIndex(parentEltIdx, key, childElt.getStringSize() - 1, parentElt);
+            }
+        }
+    }
+
+    // Removes the holes left by the key removals in a map, preserving the order of the children, and fixes the index of the moved keys.
+    // It is triggered only when the holes are the majority, so that its cost is amortized over the removals
+    void compactMapChildren(uint32_t parentEltIdx)
+    {
+        Element* parentElt = &elements[parentEltIdx];
+        parentElt->compact([this, parentEltIdx, parentElt](uint32_t childEltIdx, uint32_t oldIdx, uint32_t newIdx) {
+            const Element& childElt = elements[childEltIdx];
+            if (childElt.getType() != KEY) { return; }  // Comments are not indexed
+            moveMapChildIndex(parentEltIdx, getString(childElt.getStringIdx()), childElt.getStringSize() - 1, parentElt, oldIdx, newIdx);
+        });
+    }
+
+    // Pre-grows the hashtable so that the given quantity of new entries can be added without resizing
+    void reserveMapChildIndex(uint32_t newEntryQty)
+    {
+        uint64_t targetEntryQty = (uint64_t)_entryQty + newEntryQty;
+        uint32_t newMaxSize     = _maxEntryQty;
+        while ((uint64_t)128 * targetEntryQty > _maxLoad128th * newMaxSize) { newMaxSize *= 2; }
+        if (newMaxSize != _maxEntryQty) { resize(newMaxSize); }
+    }
+
+    // Public fields
+    Elements elements;
+    Arena    arena;
+
+   private:
+    void resize(uint32_t newMaxSize)
+    {
+        // Allocate the new table
+        PagedStore<Entry, EntryPageBitQty> newArray;
+        newArray.resize(newMaxSize);
+
+        // Transfer the data
+        uint32_t newMask = (newMaxSize - 1) & (~(KeyDirAssocQty - 1));
+        const PagedStore<Entry, EntryPageBitQty>& oldArray = _entries;
+        for (uint32_t oldIdx = 0; oldIdx < _maxEntryQty; ++oldIdx) {
+            if (oldArray[oldIdx].hash < FirstValid) continue;
 
-            uint32_t newIdx    = _entries[oldIdx].hash & newMask;
+            uint32_t newIdx    = oldArray[oldIdx].hash & newMask;
             uint32_t probeIncr = 1;
             uint32_t cellId    = 0;
             while (true) {
@@ -792,27 +2425,37 @@ class Context
                 ++probeIncr;
             }
             assert(cellId < KeyDirAssocQty && newArray[newIdx + cellId].hash < FirstValid);
-            newArray[newIdx + cellId] = _entries[oldIdx];
+            newArray[newIdx + cellId] = oldArray[oldIdx];
         }
 
-        // Replace the old array
-        delete[] _alignedAlloc;
-        _alignedAlloc = newAlignedAlloc;
-        _entries      = newArray;
-        _maxEntryQty  = newMaxSize;
+        // Replace the old array. The snapshots sharing its pages keep them
+        _entries     = std::move(newArray);
+        _maxEntryQty = newMaxSize;
     }
 
     // String helper
     uint32_t sessionStartIdx = 0;
+    // Typed value cache, indexed by element index
+    struct TypedValue {
+        enum : uint8_t { Empty, Integer, NegativeInteger, Float, Double };
+        uint64_t bits;  // Integer magnitude or floating point bit pattern
+        uint8_t  kind;
+    };
+    bool                    _isTypedValueCacheEnabled = false;
+    std::vector<TypedValue> _typedValues;
+    // Parent element index, indexed by element index. UINT_MAX for the roots and the removed elements
+    enum : uint32_t { ParentIndexAbsent, ParentIndexBuilding, ParentIndexBuilt };
+    std::vector<uint32_t> _parentIdxs;
+    bool                  _isReadOnly = false;
+    std::atomic<uint32_t> _parentIndexState{ParentIndexAbsent};  // Only for the read-only contexts
     // Children access
     struct Entry {
         uint32_t hash;
         uint32_t childIndex;
     };
-    uint8_t* _alignedAlloc = nullptr;  // Not easy to aligned allocate in a portable way (MSVC does not like std::align_val_t)...
-    Entry*   _entries      = nullptr;
-    uint32_t _entryQty     = 0;
-    uint32_t _maxEntryQty  = 0;
+    PagedStore<Entry, EntryPageBitQty> _entries;  // Cache line aligned pages
+    uint32_t                           _entryQty    = 0;
+    uint32_t                           _maxEntryQty = 0;
 };
 
 struct StringHelper {
@@ -914,7 +2557,7 @@ struct StringHelper {
 };
 
 inline std::string
-dumpAsPyStruct(Context* context, bool withIndent)
+dumpAsPyStruct(const Context* context, bool withIndent)
 {
     if (!context) return "";
 
@@ -922,15 +2565,15 @@ dumpAsPyStruct(Context* context, bool withIndent)
     constexpr const char* indentStr  = "  ";
     struct DumpItem {
         DumpItem() {}
-        DumpItem(Element* node, int indent, bool isEnd, bool withPrefix, bool isLast)
+        DumpItem(const Element* node, int indent, bool isEnd, bool withPrefix, bool isLast)
             : node(node), indent(indent), isEnd(isEnd), withPrefix(withPrefix), isLast(isLast)
         {
         }
-        Element* node;
-        int      indent;
-        bool     isEnd;
-        bool     withPrefix;
-        bool     isLast;
+        const Element* node;
+        int            indent;
+        bool           isEnd;
+        bool           withPrefix;
+        bool           isLast;
     };
 
     StringHelper sh;
@@ -940,11 +2583,11 @@ dumpAsPyStruct(Context* context, bool withIndent)
     std::vector<DumpItem> stack{{&context->elements[0], 0, false, false, true}};
     while (!stack.empty()) {
         // Get next node to display
-        Element* v          = stack.back().node;
-        int      indent     = stack.back().indent;
-        bool     isEnd      = stack.back().isEnd;
-        bool     withPrefix = withIndent && stack.back().withPrefix;
-        bool     isLast     = stack.back().isLast;
+        const Element* v          = stack.back().node;
+        int            indent     = stack.back().indent;
+        bool           isEnd      = stack.back().isEnd;
+        bool           withPrefix = withIndent && stack.back().withPrefix;
+        bool           isLast     = stack.back().isLast;
         stack.pop_back();
         assert(v);
 
@@ -982,9 +2625,14 @@ dumpAsPyStruct(Context* context, bool withIndent)
                     for (int i = 0; i < indent; ++i) sh.addChunk(indentStr, indentSize);
                 }
                 sh.addChar('[');
-                for (int i = v->getSubQty() - 1; i >= 0; --i) {  // Reverse order
-                    stack.emplace_back(&context->elements[v->getSub(i)], indent + 1, false, !isOneLiner, i == (int)(v->getSubQty() - 1));
-                }
+                size_t stackSize = stack.size();
+                v->forEachSubBlock([&](const uint32_t* subs, uint32_t subQty) {
+                    for (uint32_t i = 0; i < subQty; ++i) {
+                        stack.emplace_back(&context->elements[subs[i]], indent + 1, false, !isOneLiner, false);
+                    }
+                });
+                if (stack.size() > stackSize) { stack.back().isLast = true; }
+                std::reverse(stack.begin() + (ptrdiff_t)stackSize, stack.end());  // Reverse order
             }
         }
 
@@ -997,14 +2645,15 @@ dumpAsPyStruct(Context* context, bool withIndent)
                 sh.addChar('}');
                 if (!isLast) sh.addChar(',');
             } else {
-                bool isOneLiner = (v->getSubQty() <= 1);
+                bool isOneLiner = (v->getLiveSubQty() <= 1);
                 stack.emplace_back(v, indent, true, !isOneLiner, isLast);
                 if (withPrefix) {
                     sh.addChar('\n');
                     for (int i = 0; i < indent; ++i) sh.addChunk(indentStr, indentSize);
                 }
                 sh.addChar('{');
-                for (int i = v->getSubQty() - 1; i >= 0; --i) {  // Reverse order
+                for (int i = v->getSubQty() - 1; i >= 0; --i) {  // Reverse order. The last slot is never a hole
+                    if (v->getSub(i) == Element::Hole) { continue; }
                     stack.emplace_back(&context->elements[v->getSub(i)], indent + 1, false, !isOneLiner, i == (int)(v->getSubQty() - 1));
                 }
             }
@@ -1077,7 +2726,7 @@ dumpAsPyStruct(Context* context, bool withIndent)
 }
 
 inline std::string
-dumpAsYaml(Context* context)
+dumpAsYaml(const Context* context)
 {
     if (!context) return "";
 
@@ -1085,10 +2734,10 @@ dumpAsYaml(Context* context)
     constexpr const char* indentStr  = "  ";
     struct DumpItem {
         DumpItem() {}
-        DumpItem(Element* node, int indent, NodeType parentType) : node(node), indent(indent), parentType(parentType) {}
-        Element* node;
-        int      indent;
-        NodeType parentType;
+        DumpItem(const Element* node, int indent, NodeType parentType) : node(node), indent(indent), parentType(parentType) {}
+        const Element* node;
+        int            indent;
+        NodeType       parentType;
     };
 
     bool         isFirst       = true;
@@ -1101,9 +2750,9 @@ dumpAsYaml(Context* context)
     std::vector<DumpItem> stack{{&context->elements[0], 0, context->elements[0].getType()}};
     while (!stack.empty()) {
         // Get next node to display
-        Element* v          = stack.back().node;
-        int      indent     = stack.back().indent;
-        NodeType parentType = stack.back().parentType;
+        const Element* v          = stack.back().node;
+        int            indent     = stack.back().indent;
+        NodeType       parentType = stack.back().parentType;
         stack.pop_back();
         assert(v);
 
@@ -1132,9 +2781,11 @@ dumpAsYaml(Context* context)
                 sh.addChar(' ');
                 ++indent;
             }
-            for (int i = v->getSubQty() - 1; i >= 0; --i) {  // Reverse order
-                stack.emplace_back(&context->elements[v->getSub(i)], indent, SEQUENCE);
-            }
+            size_t stackSize = stack.size();
+            v->forEachSubBlock([&](const uint32_t* subs, uint32_t subQty) {
+                for (uint32_t i = 0; i < subQty; ++i) { stack.emplace_back(&context->elements[subs[i]], indent, SEQUENCE); }
+            });
+            std::reverse(stack.begin() + (ptrdiff_t)stackSize, stack.end());  // Reverse order
             isFirst = false;
         }
 
@@ -1146,10 +2797,12 @@ dumpAsYaml(Context* context)
                 sh.addChar(' ');
                 ++indent;
             }
+            size_t stackSize = stack.size();
             for (int i = v->getSubQty() - 1; i >= 0; --i) {  // Reverse order
+                if (v->getSub(i) == Element::Hole) { continue; }
                 stack.emplace_back(&context->elements[v->getSub(i)], indent, MAP);
             }
-            if (parentType == SEQUENCE) {
+            if (parentType == SEQUENCE && stack.size() > stackSize) {
                 stack.back().indent -= 1;
                 stack.back().parentType = parentType;
             }
@@ -1333,12 +2986,67 @@ dumpAsYaml(Context* context)
     return std::string(sh.arena.data(), sh.arena.size());
 }
 
+// Path keys
+// =========
+// Inside the keys of a path, the characters '.', '[' and '\' are escaped with a preceding '\'
+
+// Returns the end of the key starting at 'pos', which is the first unescaped '.' or '[', or the end of the path.
+// 'isEscaped' tells if the key contains escaped characters. Returns npos if the path ends with a lone '\'
+inline size_t
+findPathKeyEnd(std::string_view path, size_t pos, bool& isEscaped)
+{
+    isEscaped = false;
+    for (; pos < path.size() && path[pos] != '.' && path[pos] != '['; ++pos) {
+        if (path[pos] == '\\') {
+            if (++pos == path.size()) { return std::string_view::npos; }
+            isEscaped = true;
+        }
+    }
+    return pos;
+}
+
+inline void
+unescapePathKey(std::string_view key, std::string& output)
+{
+    for (size_t i = 0; i < key.size(); ++i) {
+        if (key[i] == '\\') { ++i; }
+        output += key[i];
+    }
+}
+
+inline void
+escapePathKey(std::string_view key, std::string& output)
+{
+    for (char c : key) {
+        if (c == '.' || c == '[' || c == '\\') { output += '\\'; }
+        output += c;
+    }
+}
+
 }  // namespace detail
 
 // ==========================================================================================
 // Public manipulation API
 // ==========================================================================================
 
+// Map key with a precomputed hash, for the repeated lookup of the same key in many maps.
+// The key string is not copied and shall outlive this object
+class Key
+{
+   public:
+    explicit Key(std::string_view name) : _name(name), _hash((uint32_t)detail::wyhash(name.data(), name.size())) {}
+
+    std::string_view name() const { return _name; }
+    uint32_t         hash() const { return _hash; }
+
+   private:
+    std::string_view _name;
+    uint32_t         _hash;
+};
+
+class Columns;
+class Document;
+
 class Node
 {
    public:
@@ -1380,52 +3088,54 @@ class Node
     explicit operator bool() const
     {
         return (_context && _eltIdx < (uint32_t)_context->elements.size() &&
-                (_context->elements[_eltIdx].getType() != MAP || _nonExistingKey.empty()));
+                (getElement(_eltIdx).getType() != MAP || _nonExistingKey.empty()));
     }
 
     template<class T>
     T as() const
     {
         assert(_context && _eltIdx < (uint32_t)_context->elements.size());
-        detail::Element* elt = &_context->elements[_eltIdx];
+        const detail::Element* elt = &getElement(_eltIdx);
 
         if (elt->getType() == MAP && !_nonExistingKey.empty()) {
             throwMessage<AccessException>("Access error: unable to cast this node into (mangle) type '%s'  as the key '%s' does not exist",
                                           typeid(T).name(), _nonExistingKey.c_str());
         }
-        if (elt->getType() != VALUE && elt->getType() != UNKNOWN) {
-            throwMessage<AccessException>("Access error: unable to cast this node as it is not of type 'Value' but %s",
-                                          to_string().c_str());
-        }
-        T typedValue;
-        try {
-            convert<T>::decode((elt->getType() == VALUE) ? _context->getString(elt->getStringIdx()) : "", typedValue);
-        } catch (ConvertException& e) {
-            throwMessage<AccessException>("Access error: decoding error when accessing '%s' with 'as()':\n  %s", to_string().c_str(),
-                                          e.what());
+        if constexpr (detail::hasDecodeNode<T>::value) {
+            T typedValue;
+            decodeStructure(typedValue);
+            return typedValue;
+        } else {
+            if (elt->getType() != VALUE && elt->getType() != UNKNOWN) {
+                throwMessage<AccessException>("Access error: unable to cast this node as it is not of type 'Value' but %s",
+                                              to_string().c_str());
+            }
+            T typedValue;
+            decodeValue(elt, typedValue);
+            return typedValue;
         }
-        return typedValue;
     }
 
     template<class T>
     T as(const T& defaultValue) const
     {
         assert(_context && _eltIdx < (uint32_t)_context->elements.size());
-        detail::Element* elt = &_context->elements[_eltIdx];
+        const detail::Element* elt = &getElement(_eltIdx);
 
         if (elt->getType() == MAP && !_nonExistingKey.empty()) { return defaultValue; }
-        if (elt->getType() != VALUE && elt->getType() != UNKNOWN) {
-            throwMessage<AccessException>("Access error: unable to cast this node as it is not of type 'Value' but %s",
-                                          to_string().c_str());
-        }
-        T typedValue;
-        try {
-            convert<T>::decode((elt->getType() == VALUE) ? _context->getString(elt->getStringIdx()) : "", typedValue);
-        } catch (ConvertException& e) {
-            throwMessage<AccessException>("Access error: decoding error when accessing '%s' with 'as()':\n  %s", to_string().c_str(),
-                                          e.what());
+        if constexpr (detail::hasDecodeNode<T>::value) {
+            T typedValue;
+            decodeStructure(typedValue);
+            return typedValue;
+        } else {
+            if (elt->getType() != VALUE && elt->getType() != UNKNOWN) {
+                throwMessage<AccessException>("Access error: unable to cast this node as it is not of type 'Value' but %s",
+                                              to_string().c_str());
+            }
+            T typedValue;
+            decodeValue(elt, typedValue);
+            return typedValue;
         }
-        return typedValue;
     }
 
     template<class T>
@@ -1433,40 +3143,45 @@ class Node
     {
         assert(_context && _eltIdx < (uint32_t)_context->elements.size());
         detail::Element* elt = &_context->elements[_eltIdx];
-        std::string      encodedValue;
-        try {
-            encodedValue = convert<T>::encode(typedValue);
-        } catch (ConvertException& e) {
-            throwMessage<AccessException>("Access error: encoding error when assigning to '%s':\n  %s", to_string().c_str(), e.what());
-        }
-        if (elt->getType() == VALUE) {
-            _context->addString(encodedValue.data(), (uint32_t)encodedValue.size(), elt);
-        } else if (!_nonExistingKey.empty()) {
-            if (_context->getMapChildIndex(_eltIdx, _nonExistingKey.data(), (uint32_t)_nonExistingKey.size(), elt) != UINT_MAX) {
+        if constexpr (detail::hasEncodeNode<T>::value) {
+            replaceWith(encodeDetached(typedValue, _context));
+            return *this;
+        } else {
+            if (elt->getType() != VALUE && !_nonExistingKey.empty() &&
+                _context->getMapChildIndex(_eltIdx, _nonExistingKey.data(), (uint32_t)_nonExistingKey.size(), elt) != UINT_MAX) {
                 throwMessage<AccessException>("Access error: duplicated key are forbidden and the key '%s' is already present",
                                               _nonExistingKey.c_str());
             }
-            assert(elt->getType() == MAP);
             uint32_t stringIdx = 0, stringSize = 0;
-            _context->addString(encodedValue.data(), (uint32_t)encodedValue.size(), stringIdx, stringSize);
-            uint32_t eltIdx = (uint32_t)_context->elements.size();
-            _context->elements.emplace_back(VALUE, stringIdx, stringSize);  // Create the value element
-            _context->addString(_nonExistingKey.data(), (uint32_t)_nonExistingKey.size(), stringIdx, stringSize);
-            _context->elements.emplace_back(KEY, stringIdx, stringSize, eltIdx);  // Create the key referring to the created value element
-            _context->elements[_eltIdx].add(eltIdx + 1);                          // Add the key to the parent
-
-            // Update the access acceleration hashtable
-            _context->addMapChildIndex(_eltIdx, _nonExistingKey.data(), (uint32_t)_nonExistingKey.size(), &_context->elements[_eltIdx],
-                                       _context->elements[_eltIdx].getSubQty() - 1);
-            // Clear the non existing key flag
-            _nonExistingKey.clear();
-        } else {
-            // Turn the node into a string value
-            assert(elt->getType() != KEY);
-            elt->reset(VALUE);
-            _context->addString(encodedValue.data(), (uint32_t)encodedValue.size(), elt);
+            try {
+                _context->addEncodedString(typedValue, stringIdx, stringSize);
+            } catch (ConvertException& e) {
+                throwMessage<AccessException>("Access error: encoding error when assigning to '%s':\n  %s", to_string().c_str(), e.what());
+            }
+            if (elt->getType() == VALUE) {
+                _context->setString(_eltIdx, stringIdx, stringSize);
+            } else if (!_nonExistingKey.empty()) {
+                assert(elt->getType() == MAP);
+                uint32_t eltIdx = (uint32_t)_context->elements.size();
+                _context->elements.emplace_back(VALUE, stringIdx, stringSize);  // Create the value element
+                _context->addString(_nonExistingKey.data(), (uint32_t)_nonExistingKey.size(), stringIdx, stringSize);
+                // Create the key referring to the created value element, and add it to the parent
+                _context->elements.emplace_back(KEY, stringIdx, stringSize, eltIdx);
+                _context->elements[_eltIdx].add(eltIdx + 1);
+
+                // Update the access acceleration hashtable
+                _context->addMapChildIndex(_eltIdx, _nonExistingKey.data(), (uint32_t)_nonExistingKey.size(), &_context->elements[_eltIdx],
+                                           _context->elements[_eltIdx].getSubQty() - 1);
+                // Clear the non existing key flag
+                _nonExistingKey.clear();
+            } else {
+                // Turn the node into a string value
+                assert(elt->getType() != KEY);
+                elt->reset(VALUE);
+                _context->setString(_eltIdx, stringIdx, stringSize);
+            }
+            return *this;
         }
-        return *this;
     }
 
     Node& operator=(const NodeType newKind)
@@ -1504,57 +3219,80 @@ class Node
     size_t size() const
     {
         assert(_context && _eltIdx < (uint32_t)_context->elements.size());
-        detail::Element* elt = &_context->elements[_eltIdx];
+        const detail::Element* elt = &getElement(_eltIdx);
 
         if (elt->getType() != MAP && elt->getType() != SEQUENCE) {
             throwMessage<AccessException>("Access error: 'size()' can only be used on the structural elements MAP and SEQUENCE, not '%s'",
                                           to_string().c_str());
         }
-        return elt->getSubQty();
+        return elt->getLiveSubQty();
+    }
+
+    // Pre-allocates the storage for a total of 'itemQty' children (sequence items or map keys), so that building a structure of known
+    // size does not reallocate it. The optional 'stringByteQty' pre-sizes the string storage for the strings to be added
+    void reserve(size_t itemQty, size_t stringByteQty = 0)
+    {
+        assert(_context && _eltIdx < (uint32_t)_context->elements.size());
+        detail::Element* elt = &_context->elements[_eltIdx];
+
+        if ((elt->getType() != MAP && elt->getType() != SEQUENCE) || !_nonExistingKey.empty()) {
+            throwMessage<AccessException>(
+                "Access error: 'reserve()' can only be used on the structural elements MAP and SEQUENCE, not '%s'", to_string().c_str());
+        }
+        if (itemQty <= elt->getSubQty()) { return; }
+        uint32_t newItemQty = (uint32_t)itemQty - elt->getSubQty();
+        elt->reserve((uint32_t)itemQty);
+        if (elt->getType() == MAP) {
+            _context->elements.reserve(_context->elements.size() + 2 * newItemQty);  // Key and value elements
+            _context->reserveMapChildIndex(newItemQty);
+        } else {
+            _context->elements.reserve(_context->elements.size() + newItemQty);
+        }
+        _context->arena.reserve(_context->arena.size() + stringByteQty);
     }
 
     NodeType type() const
     {
         assert(_context && _eltIdx < (uint32_t)_context->elements.size());
-        NodeType t = _context->elements[_eltIdx].getType();
+        NodeType t = getElement(_eltIdx).getType();
         return (t == UNKNOWN) ? VALUE : t;
     }
 
     bool isValue() const
     {
         assert(_context && _eltIdx < (uint32_t)_context->elements.size());
-        NodeType t = _context->elements[_eltIdx].getType();
+        NodeType t = getElement(_eltIdx).getType();
         return (t == VALUE || t == UNKNOWN);
     }
 
     bool isKey() const
     {
         assert(_context && _eltIdx < (uint32_t)_context->elements.size());
-        return (_context->elements[_eltIdx].getType() == KEY);
+        return (getElement(_eltIdx).getType() == KEY);
     }
 
     bool isSequence() const
     {
         assert(_context && _eltIdx < (uint32_t)_context->elements.size());
-        return (_context->elements[_eltIdx].getType() == SEQUENCE);
+        return (getElement(_eltIdx).getType() == SEQUENCE);
     }
 
     bool isMap() const
     {
         assert(_context && _eltIdx < (uint32_t)_context->elements.size());
-        return (_context->elements[_eltIdx].getType() == MAP);
+        return (getElement(_eltIdx).getType() == MAP);
     }
 
     bool isComment() const
     {
         assert(_context && _eltIdx < (uint32_t)_context->elements.size());
-        return (_context->elements[_eltIdx].getType() == COMMENT);
+        return (getElement(_eltIdx).getType() == COMMENT);
     }
 
     std::string keyName() const
     {
         assert(_context && _eltIdx < (uint32_t)_context->elements.size());
-        detail::Element* elt = &_context->elements[_eltIdx];
+        const detail::Element* elt = &getElement(_eltIdx);
 
         if (elt->getType() != KEY) {
             throwMessage<AccessException>("Access error: 'keyName()' can only be used on KEY elements, not '%s'", to_string().c_str());
@@ -1565,7 +3303,7 @@ class Node
     Node value() const
     {
         assert(_context && _eltIdx < (uint32_t)_context->elements.size());
-        detail::Element* elt = &_context->elements[_eltIdx];
+        const detail::Element* elt = &getElement(_eltIdx);
 
         if (elt->getType() == KEY) {
             // The value of a key is the sub element
@@ -1581,7 +3319,7 @@ class Node
     Node operator[](uint32_t idx) const
     {
         assert(_context && _eltIdx < (uint32_t)_context->elements.size());
-        detail::Element* elt = &_context->elements[_eltIdx];
+        const detail::Element* elt = &getElement(_eltIdx);
 
         if (elt->getType() != SEQUENCE) {
             throwMessage<AccessException>("Access error: Access by '[%d]' can only be used on SEQUENCE elements, not '%s'", idx,
@@ -1603,18 +3341,21 @@ class Node
             throwMessage<AccessException>("Access error: 'push_back(...)' can only be used on SEQUENCE elements, not '%s'",
                                           to_string().c_str());
         }
-        uint32_t    stringIdx = 0, stringSize = 0;
-        std::string encodedValue;
-        try {
-            encodedValue = convert<T>::encode(typedValue);
-        } catch (ConvertException& e) {
-            throwMessage<AccessException>("Access error: encoding error when accessing '%s' with 'push_back(...)':\n  %s",
-                                          to_string().c_str(), e.what());
+        if constexpr (detail::hasEncodeNode<T>::value) {
+            uint32_t eltIdx = encodeDetached(typedValue, _context);
+            _context->elements[_eltIdx].add(eltIdx);
+        } else {
+            uint32_t stringIdx = 0, stringSize = 0;
+            try {
+                _context->addEncodedString(typedValue, stringIdx, stringSize);
+            } catch (ConvertException& e) {
+                throwMessage<AccessException>("Access error: encoding error when accessing '%s' with 'push_back(...)':\n  %s",
+                                              to_string().c_str(), e.what());
+            }
+            uint32_t eltIdx = (uint32_t)_context->elements.size();
+            _context->elements.emplace_back(VALUE, stringIdx, stringSize);
+            _context->elements[_eltIdx].add(eltIdx);
         }
-        _context->addString(encodedValue.data(), (uint32_t)encodedValue.size(), stringIdx, stringSize);
-        uint32_t eltIdx = (uint32_t)_context->elements.size();
-        _context->elements.emplace_back(VALUE, stringIdx, stringSize);
-        _context->elements[_eltIdx].add(eltIdx);
     }
 
     void push_back(const NodeType newKind)
@@ -1637,6 +3378,23 @@ class Node
         _context->elements[_eltIdx].add(eltIdx);
     }
 
+    // Appends all the items of the range [first, last)
+    template<class InputIt, class = typename std::iterator_traits<InputIt>::value_type>
+    void push_back(InputIt first, InputIt last)
+    {
+        assert(_context && _eltIdx < (uint32_t)_context->elements.size());
+        detail::Element* elt = &_context->elements[_eltIdx];
+
+        if (elt->getType() != SEQUENCE) {
+            throwMessage<AccessException>("Access error: 'push_back(...)' can only be used on SEQUENCE elements, not '%s'",
+                                          to_string().c_str());
+        }
+        if constexpr (std::is_base_of<std::forward_iterator_tag, typename std::iterator_traits<InputIt>::iterator_category>::value) {
+            reserveForAppend(elt, (size_t)std::distance(first, last));
+        }
+        for (; first != last; ++first) { push_back(*first); }
+    }
+
     template<class T>
     void insert(uint32_t idx, const T& typedValue)
     {
@@ -1650,18 +3408,21 @@ class Node
             throwMessage<AccessException>("Access error: Access by 'insert(%d, ...)' is out of array bounds for '%s'", idx,
                                           to_string().c_str());
         }
-        uint32_t    stringIdx = 0, stringSize = 0;
-        std::string encodedValue;
-        try {
-            encodedValue = convert<T>::encode(typedValue);
-        } catch (ConvertException& e) {
-            throwMessage<AccessException>("Access error: encoding error when accessing '%s' with 'insert(%d, ...)':\n  %s",
-                                          to_string().c_str(), idx, e.what());
+        if constexpr (detail::hasEncodeNode<T>::value) {
+            uint32_t eltIdx = encodeDetached(typedValue, _context);
+            _context->elements[_eltIdx].insert(idx, eltIdx);
+        } else {
+            uint32_t stringIdx = 0, stringSize = 0;
+            try {
+                _context->addEncodedString(typedValue, stringIdx, stringSize);
+            } catch (ConvertException& e) {
+                throwMessage<AccessException>("Access error: encoding error when accessing '%s' with 'insert(%d, ...)':\n  %s",
+                                              to_string().c_str(), idx, e.what());
+            }
+            uint32_t eltIdx = (uint32_t)_context->elements.size();
+            _context->elements.emplace_back(VALUE, stringIdx, stringSize);
+            _context->elements[_eltIdx].insert(idx, eltIdx);
         }
-        _context->addString(encodedValue.data(), (uint32_t)encodedValue.size(), stringIdx, stringSize);
-        uint32_t eltIdx = (uint32_t)_context->elements.size();
-        _context->elements.emplace_back(VALUE, stringIdx, stringSize);
-        _context->elements[_eltIdx].insert(idx, eltIdx);
     }
 
     void insert(uint32_t idx, const NodeType newKind)
@@ -1702,6 +3463,64 @@ class Node
         elt->erase(idx);
     }
 
+    // Removes the 'count' items starting at the index 'first', with a single move of the next items
+    void erase(uint32_t first, uint32_t count)
+    {
+        detail::Element* elt = getSequenceForRange("erase", first, count);
+        elt->eraseRange(first, count);
+    }
+
+    // Keeps only the 'itemQty' first items
+    void truncate(uint32_t itemQty)
+    {
+        detail::Element* elt = getSequenceForRange("truncate", 0, itemQty);
+        elt->truncate(itemQty);
+    }
+
+    // Moves the 'count' items starting at the index 'first' of the sequence 'other' before the index 'pos' of this sequence.
+    // Both sequences shall be in the same document and can be the same. The items are moved without being copied.
+    // An AccessException is thrown if this sequence is inside the moved items
+    void splice(uint32_t pos, const Node& other, uint32_t first, uint32_t count)
+    {
+        detail::Element* elt = getSequenceForRange("splice", pos, 0);
+        if (other._context != _context) {
+            throwMessage<AccessException>("Access error: 'splice(...)' can only move items between sequences of the same document");
+        }
+        detail::Element* otherElt = other.getSequenceForRange("splice", first, count);
+        if (elt == otherElt) {
+            if (pos > first && pos < first + count) {
+                throwMessage<AccessException>("Access error: 'splice(%u, ...)' cannot move items inside the moved range [%u, %u[", pos,
+                                              first, first + count);
+            }
+            if (pos >= first + count) { pos -= count; }
+        }
+
+        std::vector<uint32_t> movedEltIdxs(count);
+        uint32_t              idx = 0;
+        otherElt->forEachSubBlock([&](const uint32_t* subs, uint32_t subQty) {
+            for (uint32_t i = 0; i < subQty && idx < first + count; ++i, ++idx) {
+                if (idx >= first) { movedEltIdxs[idx - first] = subs[i]; }
+            }
+        });
+        if (elt != otherElt) {
+            // Walks up from this sequence to its ancestor among the items of the other sequence, if any
+            uint32_t ancestorEltIdx = _eltIdx;
+            uint32_t parentEltIdx   = _context->getParent(ancestorEltIdx);
+            while (parentEltIdx != UINT_MAX && parentEltIdx != other._eltIdx) {
+                ancestorEltIdx = parentEltIdx;
+                parentEltIdx   = _context->getParent(ancestorEltIdx);
+            }
+            bool isMoved = std::find(movedEltIdxs.begin(), movedEltIdxs.end(), ancestorEltIdx) != movedEltIdxs.end();
+            if (parentEltIdx != UINT_MAX && isMoved) {
+                throwMessage<AccessException>("Access error: 'splice(%u, ...)' cannot move the range [%u, %u[ containing the destination",
+                                              pos, first, first + count);
+            }
+        }
+        otherElt->eraseRange(first, count);
+        elt->insertRange(pos, movedEltIdxs.data(), count);
+        for (uint32_t movedEltIdx : movedEltIdxs) { _context->setParent(movedEltIdx, _eltIdx); }
+    }
+
     void pop_back()
     {
         assert(_context && _eltIdx < (uint32_t)_context->elements.size());
@@ -1715,13 +3534,50 @@ class Node
         elt->erase(elt->getSubQty() - 1);
     }
 
+    // Decodes the items of the sequence into the provided buffer, in one pass over the children.
+    // Returns the number of decoded items, which is the minimum of the sequence size and the buffer size
+    template<class T>
+    size_t copyTo(T* buffer, size_t bufferSize) const
+    {
+        assert(_context && _eltIdx < (uint32_t)_context->elements.size());
+        const detail::Element* elt = &getElement(_eltIdx);
+
+        if (elt->getType() != SEQUENCE) {
+            throwMessage<AccessException>("Access error: 'copyTo(...)' can only be used on SEQUENCE elements, not '%s'",
+                                          to_string().c_str());
+        }
+        uint32_t qty = (uint32_t)std::min((size_t)elt->getSubQty(), bufferSize);
+        uint32_t i   = 0;
+        elt->forEachSubBlock([&](const uint32_t* subs, uint32_t subQty) {
+            for (uint32_t j = 0; j < subQty && i < qty; ++j, ++i) { copyItemTo(i, subs[j], buffer[i]); }
+        });
+        return qty;
+    }
+
+    // Decodes all the items of the sequence into a vector
+    template<class T>
+    std::vector<T> asVector() const
+    {
+        std::vector<T> result(size());
+        if constexpr (std::is_same<T, bool>::value) {  // No contiguous storage for std::vector<bool>
+            for (uint32_t i = 0; i < result.size(); ++i) { result[i] = (*this)[i].template as<bool>(); }
+        } else {
+            copyTo(result.data(), result.size());
+        }
+        return result;
+    }
+
+    // Builds a column-oriented snapshot of some keys of this sequence of maps, in one pass over the items
+    Columns columns(std::initializer_list<std::string_view> keyNames) const;
+    Columns columns(const std::vector<std::string>& keyNames) const;
+
     // Map specific
     // ============
 
     bool hasKey(const std::string& key) const
     {
         assert(_context && _eltIdx < (uint32_t)_context->elements.size());
-        detail::Element* elt = &_context->elements[_eltIdx];
+        const detail::Element* elt = &getElement(_eltIdx);
 
         if (elt->getType() != MAP) {
             throwMessage<AccessException>("Access error: 'hasKey(%s)' can only be used on MAP elements, not '%s'", key.c_str(),
@@ -1735,7 +3591,7 @@ class Node
     Node operator[](const std::string& key) const
     {
         assert(_context && _eltIdx < (uint32_t)_context->elements.size());
-        detail::Element* elt = &_context->elements[_eltIdx];
+        const detail::Element* elt = &getElement(_eltIdx);
 
         if (elt->getType() != MAP) {
             throwMessage<AccessException>("Access error: Access by '[%s]' can only be used on MAP elements, not '%s'", key.c_str(),
@@ -1753,7 +3609,7 @@ class Node
             return Node(_eltIdx, _context, key);
         }
         assert(childIndex < elt->getSubQty());
-        return Node(_context->elements[elt->getSub(childIndex)].getKeyValue(), _context);
+        return Node(getElement(elt->getSub(childIndex)).getKeyValue(), _context);
     }
 
     template<class T>
@@ -1773,22 +3629,25 @@ class Node
         if (_context->getMapChildIndex(_eltIdx, key.data(), (uint32_t)key.size(), elt) != UINT_MAX) {
             throwMessage<AccessException>("Access error: duplicated key are forbidden and the key '%s' is already present", key.c_str());
         }
-
-        uint32_t    stringIdx = 0, stringSize = 0;
-        std::string encodedValue;
-        try {
-            encodedValue = convert<T>::encode(typedValue);
-        } catch (ConvertException& e) {
-            throwMessage<AccessException>("Access error: encoding error when accessing '%s' with 'insert('%s', ...)':\n  %s",
-                                          to_string().c_str(), key.c_str(), e.what());
+        uint32_t eltIdx = 0;
+        if constexpr (detail::hasEncodeNode<T>::value) {
+            eltIdx = encodeDetached(typedValue, _context);
+        } else {
+            uint32_t stringIdx = 0, stringSize = 0;
+            try {
+                _context->addEncodedString(typedValue, stringIdx, stringSize);
+            } catch (ConvertException& e) {
+                throwMessage<AccessException>("Access error: encoding error when accessing '%s' with 'insert('%s', ...)':\n  %s",
+                                              to_string().c_str(), key.c_str(), e.what());
+            }
+            eltIdx = (uint32_t)_context->elements.size();
+            _context->elements.emplace_back(VALUE, stringIdx, stringSize);  // Create the value element
         }
-
-        _context->addString(encodedValue.data(), (uint32_t)encodedValue.size(), stringIdx, stringSize);
-        uint32_t eltIdx = (uint32_t)_context->elements.size();
-        _context->elements.emplace_back(VALUE, stringIdx, stringSize);  // Create the value element
+        uint32_t stringIdx = 0, stringSize = 0;
+        uint32_t keyEltIdx = (uint32_t)_context->elements.size();
         _context->addString(key.data(), (uint32_t)key.size(), stringIdx, stringSize);
-        _context->elements.emplace_back(KEY, stringIdx, stringSize, eltIdx);  // Create the key referring to the created value element
-        _context->elements[_eltIdx].add(eltIdx + 1);                          // Add the key to the parent
+        _context->elements.emplace_back(KEY, stringIdx, stringSize, eltIdx);  // Create the key referring to the value element
+        _context->elements[_eltIdx].add(keyEltIdx);                           // Add the key to the parent
 
         // Update the access acceleration hashtable
         _context->addMapChildIndex(_eltIdx, key.data(), (uint32_t)key.size(), &_context->elements[_eltIdx],
@@ -1816,63 +3675,407 @@ class Node
             throwMessage<AccessException>("Access error: duplicated key are forbidden and the key '%s' is already present", key.c_str());
         }
 
+        uint32_t stringIdx = 0, stringSize = 0;
         uint32_t eltIdx = (uint32_t)_context->elements.size();
         _context->elements.emplace_back(newKind);
-        _context->elements[_eltIdx].add(eltIdx);
+        _context->addString(key.data(), (uint32_t)key.size(), stringIdx, stringSize);
+        _context->elements.emplace_back(KEY, stringIdx, stringSize, eltIdx);  // Create the key referring to the created element
+        _context->elements[_eltIdx].add(eltIdx + 1);                          // Add the key to the parent
 
         // Update the access acceleration hashtable
         _context->addMapChildIndex(_eltIdx, key.data(), (uint32_t)key.size(), &_context->elements[_eltIdx],
                                    _context->elements[_eltIdx].getSubQty() - 1);
     }
 
-    bool remove(const std::string& key)
+    // Inserts all the key-value pairs of the range [first, last), typically iterators of a map
+    template<class InputIt, class = decltype(std::declval<InputIt>()->first), class = decltype(std::declval<InputIt>()->second)>
+    void insert(InputIt first, InputIt last)
     {
         assert(_context && _eltIdx < (uint32_t)_context->elements.size());
         detail::Element* elt = &_context->elements[_eltIdx];
 
-        if (elt->getType() != MAP) {
-            throwMessage<AccessException>("Access error: 'remove(%s)' can only be used on MAP elements, not '%s'", key.c_str(),
+        if (elt->getType() != MAP || !_nonExistingKey.empty()) {
+            throwMessage<AccessException>("Access error: 'insert(first, last)' can only be used on MAP elements, not '%s'",
                                           to_string().c_str());
         }
-
-        uint32_t childIndex = _context->removeMapChildIndex(_eltIdx, key.data(), (uint32_t)key.size(), elt);
-        if (childIndex == UINT_MAX) { return false; }
-        assert(childIndex < elt->getSubQty());
-
-        if (childIndex < elt->getSubQty() - 1) {
-            // As the indexes of valid children are immutable (because used in the acceleration hashtable), the last element of the array
-            // is swapped with the removed one, to limit the modifications to only 1 more lookup.
-            detail::Element* lastElt = &_context->elements[elt->getSub(elt->getSubQty() - 1)];
-            _context->removeMapChildIndex(_eltIdx, _context->getString(lastElt->getStringIdx()), lastElt->getStringSize() - 1, elt);
-            elt->replace(childIndex, elt->getSub(elt->getSubQty() - 1));
-            _context->addMapChildIndex(_eltIdx, _context->getString(lastElt->getStringIdx()), lastElt->getStringSize() - 1, elt,
-                                       childIndex);
+        if constexpr (std::is_base_of<std::forward_iterator_tag, typename std::iterator_traits<InputIt>::iterator_category>::value) {
+            reserveForAppend(elt, (size_t)std::distance(first, last));
         }
-        elt->erase(elt->getSubQty() - 1);  // Pop back
-        return true;
+        for (; first != last; ++first) { insert(first->first, first->second); }
     }
 
-    std::string to_string() const
+    // Batch of key insertions in a map, which defers the index maintenance and the duplicated key detection to the commit.
+    // Until then, the inserted keys are not visible by the lookups and the map shall not be modified by other means.
+    // A batch which is destroyed without being committed discards its insertions.
+    class Batch
     {
-        assert(_context && _eltIdx < (uint32_t)_context->elements.size());
-        const detail::Element* elt = &_context->elements[_eltIdx];
-        switch (elt->getType()) {
-            case UNKNOWN:
-                return "[ Unknown ]";
-            case KEY:
-                if (elt->getStringSize() <= 1) { return "[ Root ]"; }
-                return std::string("[ Key '") + std::string(_context->getString(elt->getStringIdx())) + "' ]";
-            case VALUE:
-                return std::string("[ Value string '") + std::string(_context->getString(elt->getStringIdx())) + "' ]";
-            case SEQUENCE:
-                return std::string("[ Sequence of ") + std::to_string(elt->getSubQty()) + " elements ]";
-            case MAP:
-                return std::string("[ Map of ") + std::to_string(elt->getSubQty()) + " elements ]";
-            case COMMENT:
-                return std::string("[ Comment '") + std::string(_context->getString(elt->getStringIdx())) + "' ]";
-        };
-        return "[ Weird ]";
-    }
+       public:
+        Batch(Batch&& other) noexcept
+            : _mapEltIdx(other._mapEltIdx), _context(other._context), _startSubQty(other._startSubQty), _isPending(other._isPending)
+        {
+            other._isPending = false;
+        }
+        Batch(const Batch&)            = delete;
+        Batch& operator=(const Batch&) = delete;
+        Batch& operator=(Batch&&)      = delete;
+        ~Batch()
+        {
+            if (_isPending) { rollback(); }
+        }
+
+        template<class T>
+        Batch& insert(std::string_view key, const T& typedValue)
+        {
+            if constexpr (detail::hasEncodeNode<T>::value) {
+                checkInsertion(key);
+                appendKey(key, encodeDetached(typedValue, _context));
+            } else {
+                checkInsertion(key);
+                uint32_t stringIdx = 0, stringSize = 0;
+                try {
+                    _context->addEncodedString(typedValue, stringIdx, stringSize);
+                } catch (ConvertException& e) {
+                    throwMessage<AccessException>("Access error: encoding error when inserting the key '%s' in a batch:\n  %s",
+                                                  std::string(key).c_str(), e.what());
+                }
+                _context->elements.emplace_back(VALUE, stringIdx, stringSize);
+                appendKey(key, (uint32_t)_context->elements.size() - 1);
+            }
+            return *this;
+        }
+
+        // Returns the created structural node, so that it can be filled
+        Node insert(std::string_view key, const NodeType newKind)
+        {
+            checkInsertion(key);
+            if (newKind != MAP && newKind != SEQUENCE) {
+                throwMessage<AccessException>(
+                    "Access error: only the structural elements MAP and SEQUENCE can be created-inserted, not '%s'",
+                    styml::to_string(newKind));
+            }
+            _context->elements.emplace_back(newKind);
+            uint32_t eltIdx = (uint32_t)_context->elements.size() - 1;
+            appendKey(key, eltIdx);
+            return Node(eltIdx, _context);
+        }
+
+        // Quantity of pending insertions
+        size_t size() const { return _isPending ? _context->elements[_mapEltIdx].getSubQty() - _startSubQty : 0; }
+
+        // Indexes all the inserted keys in one pass. If a key is duplicated, the whole batch is discarded and an exception is thrown
+        void commit()
+        {
+            if (!_isPending) { throwMessage<AccessException>("Access error: the batch has already been committed or discarded"); }
+            detail::Element* elt    = &_context->elements[_mapEltIdx];
+            uint32_t         subQty = elt->getSubQty();
+            _context->reserveMapChildIndex(subQty - _startSubQty);
+
+            for (uint32_t childIndex = _startSubQty; childIndex < subQty; ++childIndex) {
+                const detail::Element& keyElt = _context->elements[elt->getSub(childIndex)];
+                const char*            key    = _context->getString(keyElt.getStringIdx());
+                uint32_t presentIndex = _context->addMapChildIndexIfAbsent(_mapEltIdx, key, keyElt.getStringSize() - 1, elt, childIndex);
+                if (presentIndex == UINT_MAX) { continue; }
+
+                // Duplicated key: the already indexed keys of the batch are removed from the index before discarding the batch
+                std::string duplicatedKey(key);
+                for (uint32_t i = _startSubQty; i < childIndex; ++i) {
+                    const detail::Element& indexedKeyElt = _context->elements[elt->getSub(i)];
+                    _context->removeMapChildIndex(_mapEltIdx, _context->getString(indexedKeyElt.getStringIdx()),
+                                                  indexedKeyElt.getStringSize() - 1, elt);
+                }
+                rollback();
+                throwMessage<AccessException>("Access error: duplicated key are forbidden and the key '%s' is already present",
+                                              duplicatedKey.c_str());
+            }
+            _isPending = false;
+        }
+
+       private:
+        friend class Node;
+        Batch(uint32_t mapEltIdx, detail::Context* context)
+            : _mapEltIdx(mapEltIdx), _context(context), _startSubQty(context->elements[mapEltIdx].getSubQty())
+        {
+        }
+
+        void checkInsertion(std::string_view key) const
+        {
+            if (!_isPending) { throwMessage<AccessException>("Access error: the batch has already been committed or discarded"); }
+            if (key.empty()) { throwMessage<AccessException>("Access error: empty key is not allowed to access a MAP element"); }
+        }
+
+        void appendKey(std::string_view key, uint32_t valueEltIdx)
+        {
+            uint32_t stringIdx = 0, stringSize = 0;
+            _context->addString(key.data(), (uint32_t)key.size(), stringIdx, stringSize);
+            _context->elements.emplace_back(KEY, stringIdx, stringSize, valueEltIdx);
+            _context->elements[_mapEltIdx].add((uint32_t)_context->elements.size() - 1);  // Not indexed until the commit
+        }
+
+        void rollback()
+        {
+            detail::Element* elt = &_context->elements[_mapEltIdx];
+            if (elt->getType() == MAP && elt->getSubQty() >= _startSubQty) { elt->truncate(_startSubQty); }
+            _isPending = false;
+        }
+
+        uint32_t         _mapEltIdx;
+        detail::Context* _context;
+        uint32_t         _startSubQty;
+        bool             _isPending = true;
+    };
+
+    Batch beginBatch()
+    {
+        assert(_context && _eltIdx < (uint32_t)_context->elements.size());
+        if (_context->elements[_eltIdx].getType() != MAP || !_nonExistingKey.empty()) {
+            throwMessage<AccessException>("Access error: 'beginBatch()' can only be used on MAP elements, not '%s'", to_string().c_str());
+        }
+        return Batch(_eltIdx, _context);
+    }
+
+    bool remove(const std::string& key)
+    {
+        assert(_context && _eltIdx < (uint32_t)_context->elements.size());
+        detail::Element* elt = &_context->elements[_eltIdx];
+
+        if (elt->getType() != MAP) {
+            throwMessage<AccessException>("Access error: 'remove(%s)' can only be used on MAP elements, not '%s'", key.c_str(),
+                                          to_string().c_str());
+        }
+
+        uint32_t childIndex = _context->removeMapChildIndex(_eltIdx, key.data(), (uint32_t)key.size(), elt);
+        if (childIndex == UINT_MAX) { return false; }
+        assert(childIndex < elt->getSubQty());
+
+        // As the indexes of valid children are used in the acceleration hashtable, the removed slot becomes a hole instead of shifting
+        // the next children. This keeps the order of the keys. The holes are compacted in a batch once they are the majority.
+        elt->punchHole(childIndex);
+        if (2 * elt->getHoleQty() > elt->getSubQty()) { _context->compactMapChildren(_eltIdx); }
+        return true;
+    }
+
+    // Fragment parsing
+    // ================
+    // The text is parsed directly in this document, without an intermediate document. If the parsing fails, a ParseException is
+    // thrown and the node is unchanged. The comments before the first item of the fragment are dropped
+
+    // Replaces the content of the node (or the value of a key) with the parsed text
+    void parseInto(const char* text, uint32_t textSize);
+    void parseInto(const char* text) { parseInto(text, (uint32_t)strlen(text)); }
+    void parseInto(const std::string& text) { parseInto(text.data(), (uint32_t)text.size()); }
+
+    // Appends the parsed items to this sequence (a parsed node which is not a sequence is appended as one item),
+    // or the parsed keys to this map
+    void appendParsed(const char* text, uint32_t textSize);
+    void appendParsed(const char* text) { appendParsed(text, (uint32_t)strlen(text)); }
+    void appendParsed(const std::string& text) { appendParsed(text.data(), (uint32_t)text.size()); }
+
+    // Sub-tree copy
+    // =============
+
+    // Replaces the content of the target node (or the value of a target key) with a copy of this sub-tree. The target can be in
+    // another document, and inside this sub-tree
+    void cloneInto(Node& target) const;
+    void cloneInto(Node&& target) const { cloneInto(target); }
+
+    // Sets the key of this map to a copy of the sub-tree 'src', which can be in another document, and returns the new value.
+    // It is equivalent to 'src.cloneInto((*this)[key])'
+    Node graft(const std::string& key, const Node& src);
+
+    // Same as above with a whole document, whose elements are moved instead of copied, with their indexes rebased in one pass.
+    // Its strings are copied as one block, as the string storage of a document is contiguous. The source document is left empty
+    Node graft(const std::string& key, Document&& src);
+
+    // Non-throwing lookups
+    // ====================
+    // They return an invalid node (evaluating to false) instead of throwing when the item is absent or the node has not the right type.
+    // Lookups on an invalid node return an invalid node too, so that they can be chained without intermediate checks.
+
+    Node find(std::string_view key) const
+    {
+        if (!*this) { return Node(); }
+        uint32_t eltIdx = lookupKey(_eltIdx, key.data(), (uint32_t)key.size());
+        return (eltIdx == UINT_MAX) ? Node() : Node(eltIdx, _context);
+    }
+
+    // The child index hint is checked first, so that maps with the same key layout are accessed without hashing nor probing.
+    // It is updated with the child index of the found key
+    Node find(const Key& key, uint32_t& childIndexHint) const
+    {
+        if (!*this) { return Node(); }
+        const detail::Element* elt = &getElement(_eltIdx);
+        if (elt->getType() != MAP || key.name().empty()) { return Node(); }
+        if (childIndexHint < elt->getSubQty()) {
+            uint32_t keyEltIdx = elt->getSub(childIndexHint);
+            if (keyEltIdx != detail::Element::Hole) {
+                const detail::Element& keyElt = getElement(keyEltIdx);
+                if (keyElt.getType() == KEY && keyElt.getStringSize() == key.name().size() + 1 &&  // +1 due to zero termination
+                    memcmp(_context->getString(keyElt.getStringIdx()), key.name().data(), key.name().size()) == 0) {
+                    return Node(keyElt.getKeyValue(), _context);
+                }
+            }
+        }
+        uint32_t childIndex =
+            _context->getMapChildIndex(_eltIdx, key.hash(), key.name().data(), (uint32_t)key.name().size(), elt);
+        if (childIndex == UINT_MAX) { return Node(); }
+        childIndexHint = childIndex;
+        return Node(getElement(elt->getSub(childIndex)).getKeyValue(), _context);
+    }
+
+    Node find(const Key& key) const
+    {
+        uint32_t childIndexHint = UINT_MAX;
+        return find(key, childIndexHint);
+    }
+
+    Node find(uint32_t idx) const
+    {
+        if (!*this) { return Node(); }
+        uint32_t eltIdx = lookupIndex(_eltIdx, idx);
+        return (eltIdx == UINT_MAX) ? Node() : Node(eltIdx, _context);
+    }
+
+    // The path is a list of map keys separated with '.', and of sequence indexes in brackets. Ex: "build.steps[0].run"
+    // The characters '.', '[' and '\' inside a key are escaped with a '\'. Ex: "files.config\\.yaml" for the key "config.yaml"
+    Node findPath(std::string_view path) const
+    {
+        if (!*this) { return Node(); }
+        uint32_t eltIdx = _eltIdx;
+        size_t   pos    = 0;
+        while (pos < path.size() && eltIdx != UINT_MAX) {
+            if (path[pos] == '[') {
+                size_t   endPos = path.find(']', pos);
+                uint32_t idx    = 0;
+                if (endPos == std::string_view::npos) { return Node(); }
+                auto [lastPtr, ec] = std::from_chars(path.data() + pos + 1, path.data() + endPos, idx);
+                if (ec != std::errc() || lastPtr != path.data() + endPos) { return Node(); }
+                eltIdx = lookupIndex(eltIdx, idx);
+                pos    = endPos + 1;
+            } else {
+                bool   isEscaped = false;
+                size_t endPos    = detail::findPathKeyEnd(path, pos, isEscaped);
+                if (endPos == std::string_view::npos || endPos == pos) { return Node(); }  // Lone final '\' or empty key
+                if (isEscaped) {
+                    std::string key;
+                    detail::unescapePathKey(path.substr(pos, endPos - pos), key);
+                    eltIdx = lookupKey(eltIdx, key.data(), (uint32_t)key.size());
+                } else {
+                    eltIdx = lookupKey(eltIdx, path.data() + pos, (uint32_t)(endPos - pos));
+                }
+                pos = endPos;
+            }
+            if (pos < path.size()) {
+                if (path[pos] == '.') {
+                    ++pos;
+                    if (pos == path.size() || path[pos] == '[') { return Node(); }  // Empty key
+                } else if (path[pos] != '[') {
+                    return Node();  // Missing separator after an index
+                }
+            }
+        }
+        return (eltIdx == UINT_MAX) ? Node() : Node(eltIdx, _context);
+    }
+
+    // Returns the default value if the path does not exist. As for 'as(defaultValue)', an existing but non-decodable item throws
+    template<class T>
+    T get(std::string_view path, const T& defaultValue) const
+    {
+        Node node = findPath(path);
+        if (!node) { return defaultValue; }
+        return node.as<T>(defaultValue);
+    }
+
+    // Same as above with a string default value, so that a string literal does not deduce an array type
+    std::string get(std::string_view path, const char* defaultValue) const { return get<std::string>(path, defaultValue); }
+    std::string get(std::string_view path, std::string_view defaultValue) const
+    {
+        return get<std::string>(path, std::string(defaultValue));
+    }
+
+    // Upward navigation
+    // =================
+    // The parent index is built on the first call, in one pass over the document. Then 'parent()' and 'depth()' cost O(depth), and
+    // 'path()' also scans the sequences on the path
+
+    // Returns the map or the sequence containing this node (the key is skipped), or an invalid node for the root
+    Node parent() const
+    {
+        if (!*this) { return Node(); }
+        uint32_t parentEltIdx = getParentContainer(_eltIdx);
+        return (parentEltIdx == UINT_MAX) ? Node() : Node(parentEltIdx, _context);
+    }
+
+    // Number of containers above this node, so 0 for the root
+    uint32_t depth() const
+    {
+        if (!*this) { return 0; }
+        uint32_t depth  = 0;
+        uint32_t eltIdx = getParentContainer(_eltIdx);
+        for (; eltIdx != UINT_MAX; eltIdx = getParentContainer(eltIdx)) { ++depth; }
+        return depth;
+    }
+
+    // Returns the path of this node from the root, with the syntax of 'findPath' and its escaped keys. Ex: "build.steps[0].run"
+    // The index of a sequence item is found by scanning its sequence, so the cost is the depth plus the sizes of the sequences
+    // on the path
+    std::string path() const
+    {
+        if (!*this) { return std::string(); }
+        std::vector<std::string> segments;
+        uint32_t                 eltIdx = _eltIdx;
+        if (getElement(eltIdx).getType() == KEY && eltIdx != 0) { eltIdx = getElement(eltIdx).getKeyValue(); }
+        while (true) {
+            uint32_t parentEltIdx = _context->getParent(eltIdx);
+            if (parentEltIdx == UINT_MAX) { break; }
+            const detail::Element& parentElt = getElement(parentEltIdx);
+            if (parentElt.getType() == KEY) {
+                uint32_t mapEltIdx = _context->getParent(parentEltIdx);
+                if (mapEltIdx == UINT_MAX) { break; }  // Root key
+                segments.emplace_back();
+                detail::escapePathKey(std::string_view(_context->getString(parentElt.getStringIdx()), parentElt.getStringSize() - 1),
+                                      segments.back());
+                eltIdx = mapEltIdx;
+            } else {
+                uint32_t idx = 0, itemIdx = 0;
+                parentElt.forEachSubBlock([&](const uint32_t* subs, uint32_t subQty) {
+                    for (uint32_t i = 0; i < subQty; ++i, ++idx) {
+                        if (subs[i] == eltIdx) { itemIdx = idx; }
+                    }
+                });
+                segments.push_back("[" + std::to_string(itemIdx) + "]");
+                eltIdx = parentEltIdx;
+            }
+        }
+
+        std::string path;
+        for (auto it = segments.rbegin(); it != segments.rend(); ++it) {
+            if (!path.empty() && (*it)[0] != '[') { path += '.'; }
+            path += *it;
+        }
+        return path;
+    }
+
+    std::string to_string() const
+    {
+        assert(_context && _eltIdx < (uint32_t)_context->elements.size());
+        const detail::Element* elt = &getElement(_eltIdx);
+        switch (elt->getType()) {
+            case UNKNOWN:
+                return "[ Unknown ]";
+            case KEY:
+                if (elt->getStringSize() <= 1) { return "[ Root ]"; }
+                return std::string("[ Key '") + std::string(_context->getString(elt->getStringIdx())) + "' ]";
+            case VALUE:
+                return std::string("[ Value string '") + std::string(_context->getString(elt->getStringIdx())) + "' ]";
+            case SEQUENCE:
+                return std::string("[ Sequence of ") + std::to_string(elt->getSubQty()) + " elements ]";
+            case MAP:
+                return std::string("[ Map of ") + std::to_string(elt->getLiveSubQty()) + " elements ]";
+            case COMMENT:
+                return std::string("[ Comment '") + std::string(_context->getString(elt->getStringIdx())) + "' ]";
+        };
+        return "[ Weird ]";
+    }
 
     // Iterators
     // =========
@@ -1884,13 +4087,18 @@ class Node
         using pointer           = Node*;
         using reference         = Node&;
 
-        iterator(uint32_t* ptr, detail::Context* context) : _ptr(ptr), _context(context) {}
+        iterator(uint32_t* ptr, uint32_t* endPtr, detail::ChunkedSubs::Leaf* nextLeaf, detail::Context* context)
+            : _ptr(ptr), _endPtr(endPtr), _nextLeaf(nextLeaf), _context(context)
+        {
+            skipHoles();
+        }
 
         value_type operator*() const { return Node(*_ptr, _context); }
         value_type operator->() { return Node(*_ptr, _context); }
         iterator&  operator++()
         {
             _ptr += 1;
+            skipHoles();
             return *this;
         }
         iterator operator++(int)
@@ -1903,39 +4111,216 @@ class Node
         friend bool operator!=(const iterator& a, const iterator& b) { return a._ptr != b._ptr; };
 
        private:
-        uint32_t*        _ptr     = nullptr;
-        detail::Context* _context = nullptr;
+        // Also jumps to the next block of a chunked sequence
+        void skipHoles()
+        {
+            while (true) {
+                while (_ptr != _endPtr && *_ptr == detail::Element::Hole) { ++_ptr; }
+                if (_ptr != _endPtr || !_nextLeaf) { break; }
+                _ptr      = _nextLeaf->items;
+                _endPtr   = _nextLeaf->items + _nextLeaf->qty;
+                _nextLeaf = _nextLeaf->next;
+            }
+        }
+
+        uint32_t*                   _ptr      = nullptr;
+        uint32_t*                   _endPtr   = nullptr;
+        detail::ChunkedSubs::Leaf* _nextLeaf = nullptr;
+        detail::Context*            _context  = nullptr;
     };
 
-    iterator begin()
+    iterator begin() const
     {
         assert(_context && _eltIdx < (uint32_t)_context->elements.size());
-        detail::Element* elt = &_context->elements[_eltIdx];
+        const detail::Element* elt = &getElement(_eltIdx);
         if (elt->getType() != MAP && elt->getType() != SEQUENCE) {
             throwMessage<AccessException>("Access error: only the structural elements MAP and SEQUENCE can be iterated, not type '%s'.",
                                           styml::to_string(elt->getType()));
         }
-        return iterator(elt->getSubs(), _context);
+        if (elt->isChunked()) {
+            detail::ChunkedSubs::Leaf* leaf = elt->getChunks()->getFirstLeaf();
+            return iterator(leaf->items, leaf->items + leaf->qty, leaf->next, _context);
+        }
+        return iterator(elt->getSubs(), elt->getSubs() + elt->getSubQty(), nullptr, _context);
     }
-    iterator end()
+    iterator end() const
     {
         assert(_context && _eltIdx < (uint32_t)_context->elements.size());
-        detail::Element* elt = &_context->elements[_eltIdx];
+        const detail::Element* elt = &getElement(_eltIdx);
         if (elt->getType() != MAP && elt->getType() != SEQUENCE) {
             throwMessage<AccessException>("Access error: only the structural elements MAP and SEQUENCE can be iterated, not type '%s'.",
                                           styml::to_string(elt->getType()));
         }
-        return iterator(elt->getSubs() + elt->getSubQty(), _context);
+        if (elt->isChunked()) {
+            detail::ChunkedSubs::Leaf* leaf = elt->getChunks()->getLastLeaf();
+            return iterator(leaf->items + leaf->qty, leaf->items + leaf->qty, nullptr, _context);
+        }
+        return iterator(elt->getSubs() + elt->getSubQty(), elt->getSubs() + elt->getSubQty(), nullptr, _context);
     }
 
     Node* operator->() { return this; }
 
    protected:
+    friend class Document;
+    friend class LayeredView;
+    friend class Walker;
+    friend class Columns;
+    friend class Query;
+
+    // Parses the text under a detached root key, and returns the element index of the parsed node (0 if the text is empty)
+    uint32_t parseFragment(const char* text, uint32_t textSize) const;
+
+    // Replaces the content of the node (or the value of a key) with a detached element, which is moved.
+    // A zero element index gives an empty value
+    void replaceWith(uint32_t newEltIdx);
+
+    // Read access to an element, which never copies a storage page shared with a snapshot
+    const detail::Element& getElement(uint32_t eltIdx) const { return std::as_const(_context->elements)[eltIdx]; }
+
+    // Returns the element index of the map or sequence containing the element, or UINT_MAX for the root
+    uint32_t getParentContainer(uint32_t eltIdx) const
+    {
+        uint32_t parentEltIdx = _context->getParent(eltIdx);
+        if (parentEltIdx != UINT_MAX && getElement(parentEltIdx).getType() == KEY) {
+            parentEltIdx = _context->getParent(parentEltIdx);  // UINT_MAX for the root key
+        }
+        return parentEltIdx;
+    }
+
+    // Returns the element index of the key's value, or UINT_MAX if absent or if the element is not a map
+    uint32_t lookupKey(uint32_t eltIdx, const char* key, uint32_t keySize) const
+    {
+        const detail::Element* elt = &getElement(eltIdx);
+        if (elt->getType() != MAP || keySize == 0) { return UINT_MAX; }
+        uint32_t childIndex = _context->getMapChildIndex(eltIdx, key, keySize, elt);
+        if (childIndex == UINT_MAX) { return UINT_MAX; }
+        return getElement(elt->getSub(childIndex)).getKeyValue();
+    }
+
+    // Returns the element index of the sequence item, or UINT_MAX if absent or if the element is not a sequence
+    uint32_t lookupIndex(uint32_t eltIdx, uint32_t idx) const
+    {
+        const detail::Element* elt = &getElement(eltIdx);
+        if (elt->getType() != SEQUENCE || idx >= elt->getSubQty()) { return UINT_MAX; }
+        return elt->getSub(idx);
+    }
+
+    template<class T>
+    void decodeValue(const detail::Element* elt, T& typedValue) const
+    {
+        // Fast path: built-in numbers already decoded once are read from the typed value cache, if enabled
+        if constexpr (std::is_integral<T>::value || std::is_same<T, float>::value || std::is_same<T, double>::value) {
+            if (_context->isTypedValueCacheEnabled() && elt->getType() == VALUE && _context->getTypedValue(_eltIdx, typedValue)) {
+                return;
+            }
+        }
+        try {
+            convert<T>::decode((elt->getType() == VALUE) ? _context->getString(elt->getStringIdx()) : "", typedValue);
+        } catch (ConvertException& e) {
+            throwMessage<AccessException>("Access error: decoding error when accessing '%s' with 'as()':\n  %s", to_string().c_str(),
+                                          e.what());
+        }
+    }
+
+    // Reserves the storage before appending 'addedQty' children. It grows geometrically like the single appends, so that repeated
+    // small range appends stay linear
+    void reserveForAppend(const detail::Element* elt, size_t addedQty)
+    {
+        size_t neededQty = (size_t)elt->getSubQty() + addedQty;
+        if (neededQty > elt->getSubCapacity()) { reserve(std::max(neededQty, 2 * (size_t)elt->getSubCapacity())); }
+    }
+
+    // Checks that the node is a sequence and that the range [first, first + count[ is inside it
+    detail::Element* getSequenceForRange(const char* methodName, uint32_t first, uint32_t count) const
+    {
+        assert(_context && _eltIdx < (uint32_t)_context->elements.size());
+        detail::Element* elt = &_context->elements[_eltIdx];
+        if (elt->getType() != SEQUENCE) {
+            throwMessage<AccessException>("Access error: '%s(...)' can only be used on SEQUENCE elements, not '%s'", methodName,
+                                          to_string().c_str());
+        }
+        if ((uint64_t)first + count > elt->getSubQty()) {
+            throwMessage<AccessException>("Access error: '%s(...)' with the range [%u, %u[ is out of array bounds for '%s'", methodName,
+                                          first, first + count, to_string().c_str());
+        }
+        return elt;
+    }
+
+    template<class T>
+    void copyItemTo(uint32_t idx, uint32_t childEltIdx, T& typedValue) const
+    {
+        if constexpr (detail::hasDecodeNode<T>::value) {
+            Node(childEltIdx, _context).decodeStructure(typedValue);
+        } else {
+            const detail::Element& childElt = getElement(childEltIdx);
+            if (childElt.getType() != VALUE && childElt.getType() != UNKNOWN) {
+                throwMessage<AccessException>("Access error: 'copyTo(...)' cannot decode the item %u of '%s' as it is not of type 'Value'",
+                                              idx, to_string().c_str());
+            }
+            const char* strValue = (childElt.getType() == VALUE) ? _context->getString(childElt.getStringIdx()) : "";
+            if constexpr (std::is_arithmetic<T>::value) {
+                // Tight path for built-in numbers: the string size is known and no exception is involved in the nominal case
+                uint32_t             strSize = (childElt.getType() == VALUE) ? childElt.getStringSize() - 1 : 0;
+                detail::DecodeStatus status  = detail::decodeNumber(strValue, strSize, typedValue);
+                if (STYML_UNLIKELY(status != detail::DecodeStatus::Ok)) { decodeItem(idx, strValue, typedValue); }
+            } else {
+                decodeItem(idx, strValue, typedValue);
+            }
+        }
+    }
+
+    // Encodes a structured value in a new element which is not linked to the tree, and returns its index. The callers link it only
+    // after the encoding succeeded, so that a failed encoding leaves the tree unchanged
+    template<class T>
+    static uint32_t encodeDetached(const T& typedValue, detail::Context* context)
+    {
+        uint32_t eltIdx = (uint32_t)context->elements.size();
+        context->elements.emplace_back(SEQUENCE);  // Placeholder, that the converter turns into the right type
+        encodeStructure(typedValue, Node(eltIdx, context));
+        return eltIdx;
+    }
+
+    template<class T>
+    static void encodeStructure(const T& typedValue, Node target)
+    {
+        try {
+            convert<T>::encodeNode(typedValue, target);
+        } catch (ConvertException& e) {
+            throwMessage<AccessException>("Access error: encoding error when assigning to '%s':\n  %s", target.to_string().c_str(),
+                                          e.what());
+        }
+    }
+
+    template<class T>
+    void decodeStructure(T& typedValue) const
+    {
+        try {
+            convert<T>::decodeNode(*this, typedValue);
+        } catch (ConvertException& e) {
+            throwMessage<AccessException>("Access error: decoding error when accessing '%s' with 'as()':\n  %s", to_string().c_str(),
+                                          e.what());
+        }
+    }
+
+    template<class T>
+    void decodeItem(uint32_t idx, const char* strValue, T& typedValue) const
+    {
+        try {
+            convert<T>::decode(strValue, typedValue);
+        } catch (ConvertException& e) {
+            throwMessage<AccessException>("Access error: decoding error when accessing the item %u of '%s' with 'copyTo()':\n  %s", idx,
+                                          to_string().c_str(), e.what());
+        }
+    }
+
     uint32_t         _eltIdx  = 0xFFFFFFFF;
     detail::Context* _context = nullptr;
     std::string      _nonExistingKey;  // If not empty and node is a table, indicates a non-existing key in the table
 };
 
+// How 'Document::merge' combines a sequence of the overlay with a sequence at the same place in the document
+enum class MergePolicy { ReplaceSequences, AppendSequences };
+
 // A document is a node with extra capabilities: dump and delete
 class Document : public Node
 {
@@ -1943,7 +4328,7 @@ class Document : public Node
     explicit Document() : Node(0, new detail::Context())
     {
         _context->elements.emplace_back(KEY);
-        _context->addString("", 0, &_context->elements.back());  // Empty key name for root
+        _context->addString("", 0, 0);  // Empty key name for root
         initFromContext();
     }
     Document(detail::Context* context) : Node(0, context) { initFromContext(); }
@@ -1958,16 +4343,49 @@ class Document : public Node
 
     Node& operator=(const NodeType newKind) { return Node::operator=(newKind); }
 
+    // Deep copy of the whole document. The element indexes are kept, so the storage and the map index are copied as blocks
+    Document clone() const
+    {
+        Document copy(new detail::Context(*_context));
+        copy._eltIdx = _eltIdx;
+        return copy;
+    }
+
+    // Read-only view of the current state of the document, sharing its elements, strings and map index instead of copying them.
+    // The document copies a shared page only when modifying it, so publishing a new version costs the modified pages only.
+    // The snapshot is not impacted by the later modifications nor by the destruction of the document. Modifying it throws an
+    // AccessException, and it can be read concurrently by several threads. The parent index used by 'parent()', 'depth()' and
+    // 'path()' is built once, by the first thread using it
+    std::shared_ptr<const Document> snapshot() { return createSnapshot(); }
+
+    // Deep merge of an overlay node, typically the root of a more specific configuration layer. The maps are merged key by key,
+    // the sequences are replaced or appended depending on the policy, and the other overlay items replace the document ones.
+    // The overlay keys are looked up in the map index of the document, the new sub-trees are copied in one pass, and the changed
+    // values are updated in place. The comments of the overlay are kept only inside the copied sub-trees
+    void merge(const Node& overlay, MergePolicy policy = MergePolicy::ReplaceSequences);
+
+    // Memoizes the built-in numbers decoded with 'as<T>()', so that repeated typed reads of the same value do not parse it again
+    void enableTypedValueCache(bool state = true) { _context->enableTypedValueCache(state); }
+
     std::string asPyStruct(bool withIndent = false) const { return dumpAsPyStruct(_context, withIndent); }
     std::string asYaml() const { return dumpAsYaml(_context); }
 
    private:
+    friend class SharedDocument;
+
+    std::shared_ptr<Document> createSnapshot()
+    {
+        std::shared_ptr<Document> view = std::make_shared<Document>(_context->createSnapshot());
+        view->_eltIdx                   = _eltIdx;
+        return view;
+    }
+
     void initFromContext()
     {
         if (!_context->elements.empty()) {
-            detail::Element* root = &_context->elements[0];
-            _eltIdx               = 0;
-            if (root->getSubQty() > 0) {
+            const detail::Element* root = &getElement(0);
+            _eltIdx                     = 0;
+            if (root->getType() == KEY && root->getSubQty() > 0) {
                 _eltIdx = root->getKeyValue();  // Take the value node instead
             }
         }
@@ -1975,199 +4393,1383 @@ class Document : public Node
 };
 
 // ==========================================================================================
-// Parsing
+// Shared document
 // ==========================================================================================
 
-namespace detail
+// Document read by many threads while new versions of it are published, in the read-copy-update way.
+// The readers never lock nor wait: a read section registers the thread in the current epoch with an atomic increment on a
+// counter of its own cache line, and reads the current version. Publishing swaps the current version atomically, moves to the
+// next epoch, then waits for the end of the read sections of the previous epoch before releasing the previous version.
+// So the read sections shall be short, and 'load()' keeps a version alive for longer reads. A thread shall not publish while it
+// is inside a read section of the same shared document, as the publication would wait forever for the end of this section.
+// The published documents are read-only, and their typed value cache is disabled. Their parent index is built on first use, once
+// for all the readers
+class SharedDocument
 {
+    static constexpr size_t CacheLineSize = 64;
+    static constexpr size_t SlotQty       = 64;  // Reader counters, shared by the threads beyond this quantity
 
-enum class TokenType : uint16_t { Key, StringValue, Newline, Caret, Comment, Eos };
+    struct Version {
+        std::shared_ptr<const Document> document;
+    };
 
-struct TokenParser {
-    bool      isValid     = false;
-    TokenType type        = TokenType::Eos;
-    int       startColNbr = -1;
-    uint32_t  stringIdx   = 0;
-    uint32_t  stringSize  = 0;
-    explicit  operator bool() const { return isValid; }
-};
+   public:
+    // Read section on the current version, which stays valid until the end of the section whatever the publications
+    class Reader
+    {
+       public:
+        Reader(Reader&& rhs) noexcept : _counter(rhs._counter), _version(rhs._version) { rhs._counter = nullptr; }
+        Reader(const Reader& rhs)            = delete;
+        Reader& operator=(const Reader& rhs) = delete;
+        Reader& operator=(Reader&& rhs)      = delete;
+        ~Reader()
+        {
+            if (_counter) { _counter->fetch_sub(1); }
+        }
 
-inline TokenParser
-getToken(const char* text, uint32_t endIdx, int parentIndent, Context* context, StringHelper& sh, int& colNbr, int& lineNbr, uint32_t& idx)
-{
-    bool isNewLine = (colNbr == 0);
-    int  initIdx   = idx;
+        const Document& operator*() const { return *_version->document; }
+        const Document* operator->() const { return _version->document.get(); }
 
-    // Go to first non space
-    uint32_t idxFnp = idx;
-    if (isNewLine) {
-        while (idxFnp < endIdx && text[idxFnp] == ' ') ++idxFnp;
-        if (text[idxFnp] == '\t') { throwParsing(lineNbr, text + idx, "Parse error: using tabulation is not accepted for indentation"); }
-    } else {
-        while (idxFnp < endIdx && (text[idxFnp] == ' ' || text[idxFnp] == '\t')) ++idxFnp;
-    }
-    colNbr += idxFnp - idx;
-    idx             = idxFnp;
-    int startColNbr = colNbr;
+       private:
+        friend class SharedDocument;
+        Reader(std::atomic<uint32_t>* counter, const Version* version) : _counter(counter), _version(version) {}
 
-    // Case end of input
-    if (idx >= endIdx) { return {true, TokenType::Eos, startColNbr, 0, 0}; }
-    char firstChar = text[idx];
+        std::atomic<uint32_t>* _counter;
+        const Version*         _version;
+    };
 
-    // Case end of line
-    if (firstChar == '\n' || firstChar == '\r') {
-        if (idx + 1 < endIdx && firstChar == '\r' && text[idx + 1] == '\n') ++idx;
-        ++lineNbr;
-        colNbr = 0;
-        ++idx;
-        return {true, TokenType::Newline, startColNbr, 0, 0};
+    SharedDocument() : SharedDocument(Document()) {}
+    explicit SharedDocument(Document&& document) { publish(std::move(document)); }
+    SharedDocument(const SharedDocument& rhs)            = delete;
+    SharedDocument& operator=(const SharedDocument& rhs) = delete;
+    ~SharedDocument() { delete _current.load(); }  // No read section shall be active
+
+    // Lock-free entry in a read section. The sequentially consistent operations order the registration in the epoch before the
+    // read of the current version, as seen by the publisher
+    Reader read() const
+    {
+        Slot& slot = _slots[getThreadSlotIdx()];
+        while (true) {
+            uint32_t               epoch   = _epoch.load();
+            std::atomic<uint32_t>& counter = slot.readerQty[epoch & 1];
+            counter.fetch_add(1);
+            if (_epoch.load() == epoch) { return Reader(&counter, _current.load()); }
+            counter.fetch_sub(1);  // A publication moved to the next epoch in between
+        }
     }
 
-    // Case "-" as first on the line (followed by space or equivalent)
-    if (firstChar == '-' && (idx + 1 == endIdx || text[idx + 1] == ' ' || text[idx + 1] == '\r' || text[idx + 1] == '\n')) {
-        ++colNbr;
-        ++idx;
-        return {true, TokenType::Caret, startColNbr, 0, 0};
+    // Current version, kept alive by the returned pointer independently of the publications
+    std::shared_ptr<const Document> load() const { return read()._version->document; }
+
+    // Publishes a new version, typically freshly parsed. The previous version is released once no read section can access it
+    void publish(Document&& document)
+    {
+        std::shared_ptr<Document> next = std::make_shared<Document>(std::move(document));
+        install(std::move(next));
     }
 
-    // Case "#" (comment) @FIX should be preceded by space or equivalent
-    if (firstChar == '#') {
-        // Find the end of the line and return the comment. The newline will be handled in another call
-        uint32_t startIdx = idx + 1;
-        while (idx < endIdx && text[idx] != '\r' && text[idx] != '\n') {
-            ++idx;
-            ++colNbr;
+    // Publishes a copy-on-write snapshot of a document which keeps being modified. Only the storage pages modified since the
+    // previous publication are copied
+    void publishSnapshot(Document& document) { install(document.createSnapshot()); }
+
+   private:
+    struct alignas(CacheLineSize) Slot {
+        std::atomic<uint32_t> readerQty[2] = {};  // Indexed by the epoch parity
+    };
+
+    void install(std::shared_ptr<Document> next)
+    {
+        next->enableTypedValueCache(false);
+        next->_context->setReadOnly();
+
+        // The publications are serialized by spinning, as they are rare and the waits are bounded by the short read sections
+        while (_isPublishing.exchange(true, std::memory_order_acquire)) { STYML_CPU_RELAX(); }
+        const Version* previous = _current.exchange(new Version{std::move(next)});
+        uint32_t       epoch    = _epoch.fetch_add(1);
+
+        // Grace period: the read sections which may access the previous version are all registered in the previous epoch
+        if (previous) {
+            for (Slot& slot : _slots) {
+                while (slot.readerQty[epoch & 1].load() != 0) { STYML_CPU_RELAX(); }
+            }
         }
-        uint32_t stringIdx = 0, stringSize = 0;
-        context->addString(text + startIdx, idx - startIdx, stringIdx, stringSize);
-        return {true, TokenType::Comment, startColNbr, stringIdx, stringSize};
+        _isPublishing.store(false, std::memory_order_release);
+        delete previous;
     }
 
-    sh.startSession();
-    // Find the type of string to deal with (YAML is creative on this point...)
-    char mlType       = ' ';
-    char chomp        = ' ';
-    int  deltaIndent  = -1;
-    int  targetIndent = -1;
-    if (firstChar == '\'' || firstChar == '"') {
-        mlType = firstChar;
-        ++idx;
-        ++colNbr;
-        targetIndent = 0;  // Termination is not indent-based but quote based
-        // Add the leading spaces
-        uint32_t nonSpaceIdx = idx;
-        while (nonSpaceIdx < endIdx && text[nonSpaceIdx] == ' ') {
-            ++nonSpaceIdx;
-            sh.addChar(' ');
+    static size_t getThreadSlotIdx()
+    {
+        static std::atomic<size_t> threadQty{0};
+        thread_local size_t        slotIdx = threadQty.fetch_add(1, std::memory_order_relaxed) % SlotQty;
+        return slotIdx;
+    }
+
+    mutable std::array<Slot, SlotQty> _slots;
+    std::atomic<const Version*>       _current{nullptr};
+    std::atomic<uint32_t>             _epoch{0};
+    std::atomic<bool>                 _isPublishing{false};
+};
+
+// ==========================================================================================
+// Layered view
+// ==========================================================================================
+
+// Read-only view on a stack of layers (documents or sub-trees), the last one on top, which resolves the keys without
+// materializing their merge. It follows the rules of 'Document::merge' with replaced sequences: the maps are combined key by
+// key, and any other item hides the items of the lower layers at the same path. A key is looked up in the map index of each
+// layer from the top, with a single hash of the key, and the resolved paths are cached in the view. So creating a view copies
+// nothing, and its cost is independent of the layer sizes. The layers shall not be modified during the view lifetime, and
+// a view shall be used by a single thread, as its cache is updated by the lookups
+class LayeredView
+{
+    struct Hit {
+        uint32_t layerIdx;
+        uint32_t eltIdx;  // Value element in this layer
+    };
+    struct Entry {
+        uint32_t    firstHit;  // Hits are contiguous, from the top layer
+        uint32_t    hitQty;
+        std::string keyName;
+        uint32_t    childListIdx = UINT_MAX;  // Children built on first iteration
+    };
+
+   public:
+    // Item of the view at some path. It is invalid (evaluating to false) when the path exists in no layer
+    class Item
+    {
+       public:
+        Item() = default;
+
+        explicit operator bool() const { return _view && _view->_entries[_entryIdx].hitQty > 0; }
+
+        // Topmost node at this path, which can be used with the read API of Node
+        Node node() const
+        {
+            if (!*this) { return Node(); }
+            const Hit& hit = _view->_hits[_view->_entries[_entryIdx].firstHit];
+            return Node(hit.eltIdx, _view->_layers[hit.layerIdx]._context);
         }
-        colNbr += nonSpaceIdx - idx;
-    } else if (firstChar == '|' || firstChar == '>') {
-        mlType = firstChar;
-        ++idx;
-        ++colNbr;
-        // @TODO Add check for unwanted characters
-        for (int i = 0; i < 2; ++i) {  // Two passes as we shall extract 2 infos (chomp & indent) in any order
-            if (idx >= endIdx) { break; }
-            if (text[idx] == '+' || text[idx] == '-') {
-                if (chomp != ' ') throwParsing(lineNbr, text + initIdx, "Parse error: chomp cannot be provided more than once");
-                chomp = text[idx];
-                ++idx;
-                ++colNbr;
-            } else if (text[idx] >= '1' && text[idx] <= '9') {
-                if (deltaIndent >= 0)
-                    throwParsing(lineNbr, text + initIdx, "Parse error: explicit indentation cannot be provided more than once");
-                deltaIndent = text[idx] - '0';
-                ++idx;
-                ++colNbr;
+
+        NodeType           type() const { return checkedNode("type()").type(); }
+        const std::string& keyName() const { return _view->_entries[_entryIdx].keyName; }  // Empty for the root and sequence items
+
+        // A structure is decoded from the topmost layer only
+        template<class T>
+        T as() const
+        {
+            return checkedNode("as()").template as<T>();
+        }
+        template<class T>
+        T as(const T& defaultValue) const
+        {
+            return *this ? node().template as<T>(defaultValue) : defaultValue;
+        }
+
+        // Non-throwing lookups: an absent key or index gives an invalid item
+        Item operator[](std::string_view key) const
+        {
+            if (!*this) { return Item(); }
+            return Item(_view, _view->resolveKey(_entryIdx, key));
+        }
+        Item operator[](uint32_t idx) const
+        {
+            if (!*this || type() != SEQUENCE) { return Item(); }
+            const std::vector<uint32_t>& children = _view->getChildren(_entryIdx);
+            return (idx < children.size()) ? Item(_view, children[idx]) : Item();
+        }
+
+        // Quantity of distinct keys of a map in all layers, or of items of the topmost sequence
+        size_t size() const
+        {
+            NodeType t = type();
+            if (t != MAP && t != SEQUENCE) {
+                throwMessage<AccessException>("Access error: 'size()' can only be used on the structural elements MAP and SEQUENCE");
             }
+            return _view->getChildren(_entryIdx).size();
+        }
+
+        // The map keys are iterated in the order of the lowest layer defining them, the upper layers adding their new keys
+        struct iterator {
+            using iterator_category = std::forward_iterator_tag;
+            using difference_type   = ptrdiff_t;
+            using value_type        = Item;
+            using pointer           = Item*;
+            using reference         = Item&;
+
+            iterator(LayeredView* view, const uint32_t* ptr) : _view(view), _ptr(ptr) {}
+            value_type operator*() const { return Item(_view, *_ptr); }
+            iterator&  operator++()
+            {
+                ++_ptr;
+                return *this;
+            }
+            iterator operator++(int)
+            {
+                iterator tmp = *this;
+                ++_ptr;
+                return tmp;
+            }
+            friend bool operator==(const iterator& a, const iterator& b) { return a._ptr == b._ptr; };
+            friend bool operator!=(const iterator& a, const iterator& b) { return a._ptr != b._ptr; };
+
+           private:
+            LayeredView*    _view;
+            const uint32_t* _ptr;
+        };
+
+        iterator begin() const
+        {
+            size();  // Checks the type
+            const std::vector<uint32_t>& children = _view->getChildren(_entryIdx);
+            return iterator(_view, children.data());
+        }
+        iterator end() const
+        {
+            size();  // Checks the type
+            const std::vector<uint32_t>& children = _view->getChildren(_entryIdx);
+            return iterator(_view, children.data() + children.size());
+        }
+
+       private:
+        friend class LayeredView;
+        Item(LayeredView* view, uint32_t entryIdx) : _view(view), _entryIdx(entryIdx) {}
+
+        Node checkedNode(const char* methodName) const
+        {
+            if (!*this) {
+                throwMessage<AccessException>("Access error: '%s' cannot be used on an absent item of a layered view", methodName);
+            }
+            return node();
+        }
+
+        LayeredView* _view     = nullptr;
+        uint32_t     _entryIdx = 0;
+    };
+
+    // The layers are given from the bottom to the top, and shall outlive the view
+    LayeredView(std::initializer_list<Node> layers) : LayeredView(std::vector<Node>(layers)) {}
+    explicit LayeredView(std::vector<Node> layers) : _layers(std::move(layers))
+    {
+        _entries.push_back({0, 0, std::string()});
+        for (uint32_t layerIdx = (uint32_t)_layers.size(); layerIdx-- > 0;) {
+            const Node& layer = _layers[layerIdx];
+            if (!layer) { throwMessage<AccessException>("Access error: a layer of a layered view cannot be an invalid node"); }
+            uint32_t eltIdx = layer._eltIdx;
+            if (layer.getElement(eltIdx).getType() == KEY) { eltIdx = layer.getElement(eltIdx).getKeyValue(); }
+            if (eltIdx == 0) { continue; }  // Empty document
+            addHit(_entries[0], layerIdx, eltIdx);
+            if (layer.getElement(eltIdx).getType() != MAP) { break; }  // Hides the lower layers
         }
-        // @TODO: Go to endline (and check that there is only blanks except comment (to skip)...) and generate errors
-        //        Current behavior is just ignoring the rest of the line, which allows things like "2+ +++2222++"
-        while (idx < endIdx && text[idx] != '\n' && text[idx] != '\r') { ++idx; }
-        if (idx + 1 < endIdx && text[idx] == '\r' && text[idx + 1] == '\n') { ++idx; }
-        ++idx;
-        ++lineNbr;
-        colNbr    = 0;
-        isNewLine = true;
-        if (deltaIndent >= 0) { targetIndent = parentIndent + deltaIndent; }
-    } else {
-        // For plain string, indent does not matter as text is stripped, only the parent indent matters
-        // We shall check however that it is indeed a child. Else the accept the current indent "as is"
-        targetIndent = (colNbr > parentIndent) ? parentIndent + 1 : colNbr;
     }
+    LayeredView(const LayeredView& rhs)            = delete;  // The items point to the view
+    LayeredView& operator=(const LayeredView& rhs) = delete;
 
-    bool isKey              = false;
-    bool indentedFoldedLine = false;
+    Item root() { return Item(this, 0); }
+    Item operator[](std::string_view key) { return root()[key]; }
 
-    // Analyse the string line per line
-    while (idx < endIdx) {
-        // Find first non-space character
-        uint32_t nonSpaceIdx = idx;
-        while (nonSpaceIdx < endIdx && text[nonSpaceIdx] == ' ') ++nonSpaceIdx;
-        colNbr += nonSpaceIdx - idx;
-        if (isNewLine && nonSpaceIdx < endIdx && text[nonSpaceIdx] == '\t') {
-            throwParsing(lineNbr, text + initIdx, "Parse error: using tabulation is not accepted for indentation");
+   private:
+    void addHit(Entry& entry, uint32_t layerIdx, uint32_t eltIdx)
+    {
+        if (entry.hitQty == 0) { entry.firstHit = (uint32_t)_hits.size(); }
+        _hits.push_back({layerIdx, eltIdx});
+        ++entry.hitQty;
+    }
+
+    const detail::Element& getElement(const Hit& hit) const
+    {
+        return std::as_const(_layers[hit.layerIdx]._context->elements)[hit.eltIdx];
+    }
+
+    // Returns the entry of a key of the map entry, from the cache or by probing the layers from the top
+    uint32_t resolveKey(uint32_t parentEntryIdx, std::string_view key)
+    {
+        uint32_t keyHash  = (uint32_t)detail::wyhash(key.data(), key.size());
+        uint64_t cacheKey = ((uint64_t)parentEntryIdx << 32) | keyHash;
+        for (auto range = _cache.equal_range(cacheKey); range.first != range.second; ++range.first) {
+            if (_entries[range.first->second].keyName == key) { return range.first->second; }
         }
-        // Compute the expected indent (folded or literal strings case only)
-        int effectiveIndent = (uint32_t)(nonSpaceIdx - idx);
-        if (targetIndent < 0) {
-            // Initial empty line case
-            if (text[nonSpaceIdx] == '\n' || text[nonSpaceIdx] == '\r') {  // @BUG Need to handle comments too
-                if (sh.empty()) {
-                    sh.addLine("", 0);
-                } else {
-                    sh.addLine("\n", 1);
+
+        uint32_t entryIdx = (uint32_t)_entries.size();
+        _entries.push_back({0, 0, std::string(key)});
+        Entry&   parent = _entries[parentEntryIdx];
+        uint32_t hitEnd = parent.firstHit + parent.hitQty;
+        for (uint32_t hitIdx = parent.firstHit; hitIdx < hitEnd; ++hitIdx) {
+            Hit                    hit    = _hits[hitIdx];
+            const detail::Element& mapElt = getElement(hit);
+            if (mapElt.getType() != MAP) { break; }
+            const detail::Context* context = _layers[hit.layerIdx]._context;
+            uint32_t childIndex = context->getMapChildIndex(hit.eltIdx, keyHash, key.data(), (uint32_t)key.size(), &mapElt);
+            if (childIndex == UINT_MAX) { continue; }
+            uint32_t valueEltIdx = std::as_const(context->elements)[mapElt.getSub(childIndex)].getKeyValue();
+            if (valueEltIdx == 0) { continue; }
+            addHit(_entries[entryIdx], hit.layerIdx, valueEltIdx);
+            if (std::as_const(context->elements)[valueEltIdx].getType() != MAP) { break; }  // Hides the lower layers
+        }
+        _cache.emplace(cacheKey, entryIdx);
+        return entryIdx;
+    }
+
+    // Builds once the children entries of a map (union of the keys of all layers) or of the topmost sequence
+    const std::vector<uint32_t>& getChildren(uint32_t entryIdx)
+    {
+        if (_entries[entryIdx].childListIdx != UINT_MAX) { return _childLists[_entries[entryIdx].childListIdx]; }
+        std::vector<uint32_t> children;
+        Entry                 entry = _entries[entryIdx];  // Copy, as the entries grow during the resolution
+        Hit                   top   = _hits[entry.firstHit];
+        if (getElement(top).getType() == SEQUENCE) {
+            getElement(top).forEachSubBlock([this, &children, top](const uint32_t* subs, uint32_t subQty) {
+                for (uint32_t i = 0; i < subQty; ++i) {
+                    if (getElement({top.layerIdx, subs[i]}).getType() == COMMENT) { continue; }
+                    children.push_back((uint32_t)_entries.size());
+                    _entries.push_back({0, 0, std::string()});
+                    addHit(_entries.back(), top.layerIdx, subs[i]);
                 }
-                idx = nonSpaceIdx + ((nonSpaceIdx + 1 < endIdx && text[nonSpaceIdx] == '\r' && text[nonSpaceIdx + 1] == '\n') ? 2 : 1);
-                indentedFoldedLine = true;
-                ++lineNbr;
-                colNbr = 0;
+            });
+        } else {
+            std::vector<bool> isListed;  // By entry index
+            for (uint32_t hitIdx = entry.firstHit + entry.hitQty; hitIdx-- > entry.firstHit;) {  // From the lowest layer
+                Hit hit = _hits[hitIdx];
+                if (getElement(hit).getType() != MAP) { continue; }
+                const detail::Context* context = _layers[hit.layerIdx]._context;
+                getElement(hit).forEachSubBlock([&](const uint32_t* subs, uint32_t subQty) {
+                    for (uint32_t i = 0; i < subQty; ++i) {
+                        if (subs[i] == detail::Element::Hole) { continue; }
+                        const detail::Element& keyElt = std::as_const(context->elements)[subs[i]];
+                        if (keyElt.getType() != KEY) { continue; }
+                        uint32_t childEntryIdx =
+                            resolveKey(entryIdx, std::string_view(context->getString(keyElt.getStringIdx()), keyElt.getStringSize() - 1));
+                        if (childEntryIdx >= isListed.size()) { isListed.resize(_entries.size()); }
+                        if (!isListed[childEntryIdx]) {
+                            isListed[childEntryIdx] = true;
+                            children.push_back(childEntryIdx);
+                        }
+                    }
+                });
+            }
+        }
+        _entries[entryIdx].childListIdx = (uint32_t)_childLists.size();
+        _childLists.push_back(std::move(children));
+        return _childLists.back();
+    }
+
+    std::vector<Node>                           _layers;
+    std::vector<Entry>                          _entries;  // The root entry is first
+    std::vector<Hit>                            _hits;
+    std::vector<std::vector<uint32_t>>          _childLists;  // Their storage does not move when the list of lists grows
+    std::unordered_multimap<uint64_t, uint32_t> _cache;  // (parent entry index, key hash) -> entry index
+};
+
+// ==========================================================================================
+// Tree walking
+// ==========================================================================================
+
+// Base of the visitors of 'walk', with empty callbacks. A visitor derives from it and redefines the callbacks it needs, which
+// are statically dispatched. Returning false from an 'enter' callback skips the children, and the 'leave' callback is still called.
+// The container sizes are the ones of 'size()'. The string views point inside the document, and the comments are not visited
+struct Visitor {
+    bool enterMap(uint32_t /*size*/) { return true; }
+    void leaveMap() {}
+    bool enterSequence(uint32_t /*size*/) { return true; }
+    void leaveSequence() {}
+    bool enterKey(std::string_view /*key*/) { return true; }
+    void leaveKey(std::string_view /*key*/) {}
+    void onValue(std::string_view /*value*/) {}
+};
+
+// Depth-first traversal of a sub-tree with an explicit stack, without any Node nor std::string creation per visited item.
+// The stack is kept between walks. The document shall not be modified during the walk
+class Walker
+{
+   public:
+    template<class V>
+    void walk(const Node& node, V& visitor)
+    {
+        if (!node) { return; }
+        _elements = &node._context->elements;
+        _strings  = node._context;
+        _stack.clear();
+
+        uint32_t eltIdx = node._eltIdx;
+        if ((*_elements)[eltIdx].getType() == KEY && eltIdx == 0) {  // Root key of an empty document
+            if ((*_elements)[0].getSubQty() == 0) { return; }
+            eltIdx = (*_elements)[0].getKeyValue();
+        }
+        enter(eltIdx, visitor);
+
+        while (!_stack.empty()) {
+            uint32_t childIdx = nextChild(_stack.back());
+            if (childIdx != detail::Element::Hole) {
+                enter(childIdx, visitor);
                 continue;
             }
-            // Set the expected indent
-            targetIndent = colNbr;
+            leave(_stack.back().eltIdx, visitor);
+            _stack.pop_back();
         }
+    }
 
-        uint32_t lineEndIdx           = nonSpaceIdx;
-        bool     isEndOfStringReached = false;
+   private:
+    // Cursor on the children of a container, one contiguous block at a time
+    struct Frame {
+        uint32_t                         eltIdx;
+        const uint32_t*                  subs;    // Next children in the current block
+        uint32_t                         subQty;  // Remaining children in the current block, or 1 if the key value is not visited
+        const detail::ChunkedSubs::Leaf* leaf;    // Current block of a chunked sequence
+    };
 
-        // Single quote case: process one line. Focus on double single quote
-        if (mlType == '\'') {
-            bool isFirstAdd = !sh.empty();
-            ;
-            uint32_t chunkStartIdx = lineEndIdx;
-            while (lineEndIdx < endIdx && text[lineEndIdx] != '\n' && text[lineEndIdx] != '\r') {
-                // Easy non-single quote case
-                if (text[lineEndIdx] != '\'') {
-                    ++lineEndIdx;
-                    continue;
+    std::string_view getString(const detail::Element& elt) const
+    {
+        return std::string_view(_strings->getString(elt.getStringIdx()), elt.getStringSize() - 1);
+    }
+
+    template<class V>
+    void enter(uint32_t eltIdx, V& visitor)
+    {
+        const detail::Element& elt = (*_elements)[eltIdx];
+        switch (elt.getType()) {
+            case VALUE:
+                visitor.onValue(getString(elt));
+                break;
+            case KEY:
+                if (!visitor.enterKey(getString(elt))) {
+                    visitor.leaveKey(getString(elt));
+                } else if (elt.getSubQty() == 0) {
+                    visitor.onValue(std::string_view());
+                    visitor.leaveKey(getString(elt));
+                } else {
+                    _stack.push_back({eltIdx, nullptr, 1, nullptr});
                 }
-                // Escaped (=double) single quote ?
-                if (lineEndIdx + 1 < endIdx && text[lineEndIdx + 1] == '\'') {
-                    if (isFirstAdd) {
-                        if (sh.arena.back() != '\n') { sh.addChar(' '); }
-                        isFirstAdd = false;
-                    }
-                    sh.addChunk(text + chunkStartIdx, lineEndIdx + 1 - chunkStartIdx);  // Keep one single quote
-                    lineEndIdx += 2;
-                    chunkStartIdx = lineEndIdx;
-                    continue;
+                break;
+            case SEQUENCE:
+            case MAP:
+                if (!((elt.getType() == MAP) ? visitor.enterMap(elt.getLiveSubQty()) : visitor.enterSequence(elt.getSubQty()))) {
+                    leave(eltIdx, visitor);
+                } else if (elt.isChunked()) {
+                    const detail::ChunkedSubs::Leaf* leaf = elt.getChunks()->getFirstLeaf();
+                    _stack.push_back({eltIdx, leaf->items, leaf->qty, leaf});
+                } else {
+                    _stack.push_back({eltIdx, elt.getSubs(), elt.getSubQty(), nullptr});
                 }
-                isEndOfStringReached = true;
                 break;
-            }
-            if (isFirstAdd && sh.arena.back() != '\n') { sh.addChar(' '); }
-            if (lineEndIdx > chunkStartIdx) { sh.addChunk(text + chunkStartIdx, lineEndIdx - chunkStartIdx); }
-            if (lineEndIdx >= endIdx) { throwParsing(lineNbr, text + initIdx, "Parse error: unfinished single-quote string"); }
-            if (text[lineEndIdx] == '\'') {
-                isEndOfStringReached = true;
-                ++lineEndIdx;  // Skip double quote
-                while (text[lineEndIdx] == ' ' || text[lineEndIdx] == '\t') { ++lineEndIdx; }
-            }
-            if (!isEndOfStringReached && nonSpaceIdx == lineEndIdx) { sh.addLine("\n", 1); }
-        }  // End of single quote case
+            case COMMENT:
+                break;
+            default:  // Empty value
+                visitor.onValue(std::string_view());
+        }
+    }
 
-        // Double quote case: process one line. Focus on backslash escape
+    template<class V>
+    void leave(uint32_t eltIdx, V& visitor)
+    {
+        const detail::Element& elt = (*_elements)[eltIdx];
+        if (elt.getType() == KEY) {
+            visitor.leaveKey(getString(elt));
+        } else if (elt.getType() == MAP) {
+            visitor.leaveMap();
+        } else {
+            visitor.leaveSequence();
+        }
+    }
+
+    // Returns the next child of the frame (the holes of the maps are skipped), or Element::Hole at the end
+    uint32_t nextChild(Frame& frame)
+    {
+        if ((*_elements)[frame.eltIdx].getType() == KEY) {
+            if (frame.subQty == 0) { return detail::Element::Hole; }
+            frame.subQty = 0;
+            return (*_elements)[frame.eltIdx].getKeyValue();
+        }
+        while (true) {
+            while (frame.subQty > 0) {
+                uint32_t childIdx = *frame.subs++;
+                --frame.subQty;
+                if (frame.subQty > 0) { STYML_PREFETCH(&(*_elements)[*frame.subs]); }  // The next sibling is likely the next visit
+                if (childIdx != detail::Element::Hole) { return childIdx; }
+            }
+            if (!frame.leaf || !frame.leaf->next) { return detail::Element::Hole; }
+            frame.leaf   = frame.leaf->next;
+            frame.subs   = frame.leaf->items;
+            frame.subQty = frame.leaf->qty;
+        }
+    }
+
+    const detail::Context::Elements* _elements = nullptr;
+    const detail::Context*           _strings  = nullptr;
+    std::vector<Frame>               _stack;
+};
+
+// Walks the sub-tree of the node with a temporary walker
+template<class V>
+void
+walk(const Node& node, V& visitor)
+{
+    Walker walker;
+    walker.walk(node, visitor);
+}
+
+// ==========================================================================================
+// Columnar view
+// ==========================================================================================
+
+// Column-oriented snapshot of some keys of a sequence of maps, for the scans over many records. Each column has one entry per
+// item of the sequence, in contiguous arrays. The numeric columns are also decoded, with the rules of 'as<T>()'.
+// The missing keys and the empty values are marked as absent. The string views point inside the document, so the view shall
+// not be used after a modification of the document
+class Columns
+{
+   public:
+    enum class Kind {
+        Integer,  // All the present values are integers. Both 'integers' and 'floats' are filled
+        Float,    // All the present values are numbers. 'floats' is filled
+        String    // No typed array
+    };
+
+    struct Column {
+        std::string                   name;
+        Kind                          kind = Kind::String;
+        std::vector<int64_t>          integers;   // Absent values are 0
+        std::vector<double>           floats;     // Absent values are NaN
+        std::vector<std::string_view> strings;    // Absent values are empty
+        std::vector<uint8_t>          isPresent;  // 1 if the key is present with a non-empty value
+    };
+
+    Columns(const Node& records, const std::string_view* keyNames, size_t keyNameQty);
+
+    size_t rowQty() const { return _rowQty; }
+    size_t size() const { return _columns.size(); }
+
+    const Column& operator[](size_t columnIdx) const
+    {
+        if (columnIdx >= _columns.size()) {
+            throwMessage<AccessException>("Access error: the column index %zu is out of bounds (%zu columns)", columnIdx,
+                                          _columns.size());
+        }
+        return _columns[columnIdx];
+    }
+
+    const Column& operator[](std::string_view name) const
+    {
+        for (const Column& column : _columns) {
+            if (column.name == name) { return column; }
+        }
+        throwMessage<AccessException>("Access error: the column '%s' is not present in the view", std::string(name).c_str());
+        return _columns[0];  // Unreachable
+    }
+
+    std::vector<Column>::const_iterator begin() const { return _columns.begin(); }
+    std::vector<Column>::const_iterator end() const { return _columns.end(); }
+
+   private:
+    // Stores the value of the row, and narrows the kind of the column if the value does not fit it
+    void addValue(Column& column, uint32_t rowIdx, std::string_view value)
+    {
+        column.strings[rowIdx]   = value;
+        column.isPresent[rowIdx] = 1;
+        if (column.kind == Kind::Integer) {
+            uint64_t magnitude  = 0;
+            bool     isNegative = false;
+            int64_t  number     = 0;
+            if (detail::parseInteger(value.data(), (uint32_t)value.size(), magnitude, isNegative) == detail::DecodeStatus::Ok &&
+                detail::narrowInteger(magnitude, isNegative, number) == detail::DecodeStatus::Ok) {
+                column.integers[rowIdx] = number;
+                column.floats[rowIdx]   = (double)number;
+                return;
+            }
+            column.kind = Kind::Float;
+            std::vector<int64_t>().swap(column.integers);
+        }
+        if (column.kind == Kind::Float) {
+            double number = 0.;
+            if (detail::decodeFloat(value.data(), (uint32_t)value.size(), number) == detail::DecodeStatus::Ok) {
+                column.floats[rowIdx] = number;
+                return;
+            }
+            column.kind = Kind::String;
+            std::vector<double>().swap(column.floats);
+        }
+    }
+
+    size_t              _rowQty = 0;
+    std::vector<Column> _columns;
+};
+
+inline Columns::Columns(const Node& records, const std::string_view* keyNames, size_t keyNameQty)
+{
+    if (!records || records.getElement(records._eltIdx).getType() != SEQUENCE) {
+        throwMessage<AccessException>("Access error: 'columns(...)' can only be used on SEQUENCE elements, not '%s'",
+                                      records ? records.to_string().c_str() : "invalid node");
+    }
+    detail::Context*                 context  = records._context;
+    const detail::Context::Elements& elements = context->elements;  // Read-only access
+    const detail::Element&           seqElt   = elements[records._eltIdx];
+    seqElt.forEachSubBlock([&](const uint32_t* subs, uint32_t subQty) {
+        for (uint32_t i = 0; i < subQty; ++i) { _rowQty += (elements[subs[i]].getType() != COMMENT) ? 1 : 0; }
+    });
+
+    std::vector<Key>      keys;
+    std::vector<uint32_t> childIndexHints(keyNameQty, UINT_MAX);
+    keys.reserve(keyNameQty);
+    _columns.resize(keyNameQty);
+    for (size_t columnIdx = 0; columnIdx < keyNameQty; ++columnIdx) {
+        keys.emplace_back(keyNames[columnIdx]);
+        Column& column = _columns[columnIdx];
+        column.name    = std::string(keyNames[columnIdx]);
+        column.kind    = Kind::Integer;
+        column.integers.resize(_rowQty, 0);
+        column.floats.resize(_rowQty, std::numeric_limits<double>::quiet_NaN());
+        column.strings.resize(_rowQty);
+        column.isPresent.resize(_rowQty, 0);
+    }
+
+    uint32_t rowIdx = 0;
+    seqElt.forEachSubBlock([&](const uint32_t* subs, uint32_t subQty) {
+        for (uint32_t i = 0; i < subQty; ++i) {
+            const detail::Element& itemElt = elements[subs[i]];
+            if (itemElt.getType() == COMMENT) { continue; }
+            if (itemElt.getType() != MAP) {
+                throwMessage<AccessException>("Access error: 'columns(...)' requires a sequence of maps, but the item %u is '%s'", rowIdx,
+                                              Node(subs[i], context).to_string().c_str());
+            }
+            Node item(subs[i], context);
+            for (size_t columnIdx = 0; columnIdx < keyNameQty; ++columnIdx) {
+                Node value = item.find(keys[columnIdx], childIndexHints[columnIdx]);
+                if (!value) { continue; }
+                const detail::Element& valueElt = elements[value._eltIdx];
+                if (valueElt.getType() == MAP || valueElt.getType() == SEQUENCE) {
+                    throwMessage<AccessException>("Access error: the column '%s' shall contain scalar values, but the item %u has '%s'",
+                                                  _columns[columnIdx].name.c_str(), rowIdx, value.to_string().c_str());
+                }
+                if (valueElt.getType() != VALUE || valueElt.getStringSize() <= 1) { continue; }  // Empty value
+                addValue(_columns[columnIdx], rowIdx,
+                         std::string_view(context->getString(valueElt.getStringIdx()), valueElt.getStringSize() - 1));
+            }
+            ++rowIdx;
+        }
+    });
+
+    // The columns without any present value have no kind to infer
+    for (Column& column : _columns) {
+        if (std::find(column.isPresent.begin(), column.isPresent.end(), 1) == column.isPresent.end()) {
+            column.kind = Kind::String;
+            std::vector<int64_t>().swap(column.integers);
+            std::vector<double>().swap(column.floats);
+        }
+    }
+}
+
+inline Columns
+Node::columns(std::initializer_list<std::string_view> keyNames) const
+{
+    return Columns(*this, keyNames.begin(), keyNames.size());
+}
+
+inline Columns
+Node::columns(const std::vector<std::string>& keyNames) const
+{
+    std::vector<std::string_view> names(keyNames.begin(), keyNames.end());
+    return Columns(*this, names.data(), names.size());
+}
+
+// ==========================================================================================
+// Path queries
+// ==========================================================================================
+
+// Path with wildcards, compiled once and evaluated on many nodes. The syntax extends the one of 'findPath':
+//  - 'key' selects the value of the key in a map, and '[n]' the item n of a sequence
+//  - '*' selects the values of all the keys of a map, and '[*]' all the items of a sequence
+//  - '**' selects the node and all its descendants, at any depth
+// Ex: "services.*.image", "jobs[*].steps[*].run", "**.timeout"
+// The matches are provided in depth-first order. The evaluation state is local, so the callback may evaluate the same query again,
+// but the document shall not be modified during an evaluation
+class Query
+{
+   public:
+    explicit Query(std::string_view path) : _path(path)
+    {
+        size_t pos = 0;
+        while (pos < _path.size()) {
+            if (_path[pos] == '[') {
+                size_t endPos = _path.find(']', pos);
+                if (endPos == std::string::npos) { throwQueryError("missing closing bracket", pos); }
+                if (endPos == pos + 2 && _path[pos + 1] == '*') {
+                    _steps.push_back({StepKind::AnyIndex, 0, 0, 0, 0});
+                } else {
+                    uint32_t idx       = 0;
+                    auto [lastPtr, ec] = std::from_chars(_path.data() + pos + 1, _path.data() + endPos, idx);
+                    if (ec != std::errc() || lastPtr != _path.data() + endPos) { throwQueryError("invalid sequence index", pos + 1); }
+                    _steps.push_back({StepKind::Index, idx, 0, 0, 0});
+                }
+                pos = endPos + 1;
+            } else {
+                bool   isEscaped = false;
+                size_t endPos    = detail::findPathKeyEnd(_path, pos, isEscaped);
+                if (endPos == std::string::npos) { throwQueryError("missing escaped character", _path.size()); }
+                if (endPos == pos) { throwQueryError("empty key", pos); }
+                std::string_view key(_path.data() + pos, endPos - pos);
+                if (key == "*") {
+                    _steps.push_back({StepKind::AnyKey, 0, 0, 0, 0});
+                } else if (key == "**") {
+                    _steps.push_back({StepKind::Descendants, _descendantQty++, 0, 0, 0});
+                } else {
+                    uint32_t keyOffset = (uint32_t)_keys.size();
+                    detail::unescapePathKey(key, _keys);
+                    uint32_t keySize = (uint32_t)_keys.size() - keyOffset;
+                    uint32_t hash    = (uint32_t)detail::wyhash(_keys.data() + keyOffset, keySize);
+                    _steps.push_back({StepKind::Key, 0, hash, keyOffset, keySize});
+                }
+                pos = endPos;
+            }
+            if (pos < _path.size() && _path[pos] == '.') {
+                if (++pos == _path.size()) { throwQueryError("empty key", pos); }
+            }
+        }
+    }
+
+    const std::string& path() const { return _path; }
+
+    // Calls 'fn(Node)' for each matching node
+    template<class Fn>
+    void forEach(const Node& node, Fn&& fn) const
+    {
+        if (!node) { return; }
+        const detail::Context::Elements& elements = node._context->elements;
+        uint32_t                         eltIdx   = node._eltIdx;
+        if (elements[eltIdx].getType() == KEY && eltIdx == 0) {  // Root key of an empty document
+            if (elements[0].getSubQty() == 0) { return; }
+            eltIdx = elements[0].getKeyValue();
+        }
+        std::vector<State>           stack;
+        std::unordered_set<uint64_t> visited;  // (element, '**' step) pairs already processed, sized by the visited subtree
+        stack.push_back({eltIdx, 0});
+
+        while (!stack.empty()) {
+            State state = stack.back();
+            stack.pop_back();
+            if (state.stepIdx == _steps.size()) {
+                fn(Node(state.eltIdx, node._context));
+                continue;
+            }
+            const Step&            step = _steps[state.stepIdx];
+            const detail::Element& elt  = elements[state.eltIdx];
+            switch (step.kind) {
+                case StepKind::Key:
+                    if (elt.getType() == MAP) {
+                        uint32_t childIndex = node._context->getMapChildIndex(state.eltIdx, step.hash, _keys.data() + step.keyOffset,
+                                                                              step.keySize, &elt);
+                        uint32_t valueIdx = (childIndex != UINT_MAX) ? elements[elt.getSub(childIndex)].getKeyValue() : 0;
+                        if (valueIdx != 0) { stack.push_back({valueIdx, state.stepIdx + 1}); }
+                    }
+                    break;
+                case StepKind::Index:
+                    if (elt.getType() == SEQUENCE && step.value < elt.getSubQty()) {
+                        stack.push_back({elt.getSub(step.value), state.stepIdx + 1});
+                    }
+                    break;
+                case StepKind::AnyKey:
+                    if (elt.getType() == MAP) { pushChildren(stack, elements, elt, state.stepIdx + 1); }
+                    break;
+                case StepKind::AnyIndex:
+                    if (elt.getType() == SEQUENCE) { pushChildren(stack, elements, elt, state.stepIdx + 1); }
+                    break;
+                case StepKind::Descendants:
+                    if (_descendantQty > 1) {  // Several '**' may reach the same node through different paths
+                        if (!visited.insert(((uint64_t)state.eltIdx << 32) | step.value).second) { break; }
+                    }
+                    if (state.stepIdx + 1 < _steps.size() && _steps[state.stepIdx + 1].kind == StepKind::Key) {
+                        // The next key is matched while listing the children, without hashing, and in document order
+                        if (elt.getType() == MAP || elt.getType() == SEQUENCE) {
+                            pushChildren(stack, elements, elt, state.stepIdx, &_steps[state.stepIdx + 1], node._context);
+                        }
+                        break;
+                    }
+                    // The children are processed after the node itself, which matches the next steps with zero level
+                    if (elt.getType() == MAP || elt.getType() == SEQUENCE) { pushChildren(stack, elements, elt, state.stepIdx); }
+                    stack.push_back({state.eltIdx, state.stepIdx + 1});
+                    break;
+            }
+        }
+    }
+
+    // Returns all the matching nodes
+    std::vector<Node> findAll(const Node& node) const
+    {
+        std::vector<Node> matches;
+        forEach(node, [&matches](Node match) { matches.push_back(std::move(match)); });
+        return matches;
+    }
+
+   private:
+    enum class StepKind { Key, Index, AnyKey, AnyIndex, Descendants };
+    struct Step {
+        StepKind kind;
+        uint32_t value;      // Sequence index, or ordinal of the '**' step
+        uint32_t hash;       // Precomputed hash of the key
+        uint32_t keyOffset;  // Key position in the unescaped keys
+        uint32_t keySize;
+    };
+    struct State {
+        uint32_t eltIdx;
+        uint32_t stepIdx;
+    };
+
+    void throwQueryError(const char* reason, size_t pos) const
+    {
+        throwMessage<AccessException>("Access error: %s in the query '%s' at position %zu", reason, _path.c_str(), pos);
+    }
+
+    // Pushes the map values or the sequence items, in reverse order so that they are popped in document order.
+    // If a key step is provided, the values of the matching keys also continue after this step, before their own descendants
+    void pushChildren(std::vector<State>& stack, const detail::Context::Elements& elements, const detail::Element& elt,
+                      uint32_t stepIdx, const Step* keyStep = nullptr, const detail::Context* context = nullptr) const
+    {
+        size_t firstIdx = stack.size();
+        elt.forEachSubBlock([&](const uint32_t* subs, uint32_t subQty) {
+            for (uint32_t i = 0; i < subQty; ++i) {
+                uint32_t childIdx = subs[i];
+                if (childIdx == detail::Element::Hole) { continue; }
+                const detail::Element& childElt = elements[childIdx];
+                if (childElt.getType() == KEY) {
+                    if (childElt.getKeyValue() == 0) { continue; }
+                    if (keyStep && childElt.getStringSize() == keyStep->keySize + 1 &&  // +1 due to zero termination
+                        memcmp(context->getString(childElt.getStringIdx()), _keys.data() + keyStep->keyOffset, keyStep->keySize) == 0) {
+                        stack.push_back({childElt.getKeyValue(), stepIdx + 2});
+                    }
+                    childIdx = childElt.getKeyValue();
+                }
+                NodeType childType = elements[childIdx].getType();
+                if (childType == COMMENT || (keyStep && childType != MAP && childType != SEQUENCE)) { continue; }  // No key inside
+                stack.push_back({childIdx, stepIdx});
+            }
+        });
+        std::reverse(stack.begin() + (ptrdiff_t)firstIdx, stack.end());
+    }
+
+    std::string       _path;
+    std::string       _keys;  // Unescaped literal keys
+    std::vector<Step> _steps;
+    uint32_t          _descendantQty = 0;
+};
+
+// ==========================================================================================
+// Built-in structural conversions
+// ==========================================================================================
+// Converters may work at the node level instead of the string level, by providing the functions:
+//   static void encodeNode(const T& typedValue, Node& node);  // Builds the node, for instance with 'node = SEQUENCE' and 'push_back'
+//   static void decodeNode(const Node& node, T& typedValue);   // Reads the node and its children
+// They are used instead of 'encode' and 'decode' by the assignments, the insertions and 'as<T>()'.
+
+namespace detail
+{
+
+// Empty sequences and maps are emitted as empty values, as StrictYAML has no flow style
+inline bool
+isEmptyValueNode(const Node& node)
+{
+    return node.isValue() && node.as<const char*>()[0] == 0;
+}
+
+inline void
+checkSequenceNode(const Node& node, size_t expectedSize, const char* typeName)
+{
+    if (!node.isSequence()) {
+        throwMessage<ConvertException>("Convert error: a sequence is expected to decode %s, not '%s'", typeName, node.to_string().c_str());
+    }
+    if (expectedSize != SIZE_MAX && node.size() != expectedSize) {
+        throwMessage<ConvertException>("Convert error: a sequence of %zu items is expected to decode %s, not '%s'", expectedSize, typeName,
+                                       node.to_string().c_str());
+    }
+}
+
+template<class Container>
+void
+encodeSequenceNode(const Container& container, Node& node)
+{
+    node = SEQUENCE;
+    node.reserve(container.size());
+    for (const auto& item : container) { node.push_back(item); }
+}
+
+template<class Key>
+std::string
+encodeKey(const Key& key)
+{
+    if constexpr (std::is_convertible<const Key&, std::string>::value) {
+        return std::string(key);
+    } else {
+        return convert<Key>::encode(key);
+    }
+}
+
+// The keys are indexed in one pass with a batch
+template<class MapType>
+void
+encodeMapNode(const MapType& container, Node& node)
+{
+    node = MAP;
+    node.reserve(container.size());
+    Node::Batch batch = node.beginBatch();
+    for (const auto& item : container) { batch.insert(encodeKey(item.first), item.second); }
+    batch.commit();
+}
+
+template<class MapType>
+void
+decodeMapNode(const Node& node, MapType& container, const char* typeName)
+{
+    using Key = typename MapType::key_type;
+    container.clear();
+    if (isEmptyValueNode(node)) { return; }
+    if (!node.isMap()) {
+        throwMessage<ConvertException>("Convert error: a map is expected to decode %s, not '%s'", typeName, node.to_string().c_str());
+    }
+    Node mapNode = node;
+    for (Node child : mapNode) {
+        if (!child.isKey()) { continue; }  // Comments
+        Key key;
+        if constexpr (std::is_same<Key, std::string>::value) {
+            key = child.keyName();
+        } else {
+            convert<Key>::decode(child.keyName().c_str(), key);
+        }
+        container.emplace(std::move(key), child.value().template as<typename MapType::mapped_type>());
+    }
+}
+
+}  // namespace detail
+
+template<class T, class Allocator>
+struct convert<std::vector<T, Allocator>> {
+    static void encodeNode(const std::vector<T, Allocator>& typedValue, Node& node) { detail::encodeSequenceNode(typedValue, node); }
+    static void decodeNode(const Node& node, std::vector<T, Allocator>& typedValue)
+    {
+        if (detail::isEmptyValueNode(node)) {
+            typedValue.clear();
+            return;
+        }
+        detail::checkSequenceNode(node, SIZE_MAX, "a std::vector");
+        typedValue.resize(node.size());
+        if constexpr (std::is_same<T, bool>::value) {  // No contiguous storage for std::vector<bool>
+            for (uint32_t i = 0; i < typedValue.size(); ++i) { typedValue[i] = node[i].template as<bool>(); }
+        } else {
+            node.copyTo(typedValue.data(), typedValue.size());
+        }
+    }
+};
+
+template<class T, std::size_t N>
+struct convert<std::array<T, N>> {
+    static void encodeNode(const std::array<T, N>& typedValue, Node& node) { detail::encodeSequenceNode(typedValue, node); }
+    static void decodeNode(const Node& node, std::array<T, N>& typedValue)
+    {
+        detail::checkSequenceNode(node, N, "a std::array");
+        node.copyTo(typedValue.data(), N);
+    }
+};
+
+template<class Key, class T, class Compare, class Allocator>
+struct convert<std::map<Key, T, Compare, Allocator>> {
+    static void encodeNode(const std::map<Key, T, Compare, Allocator>& typedValue, Node& node) { detail::encodeMapNode(typedValue, node); }
+    static void decodeNode(const Node& node, std::map<Key, T, Compare, Allocator>& typedValue)
+    {
+        detail::decodeMapNode(node, typedValue, "a std::map");
+    }
+};
+
+template<class Key, class T, class Hash, class KeyEqual, class Allocator>
+struct convert<std::unordered_map<Key, T, Hash, KeyEqual, Allocator>> {
+    static void encodeNode(const std::unordered_map<Key, T, Hash, KeyEqual, Allocator>& typedValue, Node& node)
+    {
+        detail::encodeMapNode(typedValue, node);
+    }
+    static void decodeNode(const Node& node, std::unordered_map<Key, T, Hash, KeyEqual, Allocator>& typedValue)
+    {
+        typedValue.reserve(node.isMap() ? node.size() : 0);
+        detail::decodeMapNode(node, typedValue, "a std::unordered_map");
+    }
+};
+
+// An empty value stands for the absence of value. So a present value whose encoding is empty (ex: an empty string) is decoded
+// as absent
+template<class T>
+struct convert<std::optional<T>> {
+    static void encodeNode(const std::optional<T>& typedValue, Node& node)
+    {
+        if (typedValue) {
+            node = *typedValue;
+        } else {
+            node = "";
+        }
+    }
+    static void decodeNode(const Node& node, std::optional<T>& typedValue)
+    {
+        if (detail::isEmptyValueNode(node)) {
+            typedValue.reset();
+        } else {
+            typedValue = node.template as<T>();
+        }
+    }
+};
+
+// Pairs and tuples are sequences of fixed size
+template<class T1, class T2>
+struct convert<std::pair<T1, T2>> {
+    static void encodeNode(const std::pair<T1, T2>& typedValue, Node& node)
+    {
+        node = SEQUENCE;
+        node.reserve(2);
+        node.push_back(typedValue.first);
+        node.push_back(typedValue.second);
+    }
+    static void decodeNode(const Node& node, std::pair<T1, T2>& typedValue)
+    {
+        detail::checkSequenceNode(node, 2, "a std::pair");
+        typedValue.first  = node[0].template as<T1>();
+        typedValue.second = node[1].template as<T2>();
+    }
+};
+
+template<class... Ts>
+struct convert<std::tuple<Ts...>> {
+    static void encodeNode(const std::tuple<Ts...>& typedValue, Node& node)
+    {
+        node = SEQUENCE;
+        node.reserve(sizeof...(Ts));
+        std::apply([&node](const auto&... items) { (node.push_back(items), ...); }, typedValue);
+    }
+    static void decodeNode(const Node& node, std::tuple<Ts...>& typedValue)
+    {
+        detail::checkSequenceNode(node, sizeof...(Ts), "a std::tuple");
+        decodeItems(node, typedValue, std::index_sequence_for<Ts...>{});
+    }
+
+   private:
+    template<std::size_t... Is>
+    static void decodeItems(const Node& node, std::tuple<Ts...>& typedValue, std::index_sequence<Is...>)
+    {
+        ((std::get<Is>(typedValue) = node[(uint32_t)Is].template as<Ts>()), ...);
+    }
+};
+
+// Binding of structures
+// =====================
+// STYML_BIND(MyStruct, field1, field2, ...) defines the converter of a structure as a map of its listed fields, with the field
+// names as keys. It shall be used in the global namespace. Up to 32 fields are supported.
+// The key hashes are computed once, and the child indexes of the previous decoded record are tried first, so that sequences of
+// maps with the same key layout are decoded without hashing. Missing keys leave the fields unchanged.
+
+namespace detail
+{
+
+template<class T, class M>
+struct BoundField {
+    Key key;
+    M T::*member;
+};
+
+template<class T, class M>
+BoundField<T, M>
+bindField(const char* name, M T::*member)
+{
+    return BoundField<T, M>{Key(name), member};
+}
+
+template<class T, class... Fields>
+void
+encodeBoundStruct(const T& typedValue, Node& node, const std::tuple<Fields...>& fields)
+{
+    node = MAP;
+    node.reserve(sizeof...(Fields));
+    Node::Batch batch = node.beginBatch();
+    std::apply([&](const auto&... field) { (batch.insert(field.key.name(), typedValue.*(field.member)), ...); }, fields);
+    batch.commit();
+}
+
+template<class T, class... Fields, std::size_t... Is>
+void
+decodeBoundFields(const Node& node, T& typedValue, const std::tuple<Fields...>& fields, std::index_sequence<Is...>)
+{
+    // Per structure type and per thread, as the sequences of records are usually decoded in a row
+    thread_local uint32_t childIndexHints[sizeof...(Fields)] = {};
+    (
+        [&](const auto& field, uint32_t& childIndexHint) {
+            Node child = node.find(field.key, childIndexHint);
+            if (child) { typedValue.*(field.member) = child.template as<std::remove_reference_t<decltype(typedValue.*(field.member))>>(); }
+        }(std::get<Is>(fields), childIndexHints[Is]),
+        ...);
+}
+
+template<class T, class... Fields>
+void
+decodeBoundStruct(const Node& node, T& typedValue, const std::tuple<Fields...>& fields)
+{
+    if (isEmptyValueNode(node)) { return; }
+    if (!node.isMap()) {
+        throwMessage<ConvertException>("Convert error: a map is expected to decode a bound structure, not '%s'", node.to_string().c_str());
+    }
+    decodeBoundFields(node, typedValue, fields, std::index_sequence_for<Fields...>{});
+}
+
+}  // namespace detail
+
+#define STYML_EXPAND_(x_) x_
+#define STYML_BIND_FIELD_(Type_, field_) styml::detail::bindField(#field_, &Type_::field_)
+#define STYML_BIND_1_(Type_, f_)       STYML_BIND_FIELD_(Type_, f_)
+#define STYML_BIND_2_(Type_, f_, ...)  STYML_BIND_FIELD_(Type_, f_), STYML_EXPAND_(STYML_BIND_1_(Type_, __VA_ARGS__))
+#define STYML_BIND_3_(Type_, f_, ...)  STYML_BIND_FIELD_(Type_, f_), STYML_EXPAND_(STYML_BIND_2_(Type_, __VA_ARGS__))
+#define STYML_BIND_4_(Type_, f_, ...)  STYML_BIND_FIELD_(Type_, f_), STYML_EXPAND_(STYML_BIND_3_(Type_, __VA_ARGS__))
+#define STYML_BIND_5_(Type_, f_, ...)  STYML_BIND_FIELD_(Type_, f_), STYML_EXPAND_(STYML_BIND_4_(Type_, __VA_ARGS__))
+#define STYML_BIND_6_(Type_, f_, ...)  STYML_BIND_FIELD_(Type_, f_), STYML_EXPAND_(STYML_BIND_5_(Type_, __VA_ARGS__))
+#define STYML_BIND_7_(Type_, f_, ...)  STYML_BIND_FIELD_(Type_, f_), STYML_EXPAND_(STYML_BIND_6_(Type_, __VA_ARGS__))
+#define STYML_BIND_8_(Type_, f_, ...)  STYML_BIND_FIELD_(Type_, f_), STYML_EXPAND_(STYML_BIND_7_(Type_, __VA_ARGS__))
+#define STYML_BIND_9_(Type_, f_, ...)  STYML_BIND_FIELD_(Type_, f_), STYML_EXPAND_(STYML_BIND_8_(Type_, __VA_ARGS__))
+#define STYML_BIND_10_(Type_, f_, ...) STYML_BIND_FIELD_(Type_, f_), STYML_EXPAND_(STYML_BIND_9_(Type_, __VA_ARGS__))
+#define STYML_BIND_11_(Type_, f_, ...) STYML_BIND_FIELD_(Type_, f_), STYML_EXPAND_(STYML_BIND_10_(Type_, __VA_ARGS__))
+#define STYML_BIND_12_(Type_, f_, ...) STYML_BIND_FIELD_(Type_, f_), STYML_EXPAND_(STYML_BIND_11_(Type_, __VA_ARGS__))
+#define STYML_BIND_13_(Type_, f_, ...) STYML_BIND_FIELD_(Type_, f_), STYML_EXPAND_(STYML_BIND_12_(Type_, __VA_ARGS__))
+#define STYML_BIND_14_(Type_, f_, ...) STYML_BIND_FIELD_(Type_, f_), STYML_EXPAND_(STYML_BIND_13_(Type_, __VA_ARGS__))
+#define STYML_BIND_15_(Type_, f_, ...) STYML_BIND_FIELD_(Type_, f_), STYML_EXPAND_(STYML_BIND_14_(Type_, __VA_ARGS__))
+#define STYML_BIND_16_(Type_, f_, ...) STYML_BIND_FIELD_(Type_, f_), STYML_EXPAND_(STYML_BIND_15_(Type_, __VA_ARGS__))
+#define STYML_BIND_17_(Type_, f_, ...) STYML_BIND_FIELD_(Type_, f_), STYML_EXPAND_(STYML_BIND_16_(Type_, __VA_ARGS__))
+#define STYML_BIND_18_(Type_, f_, ...) STYML_BIND_FIELD_(Type_, f_), STYML_EXPAND_(STYML_BIND_17_(Type_, __VA_ARGS__))
+#define STYML_BIND_19_(Type_, f_, ...) STYML_BIND_FIELD_(Type_, f_), STYML_EXPAND_(STYML_BIND_18_(Type_, __VA_ARGS__))
+#define STYML_BIND_20_(Type_, f_, ...) STYML_BIND_FIELD_(Type_, f_), STYML_EXPAND_(STYML_BIND_19_(Type_, __VA_ARGS__))
+#define STYML_BIND_21_(Type_, f_, ...) STYML_BIND_FIELD_(Type_, f_), STYML_EXPAND_(STYML_BIND_20_(Type_, __VA_ARGS__))
+#define STYML_BIND_22_(Type_, f_, ...) STYML_BIND_FIELD_(Type_, f_), STYML_EXPAND_(STYML_BIND_21_(Type_, __VA_ARGS__))
+#define STYML_BIND_23_(Type_, f_, ...) STYML_BIND_FIELD_(Type_, f_), STYML_EXPAND_(STYML_BIND_22_(Type_, __VA_ARGS__))
+#define STYML_BIND_24_(Type_, f_, ...) STYML_BIND_FIELD_(Type_, f_), STYML_EXPAND_(STYML_BIND_23_(Type_, __VA_ARGS__))
+#define STYML_BIND_25_(Type_, f_, ...) STYML_BIND_FIELD_(Type_, f_), STYML_EXPAND_(STYML_BIND_24_(Type_, __VA_ARGS__))
+#define STYML_BIND_26_(Type_, f_, ...) STYML_BIND_FIELD_(Type_, f_), STYML_EXPAND_(STYML_BIND_25_(Type_, __VA_ARGS__))
+#define STYML_BIND_27_(Type_, f_, ...) STYML_BIND_FIELD_(Type_, f_), STYML_EXPAND_(STYML_BIND_26_(Type_, __VA_ARGS__))
+#define STYML_BIND_28_(Type_, f_, ...) STYML_BIND_FIELD_(Type_, f_), STYML_EXPAND_(STYML_BIND_27_(Type_, __VA_ARGS__))
+#define STYML_BIND_29_(Type_, f_, ...) STYML_BIND_FIELD_(Type_, f_), STYML_EXPAND_(STYML_BIND_28_(Type_, __VA_ARGS__))
+#define STYML_BIND_30_(Type_, f_, ...) STYML_BIND_FIELD_(Type_, f_), STYML_EXPAND_(STYML_BIND_29_(Type_, __VA_ARGS__))
+#define STYML_BIND_31_(Type_, f_, ...) STYML_BIND_FIELD_(Type_, f_), STYML_EXPAND_(STYML_BIND_30_(Type_, __VA_ARGS__))
+#define STYML_BIND_32_(Type_, f_, ...) STYML_BIND_FIELD_(Type_, f_), STYML_EXPAND_(STYML_BIND_31_(Type_, __VA_ARGS__))
+#define STYML_BIND_SELECT_(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, _17, _18, _19, _20, _21, _22, \
+                           _23, _24, _25, _26, _27, _28, _29, _30, _31, _32, NAME_, ...)                                   \
+    NAME_
+#define STYML_BIND_FIELDS_(Type_, ...)                                                                                               \
+    STYML_EXPAND_(STYML_BIND_SELECT_(__VA_ARGS__,                                                                                    \
+                                     STYML_BIND_32_, STYML_BIND_31_, STYML_BIND_30_, STYML_BIND_29_, STYML_BIND_28_, STYML_BIND_27_, \
+                                     STYML_BIND_26_, STYML_BIND_25_, STYML_BIND_24_, STYML_BIND_23_, STYML_BIND_22_, STYML_BIND_21_, \
+                                     STYML_BIND_20_, STYML_BIND_19_, STYML_BIND_18_, STYML_BIND_17_, STYML_BIND_16_, STYML_BIND_15_, \
+                                     STYML_BIND_14_, STYML_BIND_13_, STYML_BIND_12_, STYML_BIND_11_, STYML_BIND_10_, STYML_BIND_9_,  \
+                                     STYML_BIND_8_, STYML_BIND_7_, STYML_BIND_6_, STYML_BIND_5_, STYML_BIND_4_, STYML_BIND_3_,       \
+                                     STYML_BIND_2_, STYML_BIND_1_)(Type_, __VA_ARGS__))
+
+#define STYML_BIND(Type_, ...)                                                                                                         \
+    namespace styml                                                                                                                    \
+    {                                                                                                                                  \
+    template<>                                                                                                                         \
+    struct convert<Type_> {                                                                                                            \
+        static const auto& fields()                                                                                                    \
+        {                                                                                                                              \
+            static const auto boundFields = std::make_tuple(STYML_BIND_FIELDS_(Type_, __VA_ARGS__));                                   \
+            return boundFields;                                                                                                        \
+        }                                                                                                                              \
+        static void encodeNode(const Type_& typedValue, Node& node) { detail::encodeBoundStruct(typedValue, node, fields()); }         \
+        static void decodeNode(const Node& node, Type_& typedValue) { detail::decodeBoundStruct(node, typedValue, fields()); }         \
+    };                                                                                                                                 \
+    }
+
+// ==========================================================================================
+// Parsing
+// ==========================================================================================
+
+namespace detail
+{
+
+enum class TokenType : uint16_t { Key, StringValue, Newline, Caret, Comment, Eos };
+
+struct TokenParser {
+    bool      isValid     = false;
+    TokenType type        = TokenType::Eos;
+    int       startColNbr = -1;
+    uint32_t  stringIdx   = 0;
+    uint32_t  stringSize  = 0;
+    explicit  operator bool() const { return isValid; }
+};
+
+// The string store is the document context, or any class with the same string session API
+template<class StringStore>
+TokenParser
+getToken(const char* text, uint32_t endIdx, int parentIndent, StringStore* context, StringHelper& sh, int& colNbr, int& lineNbr,
+         uint32_t& idx)
+{
+    bool isNewLine = (colNbr == 0);
+    int  initIdx   = idx;
+
+    // Go to first non space
+    uint32_t idxFnp = idx;
+    if (isNewLine) {
+        while (idxFnp < endIdx && text[idxFnp] == ' ') ++idxFnp;
+        if (idxFnp < endIdx && text[idxFnp] == '\t') {
+            throwParsing(lineNbr, text + idx, "Parse error: using tabulation is not accepted for indentation");
+        }
+    } else {
+        while (idxFnp < endIdx && (text[idxFnp] == ' ' || text[idxFnp] == '\t')) ++idxFnp;
+    }
+    colNbr += idxFnp - idx;
+    idx             = idxFnp;
+    int startColNbr = colNbr;
+
+    // Case end of input
+    if (idx >= endIdx) { return {true, TokenType::Eos, startColNbr, 0, 0}; }
+    char firstChar = text[idx];
+
+    // Case end of line
+    if (firstChar == '\n' || firstChar == '\r') {
+        if (idx + 1 < endIdx && firstChar == '\r' && text[idx + 1] == '\n') ++idx;
+        ++lineNbr;
+        colNbr = 0;
+        ++idx;
+        return {true, TokenType::Newline, startColNbr, 0, 0};
+    }
+
+    // Case "-" as first on the line (followed by space or equivalent)
+    if (firstChar == '-' && (idx + 1 == endIdx || text[idx + 1] == ' ' || text[idx + 1] == '\r' || text[idx + 1] == '\n')) {
+        ++colNbr;
+        ++idx;
+        return {true, TokenType::Caret, startColNbr, 0, 0};
+    }
+
+    // Case "#" (comment) @FIX should be preceded by space or equivalent
+    if (firstChar == '#') {
+        // Find the end of the line and return the comment. The newline will be handled in another call
+        uint32_t startIdx = idx + 1;
+        while (idx < endIdx && text[idx] != '\r' && text[idx] != '\n') {
+            ++idx;
+            ++colNbr;
+        }
+        uint32_t stringIdx = 0, stringSize = 0;
+        context->addString(text + startIdx, idx - startIdx, stringIdx, stringSize);
+        return {true, TokenType::Comment, startColNbr, stringIdx, stringSize};
+    }
+
+    sh.startSession();
+    // Find the type of string to deal with (YAML is creative on this point...)
+    char mlType       = ' ';
+    char chomp        = ' ';
+    int  deltaIndent  = -1;
+    int  targetIndent = -1;
+    if (firstChar == '\'' || firstChar == '"') {
+        mlType = firstChar;
+        ++idx;
+        ++colNbr;
+        targetIndent = 0;  // Termination is not indent-based but quote based
+        // Add the leading spaces
+        uint32_t nonSpaceIdx = idx;
+        while (nonSpaceIdx < endIdx && text[nonSpaceIdx] == ' ') {
+            ++nonSpaceIdx;
+            sh.addChar(' ');
+        }
+        colNbr += nonSpaceIdx - idx;
+    } else if (firstChar == '|' || firstChar == '>') {
+        mlType = firstChar;
+        ++idx;
+        ++colNbr;
+        // @TODO Add check for unwanted characters
+        for (int i = 0; i < 2; ++i) {  // Two passes as we shall extract 2 infos (chomp & indent) in any order
+            if (idx >= endIdx) { break; }
+            if (text[idx] == '+' || text[idx] == '-') {
+                if (chomp != ' ') throwParsing(lineNbr, text + initIdx, "Parse error: chomp cannot be provided more than once");
+                chomp = text[idx];
+                ++idx;
+                ++colNbr;
+            } else if (text[idx] >= '1' && text[idx] <= '9') {
+                if (deltaIndent >= 0)
+                    throwParsing(lineNbr, text + initIdx, "Parse error: explicit indentation cannot be provided more than once");
+                deltaIndent = text[idx] - '0';
+                ++idx;
+                ++colNbr;
+            }
+        }
+        // @TODO: Go to endline (and check that there is only blanks except comment (to skip)...) and generate errors
+        //        Current behavior is just ignoring the rest of the line, which allows things like "2+ +++2222++"
+        while (idx < endIdx && text[idx] != '\n' && text[idx] != '\r') { ++idx; }
+        if (idx + 1 < endIdx && text[idx] == '\r' && text[idx + 1] == '\n') { ++idx; }
+        ++idx;
+        ++lineNbr;
+        colNbr    = 0;
+        isNewLine = true;
+        if (deltaIndent >= 0) { targetIndent = parentIndent + deltaIndent; }
+    } else {
+        // For plain string, indent does not matter as text is stripped, only the parent indent matters
+        // We shall check however that it is indeed a child. Else the accept the current indent "as is"
+        targetIndent = (colNbr > parentIndent) ? parentIndent + 1 : colNbr;
+    }
+
+    bool isKey              = false;
+    bool indentedFoldedLine = false;
+
+    // Analyse the string line per line
+    while (idx < endIdx) {
+        // Find first non-space character
+        uint32_t nonSpaceIdx = idx;
+        while (nonSpaceIdx < endIdx && text[nonSpaceIdx] == ' ') ++nonSpaceIdx;
+        colNbr += nonSpaceIdx - idx;
+        if (isNewLine && nonSpaceIdx < endIdx && text[nonSpaceIdx] == '\t') {
+            throwParsing(lineNbr, text + initIdx, "Parse error: using tabulation is not accepted for indentation");
+        }
+        // Compute the expected indent (folded or literal strings case only)
+        int effectiveIndent = (uint32_t)(nonSpaceIdx - idx);
+        if (targetIndent < 0) {
+            // Initial empty line case
+            if (text[nonSpaceIdx] == '\n' || text[nonSpaceIdx] == '\r') {  // @BUG Need to handle comments too
+                if (sh.empty()) {
+                    sh.addLine("", 0);
+                } else {
+                    sh.addLine("\n", 1);
+                }
+                idx = nonSpaceIdx + ((nonSpaceIdx + 1 < endIdx && text[nonSpaceIdx] == '\r' && text[nonSpaceIdx + 1] == '\n') ? 2 : 1);
+                indentedFoldedLine = true;
+                ++lineNbr;
+                colNbr = 0;
+                continue;
+            }
+            // Set the expected indent
+            targetIndent = colNbr;
+        }
+
+        uint32_t lineEndIdx           = nonSpaceIdx;
+        bool     isEndOfStringReached = false;
+
+        // Single quote case: process one line. Focus on double single quote
+        if (mlType == '\'') {
+            bool isFirstAdd = !sh.empty();
+            ;
+            uint32_t chunkStartIdx = lineEndIdx;
+            while (lineEndIdx < endIdx && text[lineEndIdx] != '\n' && text[lineEndIdx] != '\r') {
+                // Easy non-single quote case
+                if (text[lineEndIdx] != '\'') {
+                    ++lineEndIdx;
+                    continue;
+                }
+                // Escaped (=double) single quote ?
+                if (lineEndIdx + 1 < endIdx && text[lineEndIdx + 1] == '\'') {
+                    if (isFirstAdd) {
+                        if (sh.arena.back() != '\n') { sh.addChar(' '); }
+                        isFirstAdd = false;
+                    }
+                    sh.addChunk(text + chunkStartIdx, lineEndIdx + 1 - chunkStartIdx);  // Keep one single quote
+                    lineEndIdx += 2;
+                    chunkStartIdx = lineEndIdx;
+                    continue;
+                }
+                isEndOfStringReached = true;
+                break;
+            }
+            if (isFirstAdd && sh.arena.back() != '\n') { sh.addChar(' '); }
+            if (lineEndIdx > chunkStartIdx) { sh.addChunk(text + chunkStartIdx, lineEndIdx - chunkStartIdx); }
+            if (lineEndIdx >= endIdx) { throwParsing(lineNbr, text + initIdx, "Parse error: unfinished single-quote string"); }
+            if (text[lineEndIdx] == '\'') {
+                isEndOfStringReached = true;
+                ++lineEndIdx;  // Skip double quote
+                while (text[lineEndIdx] == ' ' || text[lineEndIdx] == '\t') { ++lineEndIdx; }
+            }
+            if (!isEndOfStringReached && nonSpaceIdx == lineEndIdx) { sh.addLine("\n", 1); }
+        }  // End of single quote case
+
+        // Double quote case: process one line. Focus on backslash escape
         else if (mlType == '\"') {
             bool isFirstAdd = !sh.empty();
             ;
@@ -2177,436 +5779,1468 @@ getToken(const char* text, uint32_t endIdx, int parentIndent, Context* context,
                     ++lineEndIdx;
                     continue;
                 }
-                // Skip this backslash
-                if (isFirstAdd && sh.arena.back() != '\n') {
-                    sh.addChar(' ');
-                    isFirstAdd = false;
+                // Skip this backslash
+                if (isFirstAdd && sh.arena.back() != '\n') {
+                    sh.addChar(' ');
+                    isFirstAdd = false;
+                }
+                if (lineEndIdx > chunkStartIdx) { sh.addChunk(text + chunkStartIdx, lineEndIdx - chunkStartIdx); }
+                chunkStartIdx = ++lineEndIdx;
+                // Process next character
+                if (lineEndIdx < endIdx) {
+                    if (text[lineEndIdx] == 'n') {
+                        sh.addChar('\n');
+                    } else if (text[lineEndIdx] == 'r') {
+                        sh.addChar('\r');
+                    } else if (text[lineEndIdx] == 't') {
+                        sh.addChar('\t');
+                    } else if (text[lineEndIdx] == '"') {
+                        sh.addChar('"');
+                    } else if (text[lineEndIdx] == '\\') {
+                        sh.addChar('\\');
+                    } else if (text[lineEndIdx] == '\r' || text[lineEndIdx] == '\n') {
+                        // Case of escaping the end of line to join it with the next one
+                        if (text[lineEndIdx] == '\r') ++lineEndIdx;
+                        if (text[lineEndIdx] == '\n') ++lineEndIdx;
+                        // Skip next line spaces
+                        while (text[lineEndIdx] == ' ') ++lineEndIdx;
+                        --lineEndIdx;
+                    } else {  // Fallback @TODO Handle \x, \u and \U
+                        sh.addChar('\\');
+                        sh.addChar(text[lineEndIdx]);
+                    }
+                    chunkStartIdx = ++lineEndIdx;
+                }
+            }
+            if (isFirstAdd && sh.arena.back() != '\n') { sh.addChar(' '); }
+            if (lineEndIdx > chunkStartIdx) { sh.addChunk(text + chunkStartIdx, lineEndIdx - chunkStartIdx); }
+            if (lineEndIdx >= endIdx) throwParsing(lineNbr, text + initIdx, "Parse error: unfinished double-quote string");
+            if (text[lineEndIdx] == '\"') {
+                isEndOfStringReached = true;
+                ++lineEndIdx;  // Skip double quote
+                while (text[lineEndIdx] == ' ' || text[lineEndIdx] == '\t') { ++lineEndIdx; }
+            }
+            if (!isEndOfStringReached && nonSpaceIdx == lineEndIdx) { sh.addLine("\n", 1); }
+        }  // End of double quote case
+
+        // Literal
+        else if (mlType == '|') {
+            uint32_t rollbackLineEndIdx = lineEndIdx;
+            while (lineEndIdx < endIdx && text[lineEndIdx] != '\n' && text[lineEndIdx] != '\r') { ++lineEndIdx; }
+            if (lineEndIdx != nonSpaceIdx && colNbr < targetIndent) {
+                isEndOfStringReached = true;
+                lineEndIdx           = rollbackLineEndIdx;
+            } else {
+                if (!sh.empty()) { sh.addChar('\n'); }
+                if (lineEndIdx >= idx + targetIndent) { sh.addChunk(text + idx + targetIndent, lineEndIdx - (idx + targetIndent)); }
+            }
+        }
+
+        // Folded
+        else if (mlType == '>') {
+            uint32_t rollbackLineEndIdx = lineEndIdx;
+            while (lineEndIdx < endIdx && text[lineEndIdx] != '\n' && text[lineEndIdx] != '\r') { ++lineEndIdx; }
+            if (lineEndIdx != nonSpaceIdx && colNbr < targetIndent) {
+                isEndOfStringReached = true;
+                lineEndIdx           = rollbackLineEndIdx;
+            } else {
+                // Indentation behavior
+                bool isIndented = (lineEndIdx <= idx + targetIndent || (!sh.empty() && text[idx + targetIndent] == ' '));
+                if (isIndented || indentedFoldedLine) {
+                    sh.addChar('\n');
+                } else if (lineEndIdx > idx + targetIndent && !sh.empty() && sh.arena.back() != '\n') {
+                    sh.addChar(' ');
+                }
+
+                indentedFoldedLine = (lineEndIdx > idx + targetIndent && text[idx + targetIndent] == ' ');
+                if (lineEndIdx > idx + targetIndent) { sh.addChunk(text + idx + targetIndent, lineEndIdx - (idx + targetIndent)); }
+            }
+        }
+
+        // Plain string
+        else {
+            uint32_t rollbackLineEndIdx = lineEndIdx;
+            while (lineEndIdx < endIdx && text[lineEndIdx] != '\n' && text[lineEndIdx] != '\r' &&
+                   (text[lineEndIdx] != '#' || lineEndIdx == idx || text[lineEndIdx - 1] != ' ') &&
+                   (text[lineEndIdx] != ':' || (lineEndIdx + 1 != endIdx && text[lineEndIdx + 1] != ' ' && text[lineEndIdx + 1] != '\n' &&
+                                                text[lineEndIdx + 1] != '\r'))) {
+                ++lineEndIdx;
+            }
+            isEndOfStringReached = (lineEndIdx < endIdx && text[lineEndIdx] != '\n' && text[lineEndIdx] != '\r');
+            if (lineEndIdx != nonSpaceIdx && colNbr < targetIndent) {
+                isEndOfStringReached = true;
+                lineEndIdx           = rollbackLineEndIdx;
+            } else {
+                if (!sh.empty() && sh.arena.back() != '\n') { sh.addChar(' '); }
+                sh.addChunkNoTrail(text + idx + effectiveIndent, lineEndIdx - (idx + effectiveIndent));
+            }
+            if (!isEndOfStringReached && nonSpaceIdx == lineEndIdx) { sh.addLine("\n", 1); }
+        }
+
+        // Finalize the line
+        uint32_t nextLineStartIdx =
+            lineEndIdx + ((lineEndIdx + 1 < endIdx && text[lineEndIdx] == '\r' && text[lineEndIdx + 1] == '\n') ? 2 : 1);
+        sh.endLine();
+
+        if (isEndOfStringReached && text[lineEndIdx] == ':' &&
+            (lineEndIdx + 1 == endIdx || text[lineEndIdx + 1] == ' ' || text[lineEndIdx + 1] == '\n' || text[lineEndIdx + 1] == '\r')) {
+            isKey = true;
+            ++lineEndIdx;  // Skip colon
+        }
+
+        // Next line
+        if (isEndOfStringReached) {
+            idx = lineEndIdx;
+            colNbr += (int)(lineEndIdx - nonSpaceIdx);
+            break;
+        }
+
+        idx    = nextLineStartIdx;
+        colNbr = 0;
+        ++lineNbr;
+
+        if (idx >= endIdx && !isEndOfStringReached) {
+            if (mlType == '"') { throwParsing(lineNbr, text + initIdx, "Parse error: unfinished double-quote string"); }
+            if (mlType == '\'') { throwParsing(lineNbr, text + initIdx, "Parse error: unfinished single-quote string"); }
+        }
+    }  // End of text line parsing
+
+    // Apply the chomp
+    if (mlType != '\'' && mlType != '"' && (chomp == '-' || chomp == ' ')) { sh.removeTrailingLines(); }
+
+    // Build the final string from the different lines
+    context->startStringSession();
+    for (StringHelper::LineChunk& lc : sh.chunks) { context->addToSession(sh.arena.data() + lc.startIdx, lc.size); }
+    if ((mlType == '|' || mlType == '>') && (chomp == ' ' || chomp == '+')) { context->addToSession("\n", 1); }
+
+    // Store
+    uint32_t stringIdx = 0, stringSize = 0;
+    context->commitSession(stringIdx, stringSize);
+    return {true, isKey ? TokenType::Key : TokenType::StringValue, startColNbr, stringIdx, stringSize};
+}
+
+// Builds the elements of a document from the parsed structure.
+// The builders identify the nodes with their own ids, and the parsing stack only refers to the nodes in it or to their parent
+class TreeBuilder
+{
+   public:
+    // Prefix of the conversion error messages, reported as parsing errors
+    static constexpr const char* ConvertErrorPrefix = "Decode error: ";
+
+    explicit TreeBuilder(Context* context) : _context(context), _elements(context->elements)
+    {
+        _elements.emplace_back(KEY);                   // Root is a KEY type, index 0  @TEST Check when root's child is directly modified
+        _context->addString("", 0, 0);  // Empty key name for root
+    }
+
+    // The parsed node becomes the value of the provided root key, which has no value yet
+    TreeBuilder(Context* context, uint32_t rootEltIdx) : _context(context), _elements(context->elements), _rootEltIdx(rootEltIdx)
+    {
+        assert(_elements[rootEltIdx].getType() == KEY && _elements[rootEltIdx].getSubQty() == 0);
+    }
+
+    Context* getStringStore() { return _context; }
+    uint32_t getRootId() const { return _rootEltIdx; }
+    NodeType getType(uint32_t id) const { return _elements[id].getType(); }
+    bool     hasValue(uint32_t id) const { return _elements[id].getSubQty() > 0; }
+    void     reset(uint32_t id, NodeType type) { _elements[id].reset(type); }
+
+    uint32_t addChild(uint32_t parentId, NodeType type)
+    {
+        uint32_t eltIdx = (uint32_t)_elements.size();
+        _elements.emplace_back(type);
+        _elements[parentId].add(eltIdx);
+        return eltIdx;
+    }
+
+    // Returns UINT_MAX if the key is already present
+    uint32_t addKey(uint32_t parentId, const TokenParser& token)
+    {
+        uint32_t eltIdx = (uint32_t)_elements.size();
+        _elements.emplace_back(KEY, token.stringIdx, token.stringSize);
+        _elements[parentId].add(eltIdx);
+        if (!_context->addMapChildIndex(parentId, _context->getString(token.stringIdx), token.stringSize - 1, &_elements[parentId],
+                                        _elements[parentId].getSubQty() - 1)) {
+            return UINT_MAX;
+        }
+        return eltIdx;
+    }
+
+    // Types the untyped node as a value
+    void setValue(uint32_t id, const TokenParser& token)
+    {
+        _elements[id].reset(VALUE);
+        _elements[id].setString(token.stringIdx, token.stringSize);
+    }
+
+    void addValue(uint32_t parentId, const TokenParser& token)
+    {
+        uint32_t eltIdx = (uint32_t)_elements.size();
+        _elements.emplace_back(VALUE, token.stringIdx, token.stringSize);
+        _elements[parentId].add(eltIdx);
+    }
+
+    void finish() {}
+
+    void addComment(uint32_t parentId, const TokenParser& token, bool isStandalone)
+    {
+        uint32_t eltIdx = (uint32_t)_elements.size();
+        _elements.emplace_back(COMMENT, token.stringIdx, token.stringSize);
+        if (isStandalone) { _elements.back().setStandalone(); }
+        if (_elements[parentId].getType() != UNKNOWN) {
+            uint32_t tmpIdx = 0;
+            while ((tmpIdx = _elements[parentId].getNextCommentIndex()) != 0) { parentId = tmpIdx; }
+            _elements[parentId].setComment(eltIdx);
+        }
+    }
+
+   private:
+    Context*              _context;
+    Context::Elements& _elements;
+    uint32_t              _rootEltIdx = 0;
+};
+
+// Working memory of the parsing, which can be kept between parsings to limit memory allocation
+struct ParseScratch {
+    struct ParseItem {
+        ParseItem() {}
+        ParseItem(uint32_t eltIdx, int indent, int childIndent) : eltIdx(eltIdx), indent(indent), childIndent(childIndent) {}
+        uint32_t eltIdx      = 0;
+        int      indent      = 0;
+        int      childIndent = -1;
+    };
+    StringHelper           sh;  // Utility for string parsing
+    std::vector<ParseItem> stack;
+};
+
+// Drives the builder with the structure of the text
+template<class Builder>
+void
+parseStructure(const char* text, uint32_t textSize, Builder& builder, ParseScratch& scratch)
+{
+    //#define DEBUG_PARSING
+#ifdef DEBUG_PARSING
+#define dbgPrintf(...) printf(__VA_ARGS__)
+    const char* tokenName[6] = {"KEY", "STRINGVALUE", "NEWLINE", "CARET", "COMMENT", "EOS"};
+#else
+#define dbgPrintf(...) \
+    do {               \
+    } while (0)
+#endif
+
+    using ParseItem = ParseScratch::ParseItem;
+    auto*         context      = builder.getStringStore();
+    uint32_t      startIdx     = 0;
+    int           lineNbr      = 1;
+    bool          isEndOfInput = false;
+    StringHelper& sh           = scratch.sh;
+
+    // Parse context: the stack, the parent (often equal to stack.back()), the parent indent,
+    std::vector<ParseItem>& stack = scratch.stack;
+    stack.clear();
+    stack.push_back({builder.getRootId(), -1, -1});
+    ParseItem parent               = stack.back();
+    int       mlStringParentIndent = -1;
+    int       indexColNbr          = 0;
+    int       tokenLineNbr         = 1;
+    int       tokenIdx             = 0;
+    int       lastTokenLineNbr     = 1;
+    int       lastTokenIdx         = 0;
+
+    while (!isEndOfInput && !stack.empty()) {
+#ifdef DEBUG_PARSING
+        dbgPrintf("line %d) STACK:\n", lineNbr);
+        for (const auto s : stack) {
+            dbgPrintf("   * %9s  parent indent %2d / %2d  . prev indent %2d\n", to_string(builder.getType(s.eltIdx)), s.indent,
+                      s.childIndent, mlStringParentIndent);
+        }
+#endif
+
+        // Get the next token
+        bool        isStartingWithNewLine = (indexColNbr == 0);
+        TokenParser token = getToken(text, textSize, mlStringParentIndent, context, sh, indexColNbr, lineNbr, startIdx);
+        dbgPrintf("  GetToken: %s baseIndent=%2d  newline=%d  String: [%s]\n", tokenName[(int)token.type], mlStringParentIndent,
+                  isStartingWithNewLine, token.stringSize ? context->getString(token.stringIdx) : "");
+
+        // The conversion errors of the direct decoding are reported with the parsing location
+        try {
+            switch (token.type) {
+                case TokenType::Comment: {
+                    uint32_t parentCommentEltIdx = parent.eltIdx;
+                    if (builder.getType(parentCommentEltIdx) == UNKNOWN && stack.size() >= 2) {
+                        parentCommentEltIdx =
+                            stack[stack.size() - 2].eltIdx;  // If the last is unknown, then the for-last must be a key or sequence
+                    }
+                    builder.addComment(parentCommentEltIdx, token, isStartingWithNewLine);
+                } break;
+
+                case TokenType::Caret: {
+                    mlStringParentIndent = token.startColNbr;
+                    const int colNbr     = token.startColNbr;
+
+                    // Pop stack until caret has the same or higher indent than the parent
+                    while (
+                        !stack.empty() &&
+                        (builder.getType(parent.eltIdx) != KEY || colNbr != parent.indent) &&  // Case a caret just below a key ("a:\n- b")
+                        (builder.getType(parent.eltIdx) != UNKNOWN || stack.size() < 2 ||
+                         builder.getType(stack[stack.size() - 2].eltIdx) != KEY ||
+                         colNbr != stack[stack.size() - 2].indent) &&  // Case a caret just below a key ("a:\n- b")
+                        colNbr <= parent.indent &&
+                        (parent.childIndent < 0 || colNbr < parent.childIndent)) {
+                        stack.pop_back();
+                        parent = stack.back();
+                    }
+
+                    // Checks
+                    if (stack.empty()) {
+                        throwParsing(tokenLineNbr, text + tokenIdx,
+                                     "Parse error: the indentation of the caret (=%d) does not match any parent (=%d)", colNbr,
+                                     parent.childIndent);  // Reachable state?
+                    }
+                    if (parent.childIndent >= 0 && colNbr != parent.childIndent) {
+                        throwParsing(tokenLineNbr, text + tokenIdx,
+                                     "Parse error: the indentation of the caret (=%d) is not aligned with other child elements (=%d)",
+                                     colNbr, parent.childIndent);
+                    }
+
+                    // Insert a sequence if the parent isn't one
+                    if (builder.getType(parent.eltIdx) != SEQUENCE) {
+                        NodeType parentType = builder.getType(parent.eltIdx);
+                        if (parentType == UNKNOWN) {
+                            builder.reset(parent.eltIdx, SEQUENCE);
+                            stack.back().indent      = colNbr;
+                            stack.back().childIndent = colNbr;
+                            parent                   = stack.back();
+                            if (stack[stack.size() - 2].childIndent < 0) stack[stack.size() - 2].childIndent = colNbr;
+                        } else {
+                            assert(parentType != VALUE);
+                            if (parentType == KEY && builder.hasValue(parent.eltIdx)) {
+                                throwParsing(tokenLineNbr, text + tokenIdx,
+                                             "Parse error: probably bad indentation with caret, as the parent ('%s') already has a value",
+                                             to_string(KEY));  // Reachable state?
+                            }
+                            stack.emplace_back(builder.addChild(parent.eltIdx, SEQUENCE), colNbr, colNbr);
+                            parent = stack.back();
+                        }
+                    }
+
+                    // Create the next node, untyped. This is required to handle the case of empty values in sequences.
+                    assert(builder.getType(parent.eltIdx) == SEQUENCE);
+                    stack.emplace_back(builder.addChild(parent.eltIdx, UNKNOWN), colNbr, -1);
+                    parent = stack.back();
+
+                } break;
+
+                case TokenType::Key: {
+                    mlStringParentIndent = token.startColNbr;
+                    const int colNbr     = token.startColNbr;
+
+                    // Pop stack until the key indent matches the parent's
+                    while (!stack.empty() && colNbr <= parent.indent) {
+                        stack.pop_back();
+                        parent = stack.back();
+                    }
+
+                    // Checks
+                    if (stack.empty()) {
+                        throwParsing(tokenLineNbr, text + tokenIdx,
+                                     "Parse error: the indentation of the key (=%d) does not match any parent (=%d)", colNbr,
+                                     parent.childIndent);  // Reachable state?
+                    }
+                    if (parent.childIndent >= 0 && colNbr < parent.childIndent) {
+                        throwParsing(tokenLineNbr, text + tokenIdx,
+                                     "Parse error: the indentation of the key (=%d) is not aligned with other child elements (=%d)", colNbr,
+                                     parent.childIndent);
+                    }
+                    if (parent.childIndent < 0) {
+                        stack.back().childIndent = colNbr;
+                        parent                   = stack.back();
+                    }
+
+                    // Insert a map if the parent isn't one
+                    // This is required due to the idiomatic syntax "- a:" which implies a 'map' between the caret and the "a:"
+                    if (builder.getType(parent.eltIdx) != MAP) {
+                        NodeType parentType = builder.getType(parent.eltIdx);
+                        if (parentType == UNKNOWN) {
+                            builder.reset(parent.eltIdx, MAP);
+                        } else {
+                            assert(parentType != VALUE);
+                            if (parentType == KEY && builder.hasValue(parent.eltIdx)) {
+                                throwParsing(tokenLineNbr, text + tokenIdx,
+                                             "Parse error: probably bad indentation, as the parent ('%s') already has a value",
+                                             to_string(parentType));
+                            }
+                            stack.emplace_back(builder.addChild(parent.eltIdx, MAP), parent.indent, -1);
+                            parent = stack.back();
+                        }
+                    }
+
+                    // Add key
+                    if (parent.childIndent < 0) { stack.back().childIndent = colNbr; }
+                    assert(builder.getType(parent.eltIdx) != KEY || !builder.hasValue(parent.eltIdx));
+                    uint32_t eltIdx = builder.addKey(parent.eltIdx, token);
+                    if (eltIdx == UINT_MAX) {
+                        throwParsing(tokenLineNbr, text + tokenIdx,
+                                     "Parse error: duplicated key are forbidden and the key '%s' is already present.",
+                                     context->getString(token.stringIdx));
+                    }
+                    stack.emplace_back(eltIdx, colNbr, -1);
+                    parent = stack.back();
+
+                    // Create the next node, untyped. This is required to handle the case of empty values in sequences.
+                    assert(builder.getType(parent.eltIdx) == KEY);
+                    stack.emplace_back(builder.addChild(parent.eltIdx, UNKNOWN), colNbr, -1);
+                    parent = stack.back();
+                } break;
+
+                case TokenType::StringValue: {
+                    const int colNbr = token.startColNbr;
+
+                    // Checks
+                    if (colNbr <= parent.indent) {
+                        throwParsing(tokenLineNbr, text + tokenIdx,
+                                     "Parse error: the indentation of the value (=%d) is not compatible with the parent indentation (=%d)",
+                                     colNbr, parent.indent);
+                    }
+                    if (parent.childIndent >= 0 && colNbr < parent.childIndent) {
+                        throwParsing(tokenLineNbr, text + tokenIdx,
+                                     "Parse error: the indentation of the value (=%d) is not aligned with other child elements (=%d)",
+                                     colNbr, parent.childIndent);
+                    }
+                    if (builder.getType(parent.eltIdx) == MAP) {
+                        throwParsing(tokenLineNbr, text + tokenIdx, "Parse error: in a map, a value without a key is forbidden");
+                    }
+                    if (parent.childIndent < 0) {
+                        stack.back().childIndent = colNbr;
+                        parent                   = stack.back();
+                    }
+
+                    // Create the string value, either by typing an untyped node or creating a new one
+                    if (builder.getType(parent.eltIdx) == UNKNOWN) {
+                        builder.setValue(parent.eltIdx, token);
+                        stack.pop_back();
+                        parent = stack.back();  // Now the parent is the upper container
+                    } else {
+                        // Container or not a key already with value
+                        assert(builder.getType(parent.eltIdx) != KEY || !builder.hasValue(parent.eltIdx));
+                        builder.addValue(parent.eltIdx, token);
+                    }
+
+                    // If the parent is a key, pop it from the stack (container with only 1 child). The root key ends the parsing
+                    if (builder.getType(parent.eltIdx) == KEY) {
+                        stack.pop_back();
+                        if (!stack.empty()) { parent = stack.back(); }
+                    }
+                } break;
+
+                case TokenType::Newline:
+                    mlStringParentIndent = parent.indent;
+                    indexColNbr          = 0;
+                    break;
+
+                case TokenType::Eos:
+                    isEndOfInput = true;
+                    break;
+
+                default:
+                    assert(false && "Bug");
+            };
+        } catch (ConvertException& e) {
+            throwParsing(tokenLineNbr, text + tokenIdx, "%s%s", Builder::ConvertErrorPrefix, e.what());
+        }
+
+        if (token.type == TokenType::Key || token.type == TokenType::StringValue || token.type == TokenType::Caret) {
+            lastTokenLineNbr = tokenLineNbr;
+            lastTokenIdx     = tokenIdx;
+        }
+        tokenLineNbr = lineNbr;
+        tokenIdx     = startIdx;
+    }  // End of input
+
+    // The last checks of the builder are located on the last token
+    try {
+        builder.finish();
+    } catch (ConvertException& e) {
+        throwParsing(lastTokenLineNbr, text + lastTokenIdx, "%s%s", Builder::ConvertErrorPrefix, e.what());
+    }
+}
+
+}  // namespace detail
+
+inline Document
+parse(const char* text, uint32_t textSize)
+{
+    // To prevent memory leaks when parsing encounters an error:
+    // - unique_ptr is used to hold the root node, which recursively owns all nodes, and the global context
+    // - no exception shall be thrown between an Element creation and its addition into the tree
+    std::unique_ptr<detail::Context> context(new detail::Context(textSize));
+    detail::TreeBuilder              builder(context.get());
+    detail::ParseScratch             scratch;
+    detail::parseStructure(text, textSize, builder, scratch);
+    return Document(context.release());
+}
+
+inline Document
+parse(const char* text)
+{
+    return parse(text, (uint32_t)strlen(text));
+}
+
+inline Document
+parse(const std::string& text)
+{
+    return parse(text.data(), (uint32_t)text.size());
+}
+
+inline uint32_t
+Node::parseFragment(const char* text, uint32_t textSize) const
+{
+    // A failed parsing leaves only orphan elements, which are not reachable from the tree
+    uint32_t rootEltIdx = (uint32_t)_context->elements.size();
+    _context->elements.emplace_back(KEY);
+    detail::TreeBuilder  builder(_context, rootEltIdx);
+    detail::ParseScratch scratch;
+    detail::parseStructure(text, textSize, builder, scratch);
+    return _context->elements[rootEltIdx].getKeyValue();
+}
+
+inline void
+Node::parseInto(const char* text, uint32_t textSize)
+{
+    assert(_context && _eltIdx < (uint32_t)_context->elements.size());
+    if (_context->elements[_eltIdx].getType() == MAP && !_nonExistingKey.empty()) {
+        if (_context->getMapChildIndex(_eltIdx, _nonExistingKey.data(), (uint32_t)_nonExistingKey.size(), &_context->elements[_eltIdx]) !=
+            UINT_MAX) {
+            throwMessage<AccessException>("Access error: the key '%s' has already been added in the map", _nonExistingKey.c_str());
+        }
+    }
+
+    replaceWith(parseFragment(text, textSize));
+}
+
+inline void
+Node::cloneInto(Node& target) const
+{
+    if (!*this) { throwMessage<AccessException>("Access error: 'cloneInto(...)' cannot be used on an invalid node"); }
+    if (!target._context || target._eltIdx >= (uint32_t)target._context->elements.size()) {
+        throwMessage<AccessException>("Access error: 'cloneInto(...)' cannot be used with an invalid target node");
+    }
+    uint32_t srcEltIdx = _eltIdx;
+    if (getElement(srcEltIdx).getType() == KEY) {
+        srcEltIdx = getElement(srcEltIdx).getKeyValue();
+        if (srcEltIdx == 0) {  // Root key of an empty document
+            target.replaceWith(0);
+            return;
+        }
+    }
+    // The copy is done before any change of the target, which can be inside this sub-tree
+    target.replaceWith(target._context->cloneSubTree(*_context, srcEltIdx));
+}
+
+inline void
+Document::merge(const Node& overlay, MergePolicy policy)
+{
+    if (!overlay) { throwMessage<AccessException>("Access error: 'merge(...)' cannot be used with an invalid overlay node"); }
+    uint32_t overlayEltIdx = overlay._eltIdx;
+    if (overlay.getElement(overlayEltIdx).getType() == KEY) {
+        overlayEltIdx = overlay.getElement(overlayEltIdx).getKeyValue();
+        if (overlayEltIdx == 0) { return; }  // Empty overlay document
+    }
+    if (getElement(_eltIdx).getType() == KEY) {  // Empty document
+        overlay.cloneInto(*this);
+        return;
+    }
+    if (overlay._context == _context) {  // The overlay is copied first, as the merge modifies the trees it walks
+        Document copy;
+        overlay.cloneInto(copy);
+        merge(copy, policy);
+        return;
+    }
+    _context->mergeSubTree(_eltIdx, *overlay._context, overlayEltIdx, policy == MergePolicy::AppendSequences);
+}
+
+inline Node
+Node::graft(const std::string& key, const Node& src)
+{
+    src.cloneInto((*this)[key]);
+    return (*this)[key];
+}
+
+inline Node
+Node::graft(const std::string& key, Document&& src)
+{
+    if (src._context == _context) { throwMessage<AccessException>("Access error: a document cannot be grafted into itself"); }
+    Node target = (*this)[key];  // Checks the key before any change
+    if (src.getElement(0).getType() == KEY && src.getElement(0).getKeyValue() == 0) {
+        target.replaceWith(0);  // Empty document
+    } else {
+        target.replaceWith(_context->adoptContext(*src._context));
+    }
+    src = Document();
+    return (*this)[key];
+}
+
+inline void
+Node::replaceWith(uint32_t newEltIdx)
+{
+    // Get the target element, by creating the missing key or by following the key
+    uint32_t targetEltIdx = _eltIdx;
+    if (_context->elements[_eltIdx].getType() == MAP && !_nonExistingKey.empty()) {
+        *this                         = SEQUENCE;  // Creates the key with a placeholder value
+        const detail::Element& mapElt = _context->elements[_eltIdx];
+        targetEltIdx                  = _context->elements[mapElt.getSub(mapElt.getSubQty() - 1)].getKeyValue();
+    } else if (_context->elements[_eltIdx].getType() == KEY) {
+        targetEltIdx = _context->elements[_eltIdx].getKeyValue();
+        if (targetEltIdx == 0) {
+            // Root key of an empty document: the new node becomes its value, as in a parsed document
+            if (newEltIdx != 0) {
+                _context->elements[_eltIdx].add(newEltIdx);
+                _eltIdx = newEltIdx;
+            }
+            return;
+        }
+    }
+
+    _context->replaceElement(targetEltIdx, newEltIdx);
+}
+
+inline void
+Node::appendParsed(const char* text, uint32_t textSize)
+{
+    assert(_context && _eltIdx < (uint32_t)_context->elements.size());
+    NodeType type = _context->elements[_eltIdx].getType();
+    if ((type != SEQUENCE && type != MAP) || !_nonExistingKey.empty()) {
+        throwMessage<AccessException>("Access error: 'appendParsed(...)' can only be used on SEQUENCE and MAP elements, not '%s'",
+                                      to_string().c_str());
+    }
+
+    uint32_t parsedEltIdx = parseFragment(text, textSize);
+    if (parsedEltIdx == 0) { return; }  // Nothing to append
+    detail::Context::Elements& elements  = _context->elements;
+    detail::Element&           parsedElt = elements[parsedEltIdx];
+
+    if (type == SEQUENCE) {
+        detail::Element& elt = elements[_eltIdx];
+        if (parsedElt.getType() != SEQUENCE) {
+            elt.add(parsedEltIdx);
+            return;
+        }
+        parsedElt.forEachSubBlock([&elt](const uint32_t* subs, uint32_t subQty) { elt.insertRange(elt.getSubQty(), subs, subQty); });
+        parsedElt.reset(UNKNOWN);
+        return;
+    }
+
+    // Map: the duplicated keys are checked before any change
+    if (parsedElt.getType() != MAP) {
+        throwMessage<AccessException>("Access error: 'appendParsed(...)' on a map requires a parsed map, not '%s'",
+                                      Node(parsedEltIdx, _context).to_string().c_str());
+    }
+    for (uint32_t i = 0; i < parsedElt.getSubQty(); ++i) {
+        const detail::Element& keyElt = elements[parsedElt.getSub(i)];
+        if (keyElt.getType() != KEY) { continue; }
+        if (_context->getMapChildIndex(_eltIdx, _context->getString(keyElt.getStringIdx()), keyElt.getStringSize() - 1,
+                                       &elements[_eltIdx]) != UINT_MAX) {
+            throwMessage<AccessException>("Access error: duplicated key are forbidden and the key '%s' is already present",
+                                          _context->getString(keyElt.getStringIdx()));
+        }
+    }
+    _context->indexMapChildren(parsedEltIdx, false);
+    detail::Element& elt = elements[_eltIdx];
+    for (uint32_t i = 0; i < parsedElt.getSubQty(); ++i) {
+        uint32_t childEltIdx = parsedElt.getSub(i);
+        elt.add(childEltIdx);
+        const detail::Element& childElt = elements[childEltIdx];
+        if (childElt.getType() == KEY) {
+            _context->addMapChildIndex(_eltIdx, _context->getString(childElt.getStringIdx()), childElt.getStringSize() - 1, &elt,
+                                       elt.getSubQty() - 1);
+        }
+    }
+    parsedElt.reset(UNKNOWN);
+}
+
+// ==========================================================================================
+// Schema validation
+// ==========================================================================================
+// A schema describes the expected structure of a document. It is checked while parsing, so that an invalid document is
+// rejected at the offending line, without a second traversal of the tree.
+
+namespace detail
+{
+class SchemaBuilder;
+}  // namespace detail
+
+class Schema
+{
+    struct Item;
+
+   public:
+    // Key of a map schema. Keys are required unless created with 'Schema::optional'
+    struct Field {
+        Field(std::string name, const Schema& schema, bool isRequired = true);
+        std::string                 name;
+        std::shared_ptr<const Item> item;
+        bool                        isRequired;
+    };
+
+    // Scalars. The numbers and booleans follow the rules of 'as<T>()'
+    static Schema any() { return Schema(Kind::Any); }  // Any sub-tree
+    static Schema string() { return Schema(Kind::String); }
+    static Schema integer() { return Schema(Kind::Integer); }
+    static Schema floating() { return Schema(Kind::Float); }
+    static Schema boolean() { return Schema(Kind::Bool); }
+    static Schema enumeration(std::initializer_list<std::string> values)
+    {
+        Schema schema(Kind::Enum);
+        schema._item->values = values;
+        return schema;
+    }
+    // String accepted by the predicate. The description names the expected strings in the error messages (ex: "an identifier")
+    static Schema check(std::function<bool(std::string_view)> predicate, std::string description = "a valid string")
+    {
+        Schema schema(Kind::Check);
+        schema._item->values    = {std::move(description)};
+        schema._item->predicate = std::move(predicate);
+        return schema;
+    }
+
+    // Containers. Empty values are accepted as empty containers
+    static Schema seq(const Schema& itemSchema)
+    {
+        Schema schema(Kind::Seq);
+        schema._item->child = itemSchema._item;
+        return schema;
+    }
+    static Schema map(std::initializer_list<Field> fields)  // Fixed keys, the other keys are rejected
+    {
+        Schema schema(Kind::Map);
+        for (const Field& field : fields) {
+            for (const auto& other : schema._item->fields) {
+                if (other.name == field.name) {
+                    throwMessage<AccessException>("Schema error: the key '%s' is duplicated", field.name.c_str());
+                }
+            }
+            schema._item->fields.push_back(field);
+        }
+        return schema;
+    }
+    static Schema mapOf(const Schema& valueSchema)  // Any key
+    {
+        Schema schema(Kind::Map);
+        schema._item->child = valueSchema._item;
+        return schema;
+    }
+    static Field optional(std::string name, const Schema& schema) { return Field(std::move(name), schema, false); }
+
+   private:
+    friend class detail::SchemaBuilder;
+
+    enum class Kind { Any, String, Integer, Float, Bool, Enum, Check, Seq, Map };
+
+    struct Item {
+        explicit Item(Kind kind) : kind(kind) {}
+        Kind                                  kind;
+        std::vector<std::string>              values;  // Accepted values of an enumeration, or the description of a check
+        std::function<bool(std::string_view)> predicate;
+        std::shared_ptr<const Item>           child;   // Schema of the sequence items, or of the values of a map with any key
+        std::vector<Field>                    fields;
+    };
+
+    explicit Schema(Kind kind) : _item(std::make_shared<Item>(kind)) {}
+
+    std::shared_ptr<Item> _item;
+};
+
+inline Schema::Field::Field(std::string name, const Schema& schema, bool isRequired)
+    : name(std::move(name)), item(schema._item), isRequired(isRequired)
+{
+}
+
+namespace detail
+{
+
+// Builds the document like the TreeBuilder, and checks each node against its schema when it is typed.
+// The checks which need the full node (required keys, empty values) are done when the node cannot receive children anymore,
+// which is detected with the element indexes: all nodes created after the parent of the current event are complete
+class SchemaBuilder : public TreeBuilder
+{
+   public:
+    static constexpr const char* ConvertErrorPrefix = "";  // The schema messages have their own prefix
+
+    SchemaBuilder(Context* context, const Schema& schema, bool withTypedValues)
+        : TreeBuilder(context), _context(context), _withTypedValues(withTypedValues)
+    {
+        _frames.push_back({0, schema._item.get(), 0, 0});
+    }
+
+    void reset(uint32_t id, NodeType type)
+    {
+        completeNodesAfter(id);
+        TreeBuilder::reset(id, type);
+        startContainer(_frames.back(), type);
+    }
+
+    uint32_t addChild(uint32_t parentId, NodeType type)
+    {
+        completeNodesAfter(parentId);
+        const Item* item   = getChildItem(_frames.back());
+        uint32_t    eltIdx = TreeBuilder::addChild(parentId, type);
+        _frames.push_back({eltIdx, item, 0, 0});
+        if (type != UNKNOWN) { startContainer(_frames.back(), type); }
+        return eltIdx;
+    }
+
+    uint32_t addKey(uint32_t parentId, const TokenParser& token)
+    {
+        completeNodesAfter(parentId);
+        Frame&      map   = _frames.back();
+        const Item* item  = map.item;
+        const char* key   = _context->getString(token.stringIdx);
+        uint32_t    keyId = UINT_MAX;
+        if (item->kind == Schema::Kind::Map && item->child) {
+            item = item->child.get();
+        } else if (item->kind == Schema::Kind::Map) {
+            // Fields are searched from the next expected one, as the keys are usually in the same order as in the schema
+            uint32_t fieldQty = (uint32_t)item->fields.size();
+            for (uint32_t i = 0; i < fieldQty && keyId == UINT_MAX; ++i) {
+                uint32_t           idx  = (map.nextFieldIdx + i) % fieldQty;
+                const std::string& name = item->fields[idx].name;
+                if (name.size() == token.stringSize - 1 && memcmp(name.data(), key, name.size()) == 0) { keyId = idx; }
+            }
+            if (keyId == UINT_MAX) { throwMessage<ConvertException>("Schema error: the key '%s' is not expected in this map", key); }
+            map.nextFieldIdx = keyId + 1;
+            item             = item->fields[keyId].item.get();
+        }
+
+        uint32_t eltIdx = TreeBuilder::addKey(parentId, token);
+        if (eltIdx == UINT_MAX) { return eltIdx; }  // Duplicated key, reported by the parser
+        if (keyId != UINT_MAX) { _seenWords[_frames.back().seenOffset + keyId / 64] |= (1ULL << (keyId % 64)); }
+        _frames.push_back({eltIdx, item, 0, 0});
+        return eltIdx;
+    }
+
+    void setValue(uint32_t id, const TokenParser& token)
+    {
+        completeNodesAfter(id);
+        checkValue(_frames.back().item, _context->getString(token.stringIdx), token.stringSize - 1);
+        TreeBuilder::setValue(id, token);
+        storeTypedValue(_frames.back().item, id);
+    }
+
+    void addValue(uint32_t parentId, const TokenParser& token)
+    {
+        completeNodesAfter(parentId);
+        const Item* item = getChildItem(_frames.back());
+        checkValue(item, _context->getString(token.stringIdx), token.stringSize - 1);
+        uint32_t eltIdx = (uint32_t)_context->elements.size();
+        TreeBuilder::addValue(parentId, token);
+        storeTypedValue(item, eltIdx);
+    }
+
+    void finish()
+    {
+        while (!_frames.empty()) { completeLastNode(); }
+    }
+
+   private:
+    using Item = Schema::Item;
+
+    struct Frame {
+        uint32_t    eltIdx;
+        const Item* item;          // Schema of the node, or of the value for a key
+        uint32_t    seenOffset;    // Maps: position of the bitset of the present keys in '_seenWords'
+        uint32_t    nextFieldIdx;  // Maps: next expected field
+    };
+
+    const Item* getChildItem(const Frame& frame) const
+    {
+        if (_context->elements[frame.eltIdx].getType() != SEQUENCE) { return frame.item; }  // Child of a key
+        return (frame.item->kind == Schema::Kind::Any) ? frame.item : frame.item->child.get();
+    }
+
+    void completeNodesAfter(uint32_t eltIdx)
+    {
+        while (_frames.back().eltIdx > eltIdx) { completeLastNode(); }
+        assert(_frames.back().eltIdx == eltIdx);
+    }
+
+    void startContainer(Frame& frame, NodeType type)
+    {
+        Schema::Kind kind = frame.item->kind;
+        if (kind == Schema::Kind::Any) { return; }
+        if ((type == SEQUENCE && kind != Schema::Kind::Seq) || (type == MAP && kind != Schema::Kind::Map)) {
+            throwMessage<ConvertException>("Schema error: %s is expected, not a %s", getKindName(frame.item),
+                                           (type == MAP) ? "map" : "sequence");
+        }
+        if (type == MAP) {
+            frame.seenOffset = (uint32_t)_seenWords.size();
+            _seenWords.resize(_seenWords.size() + (frame.item->fields.size() + 63) / 64, 0);
+        }
+    }
+
+    void completeLastNode()
+    {
+        const Frame& frame = _frames.back();
+        NodeType     type  = _context->elements[frame.eltIdx].getType();
+        if (type == UNKNOWN || (type == KEY && _context->elements[frame.eltIdx].getSubQty() == 0)) {
+            checkValue(frame.item, "", 0);  // Empty value
+        } else if (type == MAP && frame.item->kind == Schema::Kind::Map) {
+            const std::vector<Schema::Field>& fields = frame.item->fields;
+            for (uint32_t i = 0; i < (uint32_t)fields.size(); ++i) {
+                if (fields[i].isRequired && (_seenWords[frame.seenOffset + i / 64] & (1ULL << (i % 64))) == 0) {
+                    throwMessage<ConvertException>("Schema error: the required key '%s' is missing%s", fields[i].name.c_str(),
+                                                   getMapLocation().c_str());
                 }
-                if (lineEndIdx > chunkStartIdx) { sh.addChunk(text + chunkStartIdx, lineEndIdx - chunkStartIdx); }
-                chunkStartIdx = ++lineEndIdx;
-                // Process next character
-                if (lineEndIdx < endIdx) {
-                    if (text[lineEndIdx] == 'n') {
-                        sh.addChar('\n');
-                    } else if (text[lineEndIdx] == 'r') {
-                        sh.addChar('\r');
-                    } else if (text[lineEndIdx] == 't') {
-                        sh.addChar('\t');
-                    } else if (text[lineEndIdx] == '"') {
-                        sh.addChar('"');
-                    } else if (text[lineEndIdx] == '\\') {
-                        sh.addChar('\\');
-                    } else if (text[lineEndIdx] == '\r' || text[lineEndIdx] == '\n') {
-                        // Case of escaping the end of line to join it with the next one
-                        if (text[lineEndIdx] == '\r') ++lineEndIdx;
-                        if (text[lineEndIdx] == '\n') ++lineEndIdx;
-                        // Skip next line spaces
-                        while (text[lineEndIdx] == ' ') ++lineEndIdx;
-                        --lineEndIdx;
-                    } else {  // Fallback @TODO Handle \x, \u and \U
-                        sh.addChar('\\');
-                        sh.addChar(text[lineEndIdx]);
+            }
+            _seenWords.resize(frame.seenOffset);
+        }
+        _frames.pop_back();
+    }
+
+    // Name of the key of the last map, for the error messages
+    std::string getMapLocation() const
+    {
+        if (_frames.size() < 2) { return ""; }
+        const Element& parent = _context->elements[_frames[_frames.size() - 2].eltIdx];
+        if (parent.getType() != KEY || _frames[_frames.size() - 2].eltIdx == 0) { return ""; }
+        return std::string(" in the map of '") + _context->getString(parent.getStringIdx()) + "'";
+    }
+
+    static const char* getKindName(const Item* item)
+    {
+        if (item->kind == Schema::Kind::Check) { return item->values[0].c_str(); }
+        constexpr const char* names[] = {"any node",  "a string",   "an integer", "a floating point", "a boolean", "an enumeration",
+                                         "a string", "a sequence", "a map"};
+        return names[(int)item->kind];
+    }
+
+    static void checkValue(const Item* item, const char* strValue, uint32_t strSize)
+    {
+        bool isValid = true;
+        switch (item->kind) {
+            case Schema::Kind::Any:
+            case Schema::Kind::String:
+                break;
+            case Schema::Kind::Seq:
+            case Schema::Kind::Map:
+                isValid = (strSize == 0);  // Empty container
+                if (isValid && item->kind == Schema::Kind::Map) {
+                    for (const auto& field : item->fields) {
+                        if (field.isRequired) {
+                            throwMessage<ConvertException>("Schema error: the required key '%s' is missing, as the map is empty",
+                                                           field.name.c_str());
+                        }
                     }
-                    chunkStartIdx = ++lineEndIdx;
                 }
+                break;
+            case Schema::Kind::Integer: {
+                uint64_t magnitude  = 0;
+                bool     isNegative = false;
+                isValid             = (parseInteger(strValue, strSize, magnitude, isNegative) == DecodeStatus::Ok);
+            } break;
+            case Schema::Kind::Float: {
+                double number = 0.;
+                isValid       = (decodeFloat(strValue, strSize, number) == DecodeStatus::Ok);
+            } break;
+            case Schema::Kind::Bool: {
+                bool flag = false;
+                isValid   = (decodeBool(strValue, strSize, flag) == DecodeStatus::Ok);
+            } break;
+            case Schema::Kind::Enum:
+                isValid = (std::find(item->values.begin(), item->values.end(), std::string_view(strValue, strSize)) != item->values.end());
+                break;
+            case Schema::Kind::Check:
+                isValid = item->predicate(std::string_view(strValue, strSize));
+                break;
+        }
+        if (!isValid) {
+            if (item->kind == Schema::Kind::Enum) {
+                std::string values;
+                for (const std::string& value : item->values) { values += (values.empty() ? "'" : ", '") + value + "'"; }
+                throwMessage<ConvertException>("Schema error: one of %s is expected, not '%s'", values.c_str(), strValue);
             }
-            if (isFirstAdd && sh.arena.back() != '\n') { sh.addChar(' '); }
-            if (lineEndIdx > chunkStartIdx) { sh.addChunk(text + chunkStartIdx, lineEndIdx - chunkStartIdx); }
-            if (lineEndIdx >= endIdx) throwParsing(lineNbr, text + initIdx, "Parse error: unfinished double-quote string");
-            if (text[lineEndIdx] == '\"') {
-                isEndOfStringReached = true;
-                ++lineEndIdx;  // Skip double quote
-                while (text[lineEndIdx] == ' ' || text[lineEndIdx] == '\t') { ++lineEndIdx; }
-            }
-            if (!isEndOfStringReached && nonSpaceIdx == lineEndIdx) { sh.addLine("\n", 1); }
-        }  // End of double quote case
+            throwMessage<ConvertException>("Schema error: %s is expected, not '%s'", getKindName(item), strValue);
+        }
+    }
+
+    // The validated numbers are decoded in the typed value cache, so that their access is a load
+    void storeTypedValue(const Item* item, uint32_t eltIdx)
+    {
+        if (!_withTypedValues) { return; }
+        if (item->kind == Schema::Kind::Integer) {
+            int64_t number = 0;
+            _context->getTypedValue(eltIdx, number);  // Cached even if out of range for the probed type
+        } else if (item->kind == Schema::Kind::Float) {
+            double number = 0.;
+            _context->getTypedValue(eltIdx, number);
+        }
+    }
+
+    Context*              _context;
+    bool                  _withTypedValues;
+    std::vector<Frame>    _frames;
+    std::vector<uint64_t> _seenWords;  // Bitsets of the present keys of the maps in the frames
+};
+
+}  // namespace detail
+
+// Parses and validates the text against the schema. A ParseException is thrown at the first line not matching the schema.
+// If 'withTypedValues' is true, the typed value cache is enabled and filled with the validated integers and floating points
+inline Document
+parse(const char* text, uint32_t textSize, const Schema& schema, bool withTypedValues = false)
+{
+    std::unique_ptr<detail::Context> context(new detail::Context(textSize));
+    if (withTypedValues) { context->enableTypedValueCache(true); }
+    detail::SchemaBuilder builder(context.get(), schema, withTypedValues);
+    detail::ParseScratch  scratch;
+    detail::parseStructure(text, textSize, builder, scratch);
+    return Document(context.release());
+}
+
+inline Document
+parse(const char* text, const Schema& schema, bool withTypedValues = false)
+{
+    return parse(text, (uint32_t)strlen(text), schema, withTypedValues);
+}
+
+inline Document
+parse(const std::string& text, const Schema& schema, bool withTypedValues = false)
+{
+    return parse(text.data(), (uint32_t)text.size(), schema, withTypedValues);
+}
+
+// ==========================================================================================
+// Direct decoding
+// ==========================================================================================
+// The parsed structure is decoded on the fly into the C++ object, without building any document. The parsing events are
+// dispatched to static tables of decoding functions, one per decoded type.
+
+namespace detail
+{
+
+struct DecodeTarget;
+
+// An object being decoded, and the functions to decode it
+struct DecodeSlot {
+    const DecodeTarget* target = nullptr;
+    void*               object = nullptr;
+};
+
+struct DecodeTarget {
+    const char* (*typeName)();
+    void (*start)(void* object);                                             // The object becomes a sequence or a map
+    void (*onValue)(void* object, const char* strValue, uint32_t strSize);  // The string is zero terminated
+    DecodeSlot (*onItem)(void* object, uint32_t idx);                        // nullptr if the object cannot be a sequence
+    // nullptr if the object cannot be a map. The state is initially zero for each map. A null target means a duplicated key
+    DecodeSlot (*onKey)(void* object, const char* key, uint32_t keySize, uint64_t& state);
+};
+
+template<class T, class Enable = void>
+struct hasBoundFields : std::false_type {};
+template<class T>
+struct hasBoundFields<T, std::void_t<decltype(convert<T>::fields())>> : std::true_type {};
+
+template<class T, class Enable = void>
+struct hasStringDecode : std::false_type {};
+template<class T>
+struct hasStringDecode<T, std::void_t<decltype(convert<T>::decode(std::declval<const char*>(), std::declval<T&>()))>> : std::true_type {};
+
+template<class T>
+const char*
+getTypeName()
+{
+    return typeid(T).name();
+}
+
+inline void
+checkEmptyValue(const char* strValue, const char* expectedKind)
+{
+    if (strValue[0] != 0) { throwMessage<ConvertException>("Convert error: %s is expected, not the value '%s'", expectedKind, strValue); }
+}
+
+inline void
+ignoreStart(void*)
+{
+}
+
+// Built-in values and the types with a string converter
+template<class T, class Enable = void>
+struct DirectDecoder {
+    static_assert(hasStringDecode<T>::value, "Only the types with a string converter or a binding can be decoded directly");
 
-        // Literal
-        else if (mlType == '|') {
-            uint32_t rollbackLineEndIdx = lineEndIdx;
-            while (lineEndIdx < endIdx && text[lineEndIdx] != '\n' && text[lineEndIdx] != '\r') { ++lineEndIdx; }
-            if (lineEndIdx != nonSpaceIdx && colNbr < targetIndent) {
-                isEndOfStringReached = true;
-                lineEndIdx           = rollbackLineEndIdx;
-            } else {
-                if (!sh.empty()) { sh.addChar('\n'); }
-                if (lineEndIdx >= idx + targetIndent) { sh.addChunk(text + idx + targetIndent, lineEndIdx - (idx + targetIndent)); }
-            }
+    static void onValue(void* object, const char* strValue, uint32_t strSize)
+    {
+        T& typedValue = *static_cast<T*>(object);
+        if constexpr (std::is_arithmetic<T>::value) {
+            if (STYML_LIKELY(decodeNumber(strValue, strSize, typedValue) == DecodeStatus::Ok)) { return; }
         }
+        convert<T>::decode(strValue, typedValue);
+    }
 
-        // Folded
-        else if (mlType == '>') {
-            uint32_t rollbackLineEndIdx = lineEndIdx;
-            while (lineEndIdx < endIdx && text[lineEndIdx] != '\n' && text[lineEndIdx] != '\r') { ++lineEndIdx; }
-            if (lineEndIdx != nonSpaceIdx && colNbr < targetIndent) {
-                isEndOfStringReached = true;
-                lineEndIdx           = rollbackLineEndIdx;
-            } else {
-                // Indentation behavior
-                bool isIndented = (lineEndIdx <= idx + targetIndent || (!sh.empty() && text[idx + targetIndent] == ' '));
-                if (isIndented || indentedFoldedLine) {
-                    sh.addChar('\n');
-                } else if (lineEndIdx > idx + targetIndent && !sh.empty() && sh.arena.back() != '\n') {
-                    sh.addChar(' ');
-                }
+    static constexpr DecodeTarget target = {&getTypeName<T>, &ignoreStart, &onValue, nullptr, nullptr};
+};
 
-                indentedFoldedLine = (lineEndIdx > idx + targetIndent && text[idx + targetIndent] == ' ');
-                if (lineEndIdx > idx + targetIndent) { sh.addChunk(text + idx + targetIndent, lineEndIdx - (idx + targetIndent)); }
-            }
-        }
+// Unknown keys of bound structures
+struct SkipDecoder {
+    static void       onValue(void*, const char*, uint32_t) {}
+    static DecodeSlot onItem(void*, uint32_t) { return {&target, nullptr}; }
+    static DecodeSlot onKey(void*, const char*, uint32_t, uint64_t&) { return {&target, nullptr}; }
 
-        // Plain string
-        else {
-            uint32_t rollbackLineEndIdx = lineEndIdx;
-            while (lineEndIdx < endIdx && text[lineEndIdx] != '\n' && text[lineEndIdx] != '\r' &&
-                   (text[lineEndIdx] != '#' || lineEndIdx == idx || text[lineEndIdx - 1] != ' ') &&
-                   (text[lineEndIdx] != ':' || (lineEndIdx + 1 != endIdx && text[lineEndIdx + 1] != ' ' && text[lineEndIdx + 1] != '\n' &&
-                                                text[lineEndIdx + 1] != '\r'))) {
-                ++lineEndIdx;
-            }
-            isEndOfStringReached = (lineEndIdx < endIdx && text[lineEndIdx] != '\n' && text[lineEndIdx] != '\r');
-            if (lineEndIdx != nonSpaceIdx && colNbr < targetIndent) {
-                isEndOfStringReached = true;
-                lineEndIdx           = rollbackLineEndIdx;
-            } else {
-                if (!sh.empty() && sh.arena.back() != '\n') { sh.addChar(' '); }
-                sh.addChunkNoTrail(text + idx + effectiveIndent, lineEndIdx - (idx + effectiveIndent));
-            }
-            if (!isEndOfStringReached && nonSpaceIdx == lineEndIdx) { sh.addLine("\n", 1); }
-        }
+    static constexpr DecodeTarget target = {&getTypeName<void>, &ignoreStart, &onValue, &onItem, &onKey};
+};
 
-        // Finalize the line
-        uint32_t nextLineStartIdx =
-            lineEndIdx + ((lineEndIdx + 1 < endIdx && text[lineEndIdx] == '\r' && text[lineEndIdx + 1] == '\n') ? 2 : 1);
-        sh.endLine();
+// The fields are matched by name, starting with the one following the previous match: no hashing is involved, and records with
+// the keys in the field order match at the first comparison
+template<class T>
+struct DirectDecoder<T, std::enable_if_t<hasBoundFields<T>::value>> {
+    using Fields                    = std::decay_t<decltype(convert<T>::fields())>;
+    static constexpr size_t FieldQty = std::tuple_size<Fields>::value;
+    static_assert(FieldQty <= 32, "The duplicated key detection supports up to 32 fields");
 
-        if (isEndOfStringReached && text[lineEndIdx] == ':' &&
-            (lineEndIdx + 1 == endIdx || text[lineEndIdx + 1] == ' ' || text[lineEndIdx + 1] == '\n' || text[lineEndIdx + 1] == '\r')) {
-            isKey = true;
-            ++lineEndIdx;  // Skip colon
-        }
+    static void onValue(void*, const char* strValue, uint32_t) { checkEmptyValue(strValue, "a map"); }
 
-        // Next line
-        if (isEndOfStringReached) {
-            idx = lineEndIdx;
-            colNbr += (int)(lineEndIdx - nonSpaceIdx);
-            break;
+    // The state contains the mask of the decoded fields in the low part, and the index of the next expected field in the high part
+    static DecodeSlot onKey(void* object, const char* key, uint32_t keySize, uint64_t& state)
+    {
+        static const std::array<std::string_view, FieldQty> names = getNames(std::make_index_sequence<FieldQty>{});
+        uint32_t fieldIdx = (uint32_t)(state >> 32);
+        for (uint32_t i = 0; i < FieldQty; ++i, fieldIdx = (fieldIdx + 1 == FieldQty) ? 0 : fieldIdx + 1) {
+            if (names[fieldIdx].size() != keySize || memcmp(names[fieldIdx].data(), key, keySize) != 0) { continue; }
+            if (state & (1ULL << fieldIdx)) { return {}; }  // Duplicated
+            state = (state & 0xFFFFFFFFULL) | (1ULL << fieldIdx) | ((uint64_t)(fieldIdx + 1) << 32);
+            return getField(object, fieldIdx, std::make_index_sequence<FieldQty>{});
         }
+        return {&SkipDecoder::target, nullptr};
+    }
 
-        idx    = nextLineStartIdx;
-        colNbr = 0;
-        ++lineNbr;
+    template<std::size_t... Is>
+    static std::array<std::string_view, FieldQty> getNames(std::index_sequence<Is...>)
+    {
+        return {std::get<Is>(convert<T>::fields()).key.name()...};
+    }
 
-        if (idx >= endIdx && !isEndOfStringReached) {
-            if (mlType == '"') { throwParsing(lineNbr, text + initIdx, "Parse error: unfinished double-quote string"); }
-            if (mlType == '\'') { throwParsing(lineNbr, text + initIdx, "Parse error: unfinished single-quote string"); }
-        }
-    }  // End of text line parsing
+    template<std::size_t I>
+    static DecodeSlot getField(void* object)
+    {
+        auto& member = static_cast<T*>(object)->*(std::get<I>(convert<T>::fields()).member);
+        return {&DirectDecoder<std::remove_reference_t<decltype(member)>>::target, &member};
+    }
 
-    // Apply the chomp
-    if (mlType != '\'' && mlType != '"' && (chomp == '-' || chomp == ' ')) { sh.removeTrailingLines(); }
+    template<std::size_t... Is>
+    static DecodeSlot getField(void* object, uint32_t fieldIdx, std::index_sequence<Is...>)
+    {
+        static constexpr DecodeSlot (*getters[])(void*) = {&getField<Is>...};
+        return getters[fieldIdx](object);
+    }
 
-    // Build the final string from the different lines
-    context->startStringSession();
-    for (StringHelper::LineChunk& lc : sh.chunks) { context->addToSession(sh.arena.data() + lc.startIdx, lc.size); }
-    if ((mlType == '|' || mlType == '>') && (chomp == ' ' || chomp == '+')) { context->addToSession("\n", 1); }
+    static constexpr DecodeTarget target = {&getTypeName<T>, &ignoreStart, &onValue, nullptr, &onKey};
+};
 
-    // Store
-    uint32_t stringIdx = 0, stringSize = 0;
-    context->commitSession(stringIdx, stringSize);
-    return {true, isKey ? TokenType::Key : TokenType::StringValue, startColNbr, stringIdx, stringSize};
-}
+template<class T, class Allocator>
+struct DirectDecoder<std::vector<T, Allocator>> {
+    static_assert(!std::is_same<T, bool>::value, "std::vector<bool> cannot be decoded directly, as its items are not addressable");
+    using Vector = std::vector<T, Allocator>;
 
-}  // namespace detail
+    static void start(void* object) { static_cast<Vector*>(object)->clear(); }
+    static void onValue(void* object, const char* strValue, uint32_t)
+    {
+        checkEmptyValue(strValue, "a sequence");
+        static_cast<Vector*>(object)->clear();
+    }
+    // The previous items are complete, so the reallocation of the vector is safe
+    static DecodeSlot onItem(void* object, uint32_t)
+    {
+        Vector& vector = *static_cast<Vector*>(object);
+        vector.emplace_back();
+        return {&DirectDecoder<T>::target, &vector.back()};
+    }
 
-inline Document
-parse(const char* text, uint32_t textSize)
-{
-    //#define DEBUG_PARSING
-#ifdef DEBUG_PARSING
-#define dbgPrintf(...) printf(__VA_ARGS__)
-    const char* tokenName[6] = {"KEY", "STRINGVALUE", "NEWLINE", "CARET", "COMMENT", "EOS"};
-#else
-#define dbgPrintf(...) \
-    do {               \
-    } while (0)
-#endif
+    static constexpr DecodeTarget target = {&getTypeName<Vector>, &start, &onValue, &onItem, nullptr};
+};
 
-    using namespace detail;
-    uint32_t     startIdx     = 0;
-    int          lineNbr      = 1;
-    bool         isEndOfInput = false;
-    StringHelper sh;  // Utility for string parsing, to limit memory allocation
+template<class T, std::size_t N>
+struct DirectDecoder<std::array<T, N>> {
+    static void onValue(void*, const char* strValue, uint32_t) { checkEmptyValue(strValue, "a sequence"); }
+    static DecodeSlot onItem(void* object, uint32_t idx)
+    {
+        if (idx >= N) { throwMessage<ConvertException>("Convert error: a sequence of %zu items is expected to decode a std::array", N); }
+        return {&DirectDecoder<T>::target, &(*static_cast<std::array<T, N>*>(object))[idx]};
+    }
 
-    struct ParseItem {
-        ParseItem() {}
-        ParseItem(uint32_t eltIdx, int indent, int childIndent) : eltIdx(eltIdx), indent(indent), childIndent(childIndent) {}
-        uint32_t eltIdx      = 0;
-        int      indent      = 0;
-        int      childIndent = -1;
-    };
+    static constexpr DecodeTarget target = {&getTypeName<std::array<T, N>>, &ignoreStart, &onValue, &onItem, nullptr};
+};
 
-    // To prevent memory leaks when parsing encounters an error:
-    // - unique_ptr is used to hold the root node, which recursively owns all nodes, and the global context
-    // - no exception shall be thrown between an Element creation and its addition into the tree
-    std::unique_ptr<Context> context(new Context(textSize));
-    std::vector<Element>&    elements = context->elements;
+template<class MapType>
+struct DirectMapDecoder {
+    using Key = typename MapType::key_type;
+
+    static void start(void* object) { static_cast<MapType*>(object)->clear(); }
+    static void onValue(void* object, const char* strValue, uint32_t)
+    {
+        checkEmptyValue(strValue, "a map");
+        static_cast<MapType*>(object)->clear();
+    }
+    // The map nodes are stable, so the value stays valid while the next keys are inserted
+    static DecodeSlot onKey(void* object, const char* key, uint32_t keySize, uint64_t&)
+    {
+        Key typedKey;
+        if constexpr (std::is_same<Key, std::string>::value) {
+            typedKey.assign(key, keySize);
+        } else {
+            convert<Key>::decode(key, typedKey);
+        }
+        auto [it, isInserted] = static_cast<MapType*>(object)->try_emplace(std::move(typedKey));
+        if (!isInserted) { return {}; }  // Duplicated
+        return {&DirectDecoder<typename MapType::mapped_type>::target, &it->second};
+    }
 
-    elements.emplace_back(KEY);                   // Root is a KEY type, index 0  @TEST Check when root's child is directly modified
-    context->addString("", 0, &elements.back());  // Empty key name for root
+    static constexpr DecodeTarget target = {&getTypeName<MapType>, &start, &onValue, nullptr, &onKey};
+};
 
-    // Parse context: the stack, the parent (often equal to stack.back()), the parent indent,
-    std::vector<ParseItem> stack{{0, -1, -1}};
-    ParseItem              parent               = stack.back();
-    int                    mlStringParentIndent = -1;
-    int                    indexColNbr          = 0;
-    int                    tokenLineNbr         = 1;
-    int                    tokenIdx             = 0;
+template<class Key, class T, class Compare, class Allocator>
+struct DirectDecoder<std::map<Key, T, Compare, Allocator>> : DirectMapDecoder<std::map<Key, T, Compare, Allocator>> {};
 
-    while (!isEndOfInput && !stack.empty()) {
-#ifdef DEBUG_PARSING
-        dbgPrintf("line %d) STACK:\n", lineNbr);
-        for (const auto s : stack) {
-            dbgPrintf("   * %9s  parent indent %2d / %2d  . prev indent %2d", to_string(elements[s.eltIdx].getType()), s.indent,
-                      s.childIndent, mlStringParentIndent);
-            if (elements[s.eltIdx].getType() == NodeType::KEY) dbgPrintf(" [%s]", context->getString(elements[s.eltIdx].getStringIdx()));
-            dbgPrintf("\n");
+template<class Key, class T, class Hash, class KeyEqual, class Allocator>
+struct DirectDecoder<std::unordered_map<Key, T, Hash, KeyEqual, Allocator>>
+    : DirectMapDecoder<std::unordered_map<Key, T, Hash, KeyEqual, Allocator>> {};
+
+// An empty value stands for the absence of value. So a present value whose encoding is empty (ex: an empty string) is decoded
+// as absent
+template<class T>
+struct DirectDecoder<std::optional<T>> {
+    using Inner = DirectDecoder<T>;
+
+    static T* getValue(void* object)
+    {
+        std::optional<T>& typedValue = *static_cast<std::optional<T>*>(object);
+        if (!typedValue) { typedValue.emplace(); }
+        return &*typedValue;
+    }
+    static void start(void* object) { Inner::target.start(getValue(object)); }
+    static void onValue(void* object, const char* strValue, uint32_t strSize)
+    {
+        if (strValue[0] == 0) {
+            static_cast<std::optional<T>*>(object)->reset();
+        } else {
+            Inner::target.onValue(getValue(object), strValue, strSize);
         }
-#endif
+    }
+    static DecodeSlot onItem(void* object, uint32_t idx) { return Inner::target.onItem(getValue(object), idx); }
+    static DecodeSlot onKey(void* object, const char* key, uint32_t keySize, uint64_t& state)
+    {
+        return Inner::target.onKey(getValue(object), key, keySize, state);
+    }
 
-        // Get the next token
-        bool        isStartingWithNewLine = (indexColNbr == 0);
-        TokenParser token = getToken(text, textSize, mlStringParentIndent, context.get(), sh, indexColNbr, lineNbr, startIdx);
-        dbgPrintf("  GetToken: %s baseIndent=%2d  newline=%d  String: [%s]\n", tokenName[(int)token.type], mlStringParentIndent,
-                  isStartingWithNewLine, token.stringSize ? context->getString(token.stringIdx) : "");
+    static constexpr DecodeTarget target = {&getTypeName<std::optional<T>>, &start, &onValue, Inner::target.onItem ? &onItem : nullptr,
+                                            Inner::target.onKey ? &onKey : nullptr};
+};
 
-        switch (token.type) {
-            case TokenType::Comment: {
-                int eltIdx = (int)elements.size();
-                elements.emplace_back(COMMENT, token.stringIdx, token.stringSize);
-                if (isStartingWithNewLine) { elements.back().setStandalone(); }
+// Pairs and tuples are sequences of fixed size
+template<class Tuple>
+struct DirectTupleDecoder {
+    static constexpr size_t ItemQty = std::tuple_size<Tuple>::value;
 
-                int parentCommentEltIdx = parent.eltIdx;
-                if (elements[parentCommentEltIdx].getType() == UNKNOWN && stack.size() >= 2) {
-                    parentCommentEltIdx =
-                        stack[stack.size() - 2].eltIdx;  // If the last is unknown, then the for-last must be a key or sequence
-                }
+    static void onValue(void*, const char* strValue, uint32_t) { checkEmptyValue(strValue, "a sequence"); }
 
-                if (elements[parentCommentEltIdx].getType() != UNKNOWN) {
-                    int tmpIdx = 0;
-                    while ((tmpIdx = elements[parentCommentEltIdx].getNextCommentIndex()) != 0) { parentCommentEltIdx = tmpIdx; }
-                    elements[parentCommentEltIdx].setComment(eltIdx);
-                }
-            } break;
+    template<std::size_t I>
+    static DecodeSlot getItem(void* object)
+    {
+        auto& item = std::get<I>(*static_cast<Tuple*>(object));
+        return {&DirectDecoder<std::remove_reference_t<decltype(item)>>::target, &item};
+    }
 
-            case TokenType::Caret: {
-                mlStringParentIndent = token.startColNbr;
-                const int colNbr     = token.startColNbr;
-
-                // Pop stack until caret has the same or higher indent than the parent
-                while (
-                    !stack.empty() &&
-                    (elements[parent.eltIdx].getType() != KEY || colNbr != parent.indent) &&  // Case a caret just below a key ("a:\n- b")
-                    (elements[parent.eltIdx].getType() != UNKNOWN || stack.size() < 2 ||
-                     elements[stack[stack.size() - 2].eltIdx].getType() != KEY ||
-                     colNbr != stack[stack.size() - 2].indent) &&  // Case a caret just below a key ("a:\n- b")
-                    colNbr <= parent.indent &&
-                    (parent.childIndent < 0 || colNbr < parent.childIndent)) {
-                    stack.pop_back();
-                    parent = stack.back();
-                }
+    template<std::size_t... Is>
+    static DecodeSlot getItem(void* object, uint32_t idx, std::index_sequence<Is...>)
+    {
+        static constexpr DecodeSlot (*getters[])(void*) = {&getItem<Is>...};
+        return getters[idx](object);
+    }
 
-                // Checks
-                if (stack.empty()) {
-                    throwParsing(tokenLineNbr, text + tokenIdx,
-                                 "Parse error: the indentation of the caret (=%d) does not match any parent (=%d)", colNbr,
-                                 parent.childIndent);  // Reachable state?
-                }
-                if (parent.childIndent >= 0 && colNbr != parent.childIndent) {
-                    throwParsing(tokenLineNbr, text + tokenIdx,
-                                 "Parse error: the indentation of the caret (=%d) is not aligned with other child elements (=%d)", colNbr,
-                                 parent.childIndent);
-                }
+    static DecodeSlot onItem(void* object, uint32_t idx)
+    {
+        if (idx >= ItemQty) { throwMessage<ConvertException>("Convert error: a sequence of %zu items is expected", ItemQty); }
+        return getItem(object, idx, std::make_index_sequence<ItemQty>{});
+    }
 
-                // Insert a sequence if the parent isn't one
-                if (elements[parent.eltIdx].getType() != SEQUENCE) {
-                    Element& parentElt = elements[parent.eltIdx];
-                    if (parentElt.getType() == UNKNOWN) {
-                        parentElt.reset(SEQUENCE);
-                        stack.back().indent      = colNbr;
-                        stack.back().childIndent = colNbr;
-                        parent                   = stack.back();
-                        if (stack[stack.size() - 2].childIndent < 0) stack[stack.size() - 2].childIndent = colNbr;
-                    } else {
-                        assert(parentElt.getType() != VALUE);
-                        if (parentElt.getType() == KEY && parentElt.getSubQty() > 0) {
-                            throwParsing(tokenLineNbr, text + tokenIdx,
-                                         "Parse error: probably bad indentation with caret, as the parent ('%s') already has a value",
-                                         to_string(KEY));  // Reachable state?
-                        }
-                        int eltIdx = (int)elements.size();
-                        elements.emplace_back(SEQUENCE);
-                        stack.emplace_back(eltIdx, colNbr, colNbr);
-                        elements[parent.eltIdx].add(eltIdx);
-                        parent = stack.back();
-                    }
-                }
+    static constexpr DecodeTarget target = {&getTypeName<Tuple>, &ignoreStart, &onValue, &onItem, nullptr};
+};
 
-                // Create the next node, untyped. This is required to handle the case of empty values in sequences.
-                assert(elements[parent.eltIdx].getType() == SEQUENCE);
-                int eltIdx = (int)elements.size();
-                elements.emplace_back(UNKNOWN);
-                stack.emplace_back(eltIdx, colNbr, -1);
-                elements[parent.eltIdx].add(eltIdx);
-                parent = stack.back();
+template<class T1, class T2>
+struct DirectDecoder<std::pair<T1, T2>> : DirectTupleDecoder<std::pair<T1, T2>> {};
 
-            } break;
+template<class... Ts>
+struct DirectDecoder<std::tuple<Ts...>> : DirectTupleDecoder<std::tuple<Ts...>> {};
 
-            case TokenType::Key: {
-                mlStringParentIndent = token.startColNbr;
-                const int colNbr     = token.startColNbr;
+// String store which keeps only the string of the current token
+class TokenStringStore
+{
+   public:
+    void addString(const char* text, uint32_t textSize, uint32_t& stringIdx, uint32_t& stringSize)
+    {
+        startStringSession();
+        addToSession(text, textSize);
+        commitSession(stringIdx, stringSize);
+    }
+    void startStringSession() { _buffer.clear(); }
+    void addToSession(const char* text, uint32_t textSize) { _buffer.insert(_buffer.end(), text, text + textSize); }
+    void commitSession(uint32_t& stringIdx, uint32_t& stringSize)
+    {
+        _buffer.push_back(0);
+        stringIdx  = 0;
+        stringSize = (uint32_t)_buffer.size();
+    }
+    const char* getString(int stringIdx) const { return _buffer.data() + stringIdx; }
 
-                // Pop stack until the key indent matches the parent's
-                while (!stack.empty() && colNbr <= parent.indent) {
-                    stack.pop_back();
-                    parent = stack.back();
-                }
+   private:
+    std::vector<char> _buffer;
+};
 
-                // Checks
-                if (stack.empty()) {
-                    throwParsing(tokenLineNbr, text + tokenIdx,
-                                 "Parse error: the indentation of the key (=%d) does not match any parent (=%d)", colNbr,
-                                 parent.childIndent);  // Reachable state?
-                }
-                if (parent.childIndent >= 0 && colNbr < parent.childIndent) {
-                    throwParsing(tokenLineNbr, text + tokenIdx,
-                                 "Parse error: the indentation of the key (=%d) is not aligned with other child elements (=%d)", colNbr,
-                                 parent.childIndent);
-                }
-                if (parent.childIndent < 0) {
-                    stack.back().childIndent = colNbr;
-                    parent                   = stack.back();
-                }
+// Decodes the parsed structure into the object. The ids are the depths in the parsing stack, as a node is always created as a
+// child of the top of the stack, after the deeper nodes have been popped
+class DirectBuilder
+{
+   public:
+    static constexpr const char* ConvertErrorPrefix = "Decode error: ";
 
-                // Insert a map if the parent isn't one
-                // This is required due to the idiomatic syntax "- a:" which implies a 'map' between the caret and the "a:"
-                if (elements[parent.eltIdx].getType() != MAP) {
-                    Element& parentElt = elements[parent.eltIdx];
-                    if (parentElt.getType() == UNKNOWN) {
-                        parentElt.reset(MAP);
-                    } else {
-                        assert(parentElt.getType() != VALUE);
-                        if (parentElt.getType() == KEY && parentElt.getSubQty() > 0) {
-                            throwParsing(tokenLineNbr, text + tokenIdx,
-                                         "Parse error: probably bad indentation, as the parent ('%s') already has a value",
-                                         to_string(parentElt.getType()));
-                        }
+    void setRoot(DecodeSlot root)
+    {
+        _frames.clear();
+        _frames.push_back({KEY, false, root, 0});
+    }
 
-                        int eltIdx = (int)elements.size();
-                        elements.emplace_back(MAP);
-                        stack.emplace_back(eltIdx, parent.indent, -1);
-                        elements[parent.eltIdx].add(eltIdx);
-                        parent = stack.back();
-                    }
-                }
+    TokenStringStore* getStringStore() { return &_strings; }
+    uint32_t          getRootId() const { return 0; }
+    NodeType          getType(uint32_t id) const { return _frames[id].type; }
+    bool              hasValue(uint32_t id) const { return _frames[id].hasValue; }
 
-                // Add key
-                if (parent.childIndent < 0) { stack.back().childIndent = colNbr; }
-                int eltIdx = (int)elements.size();
-                elements.emplace_back(KEY, token.stringIdx, token.stringSize);
-                stack.emplace_back(eltIdx, colNbr, -1);
-                assert(elements[parent.eltIdx].getType() != KEY || elements[parent.eltIdx].getSubQty() == 0);
-                elements[parent.eltIdx].add(eltIdx);
-                if (!context->addMapChildIndex(parent.eltIdx, context->getString(token.stringIdx), token.stringSize - 1,
-                                               &elements[parent.eltIdx], elements[parent.eltIdx].getSubQty() - 1)) {
-                    throwParsing(tokenLineNbr, text + tokenIdx,
-                                 "Parse error: duplicated key are forbidden and the key '%s' is already present.",
-                                 context->getString(token.stringIdx));
-                }
-                parent = stack.back();
-
-                // Create the next node, untyped. This is required to handle the case of empty values in sequences.
-                assert(elements[parent.eltIdx].getType() == KEY);
-                eltIdx = (int)elements.size();
-                elements.emplace_back(UNKNOWN);
-                stack.emplace_back(eltIdx, colNbr, -1);
-                elements[parent.eltIdx].add(eltIdx);
-                parent = stack.back();
-            } break;
+    void reset(uint32_t id, NodeType type)
+    {
+        _frames[id].type = type;
+        start(_frames[id]);
+    }
 
-            case TokenType::StringValue: {
-                const int colNbr = token.startColNbr;
+    uint32_t addChild(uint32_t parentId, NodeType type)
+    {
+        DecodeSlot slot = getChildSlot(parentId);
+        _frames.resize(parentId + 1);
+        _frames.push_back({type, false, slot, 0});
+        if (type != UNKNOWN) { start(_frames.back()); }
+        return parentId + 1;
+    }
 
-                // Checks
-                if (colNbr <= parent.indent) {
-                    throwParsing(tokenLineNbr, text + tokenIdx,
-                                 "Parse error: the indentation of the value (=%d) is not compatible with the parent indentation (=%d)",
-                                 colNbr, parent.indent);
-                }
-                if (parent.childIndent >= 0 && colNbr < parent.childIndent) {
-                    throwParsing(tokenLineNbr, text + tokenIdx,
-                                 "Parse error: the indentation of the value (=%d) is not aligned with other child elements (=%d)", colNbr,
-                                 parent.childIndent);
-                }
-                if (elements[parent.eltIdx].getType() == MAP) {
-                    throwParsing(tokenLineNbr, text + tokenIdx, "Parse error: in a map, a value without a key is forbidden");
-                }
-                if (parent.childIndent < 0) {
-                    stack.back().childIndent = colNbr;
-                    parent                   = stack.back();
-                }
+    uint32_t addKey(uint32_t parentId, const TokenParser& token)
+    {
+        Frame& parent = _frames[parentId];
+        assert(parent.type == MAP);
+        DecodeSlot slot = parent.slot.target->onKey(parent.slot.object, _strings.getString(token.stringIdx), token.stringSize - 1,
+                                                    parent.state);
+        if (!slot.target) { return UINT_MAX; }
+        _frames.resize(parentId + 1);
+        _frames.push_back({KEY, false, slot, 0});
+        return parentId + 1;
+    }
 
-                // Create the string value, either by typing an untyped node or creating a new one
-                Element& parentElt = elements[parent.eltIdx];
-                if (parentElt.getType() == UNKNOWN) {
-                    parentElt.reset(VALUE);
-                    parentElt.setString(token.stringIdx, token.stringSize);
-                    stack.pop_back();
-                    parent = stack.back();  // Now the parent is the upper container
-                } else {
-                    assert(parentElt.getType() != KEY || parentElt.getSubQty() == 0);  // Container or not a key already with value
-                    uint32_t eltIdx = (uint32_t)elements.size();
-                    elements.emplace_back(VALUE, token.stringIdx, token.stringSize);
-                    elements[parent.eltIdx].add(eltIdx);
-                }
+    void setValue(uint32_t id, const TokenParser& token)
+    {
+        _frames[id].type = VALUE;
+        decodeValue(_frames[id].slot, token);
+    }
 
-                // If the parent is a key, pop it from the stack (container with only 1 child)
-                if (elements[parent.eltIdx].getType() == KEY) {
-                    stack.pop_back();
-                    parent = stack.back();
-                }
-            } break;
+    void addValue(uint32_t parentId, const TokenParser& token) { decodeValue(getChildSlot(parentId), token); }
 
-            case TokenType::Newline:
-                mlStringParentIndent = parent.indent;
-                indexColNbr          = 0;
-                break;
+    void addComment(uint32_t, const TokenParser&, bool) {}
 
-            case TokenType::Eos:
-                isEndOfInput = true;
-                break;
+    void finish() {}
 
-            default:
-                assert(false && "Bug");
-        };
+   private:
+    struct Frame {
+        NodeType   type;
+        bool       hasValue;  // For keys
+        DecodeSlot slot;
+        uint64_t   state;  // Item quantity of sequences, decoding state of maps
+    };
 
-        tokenLineNbr = lineNbr;
-        tokenIdx     = startIdx;
-    }  // End of input
+    DecodeSlot getChildSlot(uint32_t parentId)
+    {
+        Frame& parent = _frames[parentId];
+        if (parent.type == SEQUENCE) { return parent.slot.target->onItem(parent.slot.object, (uint32_t)parent.state++); }
+        parent.hasValue = true;
+        return parent.slot;
+    }
 
-    return Document(context.release());
+    void start(Frame& frame)
+    {
+        const DecodeTarget* target = frame.slot.target;
+        if ((frame.type == SEQUENCE && !target->onItem) || (frame.type == MAP && !target->onKey)) {
+            throwMessage<ConvertException>("Convert error: a %s cannot be decoded as '%s'", styml::to_string(frame.type),
+                                           target->typeName());
+        }
+        frame.state = 0;
+        target->start(frame.slot.object);
+    }
+
+    void decodeValue(DecodeSlot slot, const TokenParser& token)
+    {
+        slot.target->onValue(slot.object, _strings.getString(token.stringIdx), token.stringSize - 1);
+    }
+
+    std::vector<Frame> _frames;
+    TokenStringStore   _strings;
+};
+
+// Working memory of the direct decoding, kept per thread so that decoding small texts does not allocate
+struct DecodeScratch {
+    DirectBuilder builder;
+    ParseScratch  parse;
+    bool          isUsed = false;  // A nested decoding (from a converter) uses its own working memory
+};
+
+}  // namespace detail
+
+// Decodes the text directly into an object, without building a document.
+// Supported types are the ones with a string converter, the bound structures, and the standard containers of them.
+// Unknown keys of the bound structures are ignored, and the missing or empty items leave the object fields unchanged
+template<class T>
+void
+decode(const char* text, uint32_t textSize, T& typedValue)
+{
+    thread_local detail::DecodeScratch threadScratch;
+    if (threadScratch.isUsed) {
+        detail::DecodeScratch scratch;
+        scratch.builder.setRoot({&detail::DirectDecoder<T>::target, &typedValue});
+        detail::parseStructure(text, textSize, scratch.builder, scratch.parse);
+        return;
+    }
+
+    struct UseGuard {
+        explicit UseGuard(bool& flag) : flag(flag) { flag = true; }
+        ~UseGuard() { flag = false; }
+        bool& flag;
+    } guard(threadScratch.isUsed);
+    threadScratch.builder.setRoot({&detail::DirectDecoder<T>::target, &typedValue});
+    detail::parseStructure(text, textSize, threadScratch.builder, threadScratch.parse);
 }
 
-inline Document
-parse(const char* text)
+template<class T>
+T
+decode(const char* text, uint32_t textSize)
 {
-    return parse(text, (uint32_t)strlen(text));
+    T typedValue{};
+    decode(text, textSize, typedValue);
+    return typedValue;
 }
 
-inline Document
-parse(const std::string& text)
+template<class T>
+T
+decode(const char* text)
 {
-    return parse(text.data(), (uint32_t)text.size());
+    return decode<T>(text, (uint32_t)strlen(text));
+}
+
+template<class T>
+T
+decode(const std::string& text)
+{
+    return decode<T>(text.data(), (uint32_t)text.size());
 }
 
 }  // Namespace styml
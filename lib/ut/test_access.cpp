@@ -22,6 +22,11 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+#include <cmath>
+#include <functional>
+#include <map>
+#include <thread>
+
 #include "test_main.h"
 
 using namespace styml;
@@ -51,6 +56,10 @@ TEST_SUITE("Parsing")
         CHECK(!root.hasKey("no key"));
         CHECK(root["key"].isValue());
 
+        CHECK(root["submap"].isMap());
+        root["submap"]["inner"] = 1;
+        CHECK(root["submap"]["inner"].as<int>() == 1);
+
         root.remove("other key");
         CHECK(!root.hasKey("other key"));
     }
@@ -173,6 +182,1540 @@ TEST_SUITE("Parsing")
         }
     }
 
+    TEST_CASE("1-Sanity   : Map removal keeps the key order")
+    {
+        constexpr int MapSize = 100;
+        auto          getKeys = [](Node map) {
+            std::vector<std::string> keys;
+            for (Node child : map) { keys.push_back(child.keyName()); }
+            return keys;
+        };
+
+        Document root;
+        root = NodeType::MAP;
+        for (int i = 0; i < MapSize; ++i) { root[std::to_string(i)] = i; }
+
+        // Remove some keys, without triggering the compaction
+        std::vector<std::string> expectedKeys;
+        for (int i = 0; i < MapSize; ++i) {
+            if ((i % 4) == 1) {
+                CHECK(root.remove(std::to_string(i)));
+            } else {
+                expectedKeys.push_back(std::to_string(i));
+            }
+        }
+        CHECK(!root.remove("1"));
+        CHECK(root.size() == expectedKeys.size());
+        CHECK(getKeys(root) == expectedKeys);
+        CHECK(root.to_string() == "[ Map of 75 elements ]");
+
+        // Remove most of the keys so that the holes are compacted, and check the index of the moved keys
+        for (int i = 0; i < MapSize; ++i) {
+            if ((i % 4) == 2 || (i % 4) == 3) { CHECK(root.remove(std::to_string(i))); }
+        }
+        expectedKeys.clear();
+        for (int i = 0; i < MapSize; i += 4) { expectedKeys.push_back(std::to_string(i)); }
+        CHECK(root.size() == expectedKeys.size());
+        CHECK(getKeys(root) == expectedKeys);
+        for (int i = 0; i < MapSize; ++i) { CHECK(root.hasKey(std::to_string(i)) == ((i % 4) == 0)); }
+        for (int i = 0; i < MapSize; i += 4) { CHECK(root[std::to_string(i)].as<int>() == i); }
+
+        // New keys are appended at the end
+        root["new"] = "last";
+        expectedKeys.push_back("new");
+        CHECK(getKeys(root) == expectedKeys);
+
+        // Emitters skip the holes
+        Document small;
+        small         = NodeType::MAP;
+        small["a"]    = 1;
+        small["b"]    = 2;
+        small["c"]    = 3;
+        small["list"] = NodeType::SEQUENCE;
+        small["list"].push_back(NodeType::MAP);
+        small["list"][0]["x"] = 1;
+        small["list"][0]["y"] = 2;
+        small.remove("b");
+        small["list"][0].remove("x");
+        CHECK(std::string(small.asYaml().c_str()) == "a: 1\nc: 3\nlist:\n  - y: 2");
+        CHECK(std::string(small.asPyStruct(false).c_str()) == "{'a' : \"1\",'c' : \"3\",'list' : [{'y' : \"2\"}]}");
+    }
+
+    TEST_CASE("1-Sanity   : Large sequence edition")
+    {
+        constexpr int StartSize = 20000;
+        constexpr int EditQty   = 20000;
+
+        // Reference model of the sequence
+        std::vector<int> model;
+        Document         doc;
+        doc        = NodeType::MAP;
+        doc["seq"] = NodeType::SEQUENCE;
+        Node root  = doc["seq"];
+        for (int i = 0; i < StartSize; ++i) {
+            root.push_back(i);
+            model.push_back(i);
+        }
+
+        auto checkContent = [&root, &model]() {
+            REQUIRE(root.size() == model.size());
+            bool isOk = true;
+            for (size_t i = 0; i < model.size(); ++i) { isOk = isOk && (root[(uint32_t)i].as<int>() == model[i]); }
+            CHECK(isOk);
+            size_t idx = 0;
+            for (Node item : root) { isOk = isOk && (idx < model.size() && item.as<int>() == model[idx++]); }
+            CHECK(isOk);
+            CHECK(idx == model.size());
+            CHECK(root.asVector<int>() == model);
+        };
+
+        // Random insertions and removals in the middle, with the front and the back included
+        int nextValue = StartSize;
+        for (int editIdx = 0; editIdx < EditQty; ++editIdx) {
+            uint32_t position = (uint32_t)(testGetRandom() % (model.size() + 1));
+            if ((editIdx % 5) == 0) { position = 0; }
+            if ((testGetRandom() % 3) != 0) {
+                root.insert(position, nextValue);
+                model.insert(model.begin() + position, nextValue++);
+            } else if (position < model.size()) {
+                root.remove(position);
+                model.erase(model.begin() + position);
+            }
+        }
+        checkContent();
+
+        // Emitters and parsing
+        Document reparsed = parse(doc.asYaml().c_str());
+        CHECK(reparsed["seq"].asVector<int>() == model);
+
+        // Shrink the sequence back to a small size, with random removals
+        while (model.size() > 500) {
+            uint32_t position = (uint32_t)(testGetRandom() % model.size());
+            root.remove(position);
+            model.erase(model.begin() + position);
+        }
+        checkContent();
+        root.push_back(-1);
+        model.push_back(-1);
+        root[3]  = -3;
+        model[3] = -3;
+        checkContent();
+    }
+
+    TEST_CASE("1-Sanity   : Sequence range operations")
+    {
+        Document root;
+        root = NodeType::MAP;
+        root.insert("a", NodeType::SEQUENCE);
+        root.insert("b", NodeType::SEQUENCE);
+        Node a = root["a"], b = root["b"];
+        for (int i = 0; i < 10; ++i) {
+            a.push_back(i);
+            b.push_back(100 + i);
+        }
+        a[5]        = NodeType::MAP;
+        a[5]["key"] = "value";
+
+        a.erase(1, 3);
+        CHECK(a.size() == 7);
+        CHECK(a[0].as<int>() == 0);
+        CHECK(a[1].as<int>() == 4);
+        CHECK(a[2]["key"].as<std::string>() == "value");
+        a.erase(7, 0);
+        CHECK_THROWS_AS(a.erase(5, 3), AccessException);
+        CHECK_THROWS_AS(root.erase(0, 1), AccessException);
+
+        // Move items between the sequences, sub-structures included
+        a.splice(1, b, 8, 2);  // a = 0 108 109 4 {key} 6 7 8 9
+        CHECK(b.size() == 8);
+        CHECK(a.size() == 9);
+        CHECK(a[2].as<int>() == 109);
+        b.splice(0, a, 4, 1);  // b = {key} 100 ... 107
+        CHECK(b[0]["key"].as<std::string>() == "value");
+        CHECK(b.size() == 9);
+        CHECK(a.asVector<int>() == std::vector<int>({0, 108, 109, 4, 6, 7, 8, 9}));
+
+        // Move inside the same sequence
+        a.splice(0, a, 6, 2);
+        CHECK(a.asVector<int>() == std::vector<int>({8, 9, 0, 108, 109, 4, 6, 7}));
+        a.splice(8, a, 0, 2);
+        CHECK(a.asVector<int>() == std::vector<int>({0, 108, 109, 4, 6, 7, 8, 9}));
+        CHECK_THROWS_AS(a.splice(2, a, 1, 3), AccessException);
+        Document other;
+        other = NodeType::SEQUENCE;
+        CHECK_THROWS_AS(a.splice(0, other, 0, 0), AccessException);
+        Document nested = parse("- - x\n  - y\n- z\n");
+        CHECK_THROWS_AS(nested[0].splice(0, nested, 0, 1), AccessException);  // The destination is inside the moved item
+        CHECK_THROWS_AS(nested[0].splice(0, nested, 0, 2), AccessException);
+        CHECK(nested[0].asVector<std::string>() == std::vector<std::string>({"x", "y"}));
+        nested[0].splice(2, nested, 1, 1);
+        CHECK(nested.size() == 1);
+        CHECK(nested[0].asVector<std::string>() == std::vector<std::string>({"x", "y", "z"}));
+        CHECK(nested[0][2].parent()[0].as<std::string>() == "x");  // The parent index follows the moved items
+
+        a.truncate(3);
+        CHECK(a.asVector<int>() == std::vector<int>({0, 108, 109}));
+        CHECK_THROWS_AS(a.truncate(4), AccessException);
+        CHECK(std::string(root.asYaml().c_str()) ==
+              "a:\n  - 0\n  - 108\n  - 109\nb:\n  - key: value\n  - 100\n  - 101\n  - 102\n  - 103\n  - 104\n  - 105\n  - 106\n  - 107");
+
+        // Range operations on a chunked sequence
+        std::vector<int> model;
+        for (int i = 0; i < 10000; ++i) {
+            b.push_back(i);
+            model.push_back(i);
+        }
+        b.erase(0, 9);
+        b.insert(10, -1);  // Middle insertion
+        model.insert(model.begin() + 10, -1);
+        b.erase(100, 1000);
+        model.erase(model.begin() + 100, model.begin() + 1100);
+        CHECK(b.asVector<int>() == model);
+        b.insert(10, -2);
+        model.insert(model.begin() + 10, -2);
+        b.truncate(5000);
+        model.resize(5000);
+        CHECK(b.asVector<int>() == model);
+    }
+
+    TEST_CASE("1-Sanity   : Map batch insertion")
+    {
+        Document root;
+        root         = NodeType::MAP;
+        root["base"] = 0;
+        CHECK_THROWS_AS(root["base"].beginBatch(), AccessException);
+
+        // Nominal batch
+        {
+            auto tx = root.beginBatch();
+            tx.insert("a", 1).insert("b", "two");
+            Node sub = tx.insert("sub", NodeType::SEQUENCE);
+            sub.push_back(3);
+            CHECK(tx.size() == 3);
+            CHECK(!root.hasKey("a"));  // Not visible before the commit
+            tx.commit();
+            CHECK_THROWS_AS(tx.commit(), AccessException);
+            CHECK_THROWS_AS(tx.insert("c", 4), AccessException);
+        }
+        CHECK(root.size() == 4);
+        CHECK(root["a"].as<int>() == 1);
+        CHECK(root["b"].as<std::string>() == "two");
+        CHECK(root["sub"][0].as<int>() == 3);
+        CHECK(std::string(root.asYaml().c_str()) == "base: 0\na: 1\nb: two\nsub:\n  - 3");
+
+        // Duplicated keys discard the whole batch, whether they are already present or inside the batch
+        {
+            auto tx = root.beginBatch();
+            tx.insert("c", 1).insert("a", 2);
+            CHECK_THROWS_AS(tx.commit(), AccessException);
+        }
+        {
+            auto tx = root.beginBatch();
+            tx.insert("c", 1).insert("d", 2).insert("c", 3);
+            CHECK_THROWS_AS(tx.commit(), AccessException);
+        }
+        CHECK(root.size() == 4);
+        CHECK(!root.hasKey("c"));
+        CHECK(!root.hasKey("d"));
+        CHECK(root["a"].as<int>() == 1);
+
+        // A batch without commit is discarded
+        {
+            auto tx = root.beginBatch();
+            tx.insert("e", 5);
+        }
+        CHECK(root.size() == 4);
+        CHECK(!root.hasKey("e"));
+
+        // Large batch, after removals so that the index contains deleted entries
+        for (const char* key : {"a", "b"}) { CHECK(root.remove(key)); }
+        auto tx = root.beginBatch();
+        for (int i = 0; i < 10000; ++i) { tx.insert(std::to_string(i), i); }
+        tx.commit();
+        CHECK(root.size() == 10002);
+        bool isOk = true;
+        for (int i = 0; i < 10000; ++i) { isOk = isOk && root[std::to_string(i)].as<int>() == i; }
+        CHECK(isOk);
+        root["a"] = 1;
+        CHECK_THROWS_AS(root.insert("5000", 1), AccessException);
+    }
+
+    TEST_CASE("1-Sanity   : Reserve and range insertion")
+    {
+        Document root;
+        root = NodeType::MAP;
+        root.insert("seq", NodeType::SEQUENCE);
+        root.insert("map", NodeType::MAP);
+        CHECK_THROWS_AS(root["unknown"].reserve(10), AccessException);
+
+        // Sequence
+        std::vector<int> values{1, 2, 3, 4};
+        Node             seq = root["seq"];
+        seq.reserve(100, 1000);
+        seq.push_back(values.begin(), values.end());
+        seq.push_back(values.rbegin(), values.rbegin() + 2);
+        CHECK(seq.size() == 6);
+        CHECK(seq.asVector<int>() == std::vector<int>{1, 2, 3, 4, 4, 3});
+        seq.reserve(2);  // No effect, as the size is already higher
+        CHECK(seq.size() == 6);
+
+        // Map
+        std::map<std::string, int> m{{"a", 1}, {"b", 2}, {"c", 3}};
+        Node                       map = root["map"];
+        map.insert(m.begin(), m.end());
+        CHECK(map.size() == 3);
+        CHECK(map["b"].as<int>() == 2);
+        std::pair<const char*, double> pairs[2] = {{"d", 0.5}, {"a", 1.5}};
+        CHECK_THROWS_AS(map.insert(pairs, pairs + 2), AccessException);  // Duplicated key 'a'
+        CHECK(map["d"].as<double>() == 0.5);
+
+        // Not ambiguous with the indexed insertion
+        seq.insert(1, 5);
+        CHECK(seq[1].as<int>() == 5);
+
+        // Big map with reservation
+        root["big"] = NodeType::MAP;
+        Node big    = root["big"];
+        big.reserve(10000);
+        for (int i = 0; i < 10000; ++i) { big[std::to_string(i)] = i; }
+        for (int i = 0; i < 10000; ++i) { CHECK(big[std::to_string(i)].as<int>() == i); }
+    }
+
+    TEST_CASE("2-Benchmark: Range insertion")
+    {
+        constexpr int AppendQty = 40000;
+
+        // Many small range appends, each one reserving its items
+        std::vector<int>                         values{1, 2, 3, 4};
+        std::vector<std::pair<std::string, int>> items;
+        for (int i = 0; i < 4 * AppendQty; ++i) { items.emplace_back(std::to_string(i), i); }
+        Document seq;
+        seq = NodeType::SEQUENCE;
+        Document map;
+        map = NodeType::MAP;
+
+        uint64_t startTimeUs = getTime();
+        for (int i = 0; i < AppendQty; ++i) { seq.push_back(values.begin(), values.end()); }
+        uint64_t midTimeUs = getTime();
+        for (int i = 0; i < AppendQty; ++i) { map.insert(items.begin() + 4 * i, items.begin() + 4 * (i + 1)); }
+        uint64_t endTimeUs = getTime();
+        CHECK(seq.size() == 4 * AppendQty);
+        CHECK(map.size() == 4 * AppendQty);
+
+        printf("  Performance for %d range appends of 4 items\n", AppendQty);
+        printf("    Sequence : %.3f ms\n", 1e-3 * (double)(midTimeUs - startTimeUs));
+        printf("    Map      : %.3f ms\n", 1e-3 * (double)(endTimeUs - midTimeUs));
+    }
+
+    TEST_CASE("1-Sanity   : Non-throwing lookups")
+    {
+        const char* document = R"END(
+build:
+  name: job
+  steps:
+    - run: make
+      timeout: 30
+    - run: make test
+)END";
+        Document    root     = parse(document);
+
+        CHECK(root.find("build").find("name").as<std::string>() == "job");
+        CHECK(root.find("build").find("steps").find(1).find("run").as<std::string>() == "make test");
+        CHECK(!root.find("missing"));
+        CHECK(!root.find("missing").find("other").find(3));
+        CHECK(!root.find("build").find(0));                // Not a sequence
+        CHECK(!root.find("build").find("steps").find(2));  // Out of bounds
+        CHECK(!root["missing"].find("other"));             // Pending key node
+
+        CHECK(root.findPath("build.steps[0].timeout").as<int>() == 30);
+        CHECK(root.findPath("build.steps[1]").isMap());
+        CHECK(root.findPath("").isMap());
+        CHECK(!root.findPath("build.steps[2].run"));
+        CHECK(!root.findPath("build.steps[x]"));
+        CHECK(!root.findPath("build.steps[0"));
+        CHECK(!root.findPath("build..name"));
+        CHECK(!root.findPath("build."));
+        CHECK(!root.findPath(".build"));
+        CHECK(!root.findPath("build.steps.[0]"));
+        CHECK(!root.findPath("build.steps[0]run"));
+
+        CHECK(root.get("build.steps[0].timeout", 10) == 30);
+        CHECK(root.get("build.steps[1].timeout", 10) == 10);
+        CHECK(root.get("build.retry.count", std::string("none")) == "none");
+        CHECK(root.get("build.retry.count", "none") == "none");
+        CHECK(root.get("build.name", std::string_view("none")) == "job");
+        CHECK_THROWS_AS(root.get("build.steps[0].run", 10), AccessException);  // Present but not an integer
+    }
+
+    TEST_CASE("1-Sanity   : Fragment parsing")
+    {
+        Document root = parse("name: app\nservices:\n  web: old\nlist:\n  - a\n");
+
+        // Replacement of an existing value, of a map and of a non existing key
+        root["name"].parseInto("first: 1\nsecond:\n  - x\n  - y\n");
+        CHECK(root["name"]["second"][1].as<std::string>() == "y");
+        root["services"].parseInto("db:\n  image: postgres\n");
+        CHECK(!root["services"].hasKey("web"));
+        CHECK(root["services"]["db"]["image"].as<std::string>() == "postgres");
+        root["services"]["db"]["port"] = 5432;
+        root["added"].parseInto(std::string("- 1\n- 2\n"));
+        CHECK(root["added"].size() == 2);
+        root["list"].parseInto("scalar\n");
+        CHECK(root["list"].as<std::string>() == "scalar");
+        CHECK(std::string(root.asYaml().c_str()) ==
+              "name:\n  first: 1\n  second:\n    - x\n    - y\nservices:\n  db:\n    image: postgres\n    port: 5432\n"
+              "list: scalar\nadded:\n  - 1\n  - 2");
+        CHECK_THROWS_AS(root["name"].parseInto("a: 1\na: 2\n"), ParseException);
+        CHECK(root["name"]["first"].as<int>() == 1);  // Unchanged after a parsing error
+
+        // Appending
+        root["added"].appendParsed("- 3\n- - 4\n  - 5\n");
+        root["added"].appendParsed("6\n");
+        CHECK(root["added"].size() == 5);
+        CHECK(root["added"][3][1].as<int>() == 5);
+        CHECK(root["added"][4].as<int>() == 6);
+        root["services"].appendParsed("cache:\n  image: redis\n");
+        CHECK(root["services"]["cache"]["image"].as<std::string>() == "redis");
+        CHECK_THROWS_AS(root["services"].appendParsed("other: 1\ndb: 2\n"), AccessException);
+        CHECK(!root["services"].hasKey("other"));
+        CHECK_THROWS_AS(root["services"].appendParsed("- 1\n"), AccessException);
+        CHECK_THROWS_AS(root["list"].appendParsed("- 1\n"), AccessException);
+
+        // Empty document and empty fragment
+        Document empty;
+        empty.parseInto("a: 1\n");
+        CHECK(empty["a"].as<int>() == 1);
+        empty["b"] = "2";
+        CHECK(std::string(empty.asYaml().c_str()) == "a: 1\nb: 2");
+        for (Node child : empty) {
+            if (child.keyName() == "b") { child.parseInto("- 3\n"); }
+        }
+        CHECK(empty["b"][0].as<int>() == 3);
+        root["name"].parseInto("");
+        CHECK(root["name"].as<std::string>().empty());
+    }
+
+    TEST_CASE("2-Benchmark: Fragment parsing")
+    {
+        constexpr int ItemQty = 20000;
+        std::string   fragment;
+        for (int i = 0; i < 10; ++i) { fragment += "key" + std::to_string(i) + ":\n  name: item\n  values: [1, 2, 3]\n"; }
+
+        // Parsing in a separate document, then copy of the structure
+        std::function<void(Node, Node)> copyNode = [&copyNode](Node src, Node dst) {
+            if (src.isMap()) {
+                dst = NodeType::MAP;
+                for (Node child : src) {
+                    if (child.value().isMap() || child.value().isSequence()) {
+                        dst[child.keyName()] = NodeType::SEQUENCE;
+                        copyNode(child.value(), dst[child.keyName()]);
+                    } else {
+                        dst[child.keyName()] = child.value().as<std::string>();
+                    }
+                }
+            } else if (src.isSequence()) {
+                dst = NodeType::SEQUENCE;
+                for (Node child : src) { dst.push_back(child.as<std::string>()); }
+            }
+        };
+        uint64_t startTimeUs = getTime();
+        Document copied      = parse("items:\n");
+        copied["items"]      = NodeType::SEQUENCE;
+        for (int i = 0; i < ItemQty; ++i) {
+            Document parsed = parse(fragment);
+            copied["items"].push_back(NodeType::MAP);
+            copyNode(parsed, copied["items"][i]);
+        }
+        uint64_t midTimeUs = getTime();
+
+        // Direct parsing in place
+        Document direct = parse("items:\n");
+        direct["items"] = NodeType::SEQUENCE;
+        for (int i = 0; i < ItemQty; ++i) { direct["items"].appendParsed(fragment); }
+        uint64_t endTimeUs = getTime();
+        CHECK(direct["items"].size() == ItemQty);
+        CHECK(std::string(direct.asYaml().c_str()) == std::string(copied.asYaml().c_str()));
+
+        printf("  Insertion of %d parsed fragments\n", ItemQty);
+        printf("    Parse and copy : %.3f ms\n", 1e-3 * (double)(midTimeUs - startTimeUs));
+        printf("    Parse in place : %.3f ms\n", 1e-3 * (double)(endTimeUs - midTimeUs));
+    }
+
+    TEST_CASE("1-Sanity   : Columnar view")
+    {
+        const char* text = R"END(
+- ts: 100
+  host: alpha
+  latency: 1.5
+- ts: 101  # Comment in the map
+  latency: 2
+  host: beta
+  extra: ignored
+# Comment in the sequence
+- host: gamma
+  ts: 0x10
+  latency:
+- ts: 103
+  host: 12
+  latency: 3e2
+)END";
+        Document    root = parse(text);
+
+        Columns columns = root.columns({"ts", "latency", "host", "absent"});
+        CHECK(columns.rowQty() == 4);
+        CHECK(columns.size() == 4);
+
+        const Columns::Column& ts = columns["ts"];
+        CHECK(ts.kind == Columns::Kind::Integer);
+        CHECK(ts.integers == std::vector<int64_t>{100, 101, 16, 103});
+        CHECK(ts.floats[2] == 16.);
+        CHECK(ts.strings[2] == "0x10");
+
+        const Columns::Column& latency = columns[1];
+        CHECK(latency.name == "latency");
+        CHECK(latency.kind == Columns::Kind::Float);
+        CHECK(latency.integers.empty());
+        CHECK(latency.floats[0] == 1.5);
+        CHECK(latency.floats[1] == 2.);
+        CHECK(std::isnan(latency.floats[2]));
+        CHECK(latency.floats[3] == 300.);
+        CHECK(latency.isPresent == std::vector<uint8_t>{1, 1, 0, 1});
+
+        const Columns::Column& host = columns["host"];
+        CHECK(host.kind == Columns::Kind::String);
+        CHECK(host.floats.empty());
+        CHECK(host.strings == std::vector<std::string_view>{"alpha", "beta", "gamma", "12"});
+
+        CHECK(columns["absent"].kind == Columns::Kind::String);
+        CHECK(columns["absent"].isPresent == std::vector<uint8_t>(4, 0));
+        CHECK_THROWS_AS(columns["unknown"], AccessException);
+        CHECK_THROWS_AS(columns[4], AccessException);
+
+        // Runtime key names, and invalid structures
+        Columns hosts = root.columns(std::vector<std::string>{"host"});
+        CHECK(hosts[0].strings[1] == "beta");
+        CHECK_THROWS_AS(root[0].columns({"ts"}), AccessException);
+        CHECK_THROWS_AS(parse("- a: 1\n- b\n").columns({"a"}), AccessException);
+        CHECK_THROWS_AS(parse("- a:\n    - 1\n").columns({"a"}), AccessException);
+        CHECK(parse("- a: 1\n").columns({}).rowQty() == 1);
+
+        // A comment leading an item is stored as a sequence item, and is not a row
+        Columns commented = parse("-\n  # c\n  a: 1\n- a: 2\n").columns({"a"});
+        CHECK(commented.rowQty() == 2);
+        CHECK(commented["a"].integers == std::vector<int64_t>{1, 2});
+    }
+
+    TEST_CASE("2-Benchmark: Columnar view")
+    {
+        constexpr int RecordQty = 200000;
+        std::string   text;
+        for (int i = 0; i < RecordQty; ++i) {
+            text += "- ts: " + std::to_string(1000000 + i) + "\n  host: host" + std::to_string(i % 16) +
+                    "\n  latency: " + std::to_string(i % 100) + ".25\n  status: ok\n";
+        }
+        Document root = parse(text);
+
+        // Per record lookups
+        uint64_t startTimeUs = getTime();
+        double   sumLookup   = 0.;
+        for (int i = 0; i < RecordQty; ++i) {
+            Node record = root[i];
+            if (record["host"].as<std::string>() != "host3") { sumLookup += record["latency"].as<double>(); }
+        }
+        uint64_t midTimeUs = getTime();
+
+        // Column build and scan
+        Columns                columns = root.columns({"latency", "host"});
+        const Columns::Column& latency = columns[0];
+        const Columns::Column& host    = columns[1];
+        uint64_t               buildTimeUs = getTime();
+        double                 sumColumns  = 0.;
+        for (size_t i = 0; i < columns.rowQty(); ++i) {
+            if (host.strings[i] != "host3") { sumColumns += latency.floats[i]; }
+        }
+        uint64_t endTimeUs = getTime();
+        CHECK(sumColumns == sumLookup);
+
+        printf("  Filtered sum over %d records\n", RecordQty);
+        printf("    Per record lookups : %.3f ms\n", 1e-3 * (double)(midTimeUs - startTimeUs));
+        printf("    Column build       : %.3f ms\n", 1e-3 * (double)(buildTimeUs - midTimeUs));
+        printf("    Column scan        : %.3f ms\n", 1e-3 * (double)(endTimeUs - buildTimeUs));
+    }
+
+    TEST_CASE("1-Sanity   : Path queries")
+    {
+        const char* text = R"END(
+services:
+  web:
+    image: nginx
+    timeout: 10
+  db:
+    image: postgres
+    # No timeout here
+  cache:
+    ports:
+      - 6379
+jobs:
+  - name: build
+    steps:
+      - run: make
+      - run: make test
+        timeout: 30
+  - name: empty
+  - steps:
+      - uses: checkout
+      - run: deploy
+timeout: 5
+)END";
+        Document    root = parse(text);
+        root["services"].remove("cache");
+        root["services"]["cache"] = "removed then added";  // Hole in the map
+
+        auto texts = [](const std::vector<Node>& nodes) {
+            std::vector<std::string> result;
+            for (const Node& node : nodes) { result.push_back(node.as<std::string>()); }
+            return result;
+        };
+
+        Query images("services.*.image");
+        CHECK(texts(images.findAll(root)) == std::vector<std::string>{"nginx", "postgres"});
+        CHECK(texts(images.findAll(root)) == std::vector<std::string>{"nginx", "postgres"});  // Reused query
+
+        Query runs("jobs[*].steps[*].run");
+        CHECK(texts(runs.findAll(root)) == std::vector<std::string>{"make", "make test", "deploy"});
+        CHECK(texts(Query("jobs[2].steps[1].run").findAll(root)) == std::vector<std::string>{"deploy"});
+        CHECK(texts(Query("jobs[*].name").findAll(root["services"])).empty());
+
+        Query timeouts("**.timeout");
+        CHECK(texts(timeouts.findAll(root)) == std::vector<std::string>{"10", "30", "5"});
+        CHECK(texts(timeouts.findAll(root["jobs"])) == std::vector<std::string>{"30"});
+        CHECK(Query("**").findAll(root["services"]["web"]).size() == 3);  // The map and its 2 values
+        CHECK(Query("**.**.image").findAll(root).size() == 2);            // Not duplicated by the 2 descendant steps
+        CHECK(Query("jobs.**[1]").findAll(root).size() == 3);             // The second job and the second steps
+        CHECK(Query("").findAll(root).size() == 1);                       // The node itself
+
+        int count = 0;
+        Query("**.run").forEach(root, [&count](Node node) { count += node.isValue() ? 1 : 0; });
+        CHECK(count == 3);
+        std::vector<std::string> outerTexts;  // The same query evaluated again inside the callback
+        timeouts.forEach(root, [&](Node node) {
+            CHECK(timeouts.findAll(root).size() == 3);
+            outerTexts.push_back(node.as<std::string>());
+        });
+        CHECK(outerTexts == std::vector<std::string>{"10", "30", "5"});
+        CHECK(Query("*").findAll(Document()).empty());
+
+        CHECK_THROWS_AS(Query("jobs[*"), AccessException);
+        CHECK_THROWS_AS(Query("jobs[x]"), AccessException);
+        CHECK_THROWS_AS(Query("jobs..name"), AccessException);
+        CHECK_THROWS_AS(Query("jobs."), AccessException);
+    }
+
+    TEST_CASE("2-Benchmark: Path queries")
+    {
+        constexpr int ServiceQty = 50000;
+        Document      root;
+        root             = NodeType::MAP;
+        root["services"] = NodeType::MAP;
+        Node services    = root["services"];
+        for (int i = 0; i < ServiceQty; ++i) {
+            std::string name = "service" + std::to_string(i);
+            services[name]   = NodeType::MAP;
+            Node service     = services[name];
+            service["image"] = "image" + std::to_string(i);
+            service["env"]   = NodeType::MAP;
+            service["env"]["timeout"] = i % 60;
+            service["env"]["level"]   = "info";
+        }
+
+        // Hand-written recursion with the Node API
+        std::function<void(Node, std::vector<std::string>&)> collect = [&collect](Node node, std::vector<std::string>& values) {
+            if (node.isMap()) {
+                for (Node child : node) {
+                    if (child.keyName() == "timeout") { values.push_back(child.value().as<std::string>()); }
+                    collect(child.value(), values);
+                }
+            } else if (node.isSequence()) {
+                for (Node child : node) { collect(child, values); }
+            }
+        };
+
+        uint64_t                 startTimeUs = getTime();
+        std::vector<std::string> recursive;
+        collect(root, recursive);
+        uint64_t          midTimeUs = getTime();
+        std::vector<Node> matches   = Query("**.timeout").findAll(root);
+        uint64_t          endTimeUs = getTime();
+        CHECK(matches.size() == ServiceQty);
+        CHECK(recursive.size() == ServiceQty);
+
+        printf("  Search of '**.timeout' in %d services\n", ServiceQty);
+        printf("    Recursive with Node : %.3f ms\n", 1e-3 * (double)(midTimeUs - startTimeUs));
+        printf("    Query               : %.3f ms\n", 1e-3 * (double)(endTimeUs - midTimeUs));
+    }
+
+    TEST_CASE("1-Sanity   : Upward navigation")
+    {
+        const char* text = R"END(
+build:
+  # Comment before the steps
+  steps:
+    - run: make
+    - run: make test  # Comment in the map
+      env:
+        level: debug
+  name: job
+)END";
+        Document    root = parse(text);
+
+        Node level = root.findPath("build.steps[1].env.level");
+        CHECK(level.path() == "build.steps[1].env.level");
+        CHECK(level.depth() == 5);
+        CHECK(level.parent().isMap());
+        CHECK(level.parent().parent()["run"].as<std::string>() == "make test");
+        CHECK(level.parent().parent().parent().path() == "build.steps");
+        CHECK(root.findPath(level.path()).as<std::string>() == "debug");
+        CHECK(root.path().empty());
+        CHECK(root.depth() == 0);
+        CHECK(!root.parent());
+        CHECK(!Node().parent());
+        for (Node child : root["build"]) {
+            if (child.isKey()) { CHECK(child.parent()["name"].as<std::string>() == "job"); }
+        }
+
+        // The index follows the modifications
+        root["build"]["steps"].push_back(NodeType::MAP);
+        root["build"]["steps"][2]["run"] = "deploy";
+        CHECK(root.findPath("build.steps[2].run").path() == "build.steps[2].run");
+        root["build"].remove("name");
+        root["build"]["other"] = NodeType::SEQUENCE;
+        root["build"]["other"].splice(0, root["build"]["steps"], 0, 1);
+        CHECK(root.findPath("build.other[0].run").path() == "build.other[0].run");
+        CHECK(root.findPath("build.steps[0].run").path() == "build.steps[0].run");
+        CHECK(root.findPath("build.steps[0].run").as<std::string>() == "make test");
+
+        // Sequence at the root
+        Document seq;
+        seq = NodeType::SEQUENCE;
+        seq.push_back(NodeType::SEQUENCE);
+        seq[0].push_back("a");
+        CHECK(seq[0][0].path() == "[0][0]");
+        CHECK(seq[0][0].depth() == 2);
+
+        // Keys with path characters are escaped, so that the paths are resolved back
+        Document files = parse("files:\n  config.yaml: a\n  \"list[0]\": b\n  back\\slash: c\n  \"*\": d\n");
+        Node     config = files["files"]["config.yaml"];
+        CHECK(config.path() == "files.config\\.yaml");
+        CHECK(files["files"]["list[0]"].path() == "files.list\\[0]");
+        CHECK(files["files"]["back\\slash"].path() == "files.back\\\\slash");
+        int resolvedQty = 0;
+        for (Node item : files["files"]) {
+            if (item.isKey() && files.findPath(item.value().path()).as<std::string>() == item.value().as<std::string>()) { ++resolvedQty; }
+        }
+        CHECK(resolvedQty == 4);
+        CHECK(!files.findPath("files.config.yaml"));
+        CHECK(!files.findPath("files.config\\"));
+        CHECK(files.findPath("files.\\*").as<std::string>() == "d");
+        CHECK(Query("files.config\\.yaml").findAll(files).size() == 1);
+        CHECK(Query("**.list\\[0]").findAll(files).size() == 1);
+        CHECK(Query("files.\\*").findAll(files).size() == 1);
+        CHECK(Query("files.*").findAll(files).size() == 4);
+        CHECK_THROWS_AS(Query("files.config\\"), AccessException);
+    }
+
+    TEST_CASE("2-Benchmark: Upward navigation")
+    {
+        constexpr int ItemQty = 2000;
+        Document      root;
+        root          = NodeType::MAP;
+        root["items"] = NodeType::SEQUENCE;
+        for (int i = 0; i < ItemQty; ++i) {
+            root["items"].push_back(NodeType::MAP);
+            root["items"][i]["name"]  = "item" + std::to_string(i);
+            root["items"][i]["value"] = i;
+        }
+        std::vector<Node> values = Query("items[*].value").findAll(root);
+
+        // Search of each node from the root
+        std::function<bool(Node, uint32_t, std::string&)> search = [&search](Node node, uint32_t target, std::string& path) {
+            if (node.isMap()) {
+                for (Node child : node) {
+                    if (search(child.value(), target, path)) {
+                        path = "." + child.keyName() + path;
+                        return true;
+                    }
+                }
+            } else if (node.isSequence()) {
+                for (uint32_t i = 0; i < node.size(); ++i) {
+                    if (search(node[i], target, path)) {
+                        path = "[" + std::to_string(i) + "]" + path;
+                        return true;
+                    }
+                }
+            }
+            return (node.isValue() && node.as<std::string>() == std::to_string(target));
+        };
+        uint64_t startTimeUs = getTime();
+        size_t   searchSize  = 0;
+        for (int i = 0; i < ItemQty; ++i) {
+            std::string path;
+            search(root, (uint32_t)i, path);
+            searchSize += path.size() - 1;  // Without the leading '.'
+        }
+        uint64_t midTimeUs = getTime();
+        size_t   pathSize  = 0;
+        for (const Node& value : values) { pathSize += value.path().size(); }
+        uint64_t endTimeUs = getTime();
+        CHECK(pathSize == searchSize);
+
+        printf("  Path of %d values\n", ItemQty);
+        printf("    Search from the root : %.3f ms\n", 1e-3 * (double)(midTimeUs - startTimeUs));
+        printf("    Parent index         : %.3f ms\n", 1e-3 * (double)(endTimeUs - midTimeUs));
+    }
+
+    TEST_CASE("1-Sanity   : Document and sub-tree cloning")
+    {
+        const char* text = R"END(
+# Header comment
+name: app  # Inline comment
+services:
+  web:
+    image: nginx
+    ports:
+      - 80
+      - 443
+  db:
+    image: postgres
+removed: x
+)END";
+        Document    root = parse(text);
+        root.remove("removed");
+        root["services"].remove("web");  // Hole in the map
+        root["services"]["web"] = "re-added";
+        root["large"]           = NodeType::SEQUENCE;
+        for (int i = 0; i < 20000; ++i) { root["large"].push_back(i); }
+        root["large"].insert(100, -1);  // Chunked storage
+
+        // Whole document
+        Document copy = root.clone();
+        CHECK(std::string(copy.asYaml().c_str()) == std::string(root.asYaml().c_str()));
+        copy["services"]["db"]["image"] = "mysql";
+        copy["services"]["cache"]       = "redis";
+        copy["large"].remove(0);
+        CHECK(root["services"]["db"]["image"].as<std::string>() == "postgres");
+        CHECK(!root["services"].hasKey("cache"));
+        CHECK(root["large"].size() == 20001);
+        CHECK(copy["large"].size() == 20000);
+        CHECK(copy["large"][99].as<int>() == -1);
+
+        Document empty;
+        Document emptyCopy = empty.clone();
+        emptyCopy           = NodeType::SEQUENCE;
+        CHECK(emptyCopy.size() == 0);
+        Document sequence;
+        sequence = NodeType::SEQUENCE;
+        sequence.push_back("a");
+        CHECK(sequence.clone()[0].as<std::string>() == "a");
+
+        // Sub-tree into another document
+        Document other = parse("existing: 1\n");
+        root["services"].cloneInto(other["services"]);
+        root["name"].cloneInto(other["existing"]);
+        other["services"]["db"]["port"] = 5432;
+        CHECK(other["services"]["db"]["image"].as<std::string>() == "postgres");
+        CHECK(!root["services"]["db"].hasKey("port"));
+        CHECK(std::string(other.asYaml().c_str()) ==
+              "existing: app\nservices:\n  db:\n    image: postgres\n    port: 5432\n  web: re-added");
+
+        // Sub-tree inside the same document, also into itself, and into an empty document
+        root["services"].cloneInto(root["services"]["db"]["backup"]);
+        CHECK(root.findPath("services.db.backup.db.image").as<std::string>() == "postgres");
+        CHECK(!root.findPath("services.db.backup.db.backup"));
+        root["services"]["db"].cloneInto(root["services"]);
+        CHECK(root.findPath("services.backup.web").as<std::string>() == "re-added");
+        CHECK(root.findPath("services.backup.db.image").path() == "services.backup.db.image");
+        Document target;
+        root["services"].cloneInto(target);
+        CHECK(target["image"].as<std::string>() == "postgres");
+        CHECK_THROWS_AS(root.find("absent").cloneInto(target["image"]), AccessException);
+        CHECK_THROWS_AS(root["name"].cloneInto(Node()), AccessException);
+    }
+
+    TEST_CASE("2-Benchmark: Document cloning")
+    {
+        constexpr int ItemQty = 100000;
+        Document      root;
+        root = NodeType::MAP;
+        for (int i = 0; i < ItemQty; ++i) {
+            std::string key = "item" + std::to_string(i);
+            root[key]       = NodeType::MAP;
+            Node item       = root[key];
+            item["name"]    = key;
+            item["value"]   = i;
+        }
+
+        // Copy through the public API
+        std::function<void(Node, Node)> copyNode = [&copyNode](Node src, Node dst) {
+            for (Node child : src) {
+                if (child.value().isMap()) {
+                    dst[child.keyName()] = NodeType::MAP;
+                    copyNode(child.value(), dst[child.keyName()]);
+                } else {
+                    dst[child.keyName()] = child.value().as<std::string>();
+                }
+            }
+        };
+        uint64_t startTimeUs = getTime();
+        Document copied;
+        copied = NodeType::MAP;
+        copyNode(root, copied);
+        uint64_t midTimeUs = getTime();
+        Document cloned    = root.clone();
+        uint64_t cloneTimeUs = getTime();
+        Document subCloned;
+        root.cloneInto(subCloned);
+        uint64_t endTimeUs = getTime();
+        CHECK(cloned["item777"]["value"].as<int>() == 777);
+        CHECK(subCloned["item777"]["value"].as<int>() == 777);
+        CHECK(std::string(copied.asYaml().c_str()) == std::string(cloned.asYaml().c_str()));
+
+        printf("  Copy of a document with %d maps\n", ItemQty);
+        printf("    Public API copy : %.3f ms\n", 1e-3 * (double)(midTimeUs - startTimeUs));
+        printf("    Document clone  : %.3f ms\n", 1e-3 * (double)(cloneTimeUs - midTimeUs));
+        printf("    Sub-tree clone  : %.3f ms\n", 1e-3 * (double)(endTimeUs - cloneTimeUs));
+    }
+
+    TEST_CASE("1-Sanity   : Document snapshots")
+    {
+        const char* text = R"END(
+# Header comment
+name: app
+services:
+  web:
+    image: nginx
+    ports:
+      - 80
+      - 443
+  db:
+    image: postgres
+)END";
+        Document    root = parse(text);
+        root["large"]    = NodeType::SEQUENCE;
+        for (int i = 0; i < 20000; ++i) { root["large"].push_back(i); }  // Several storage pages
+        std::string initialYaml = root.asYaml().c_str();
+
+        // The snapshot is not impacted by the modifications of the document
+        std::shared_ptr<const Document> first = root.snapshot();
+        CHECK(std::string(first->asYaml().c_str()) == initialYaml);
+        root["services"]["db"]["image"] = "mysql";
+        root["services"]["cache"]       = "redis";
+        root["services"].remove("web");
+        root["large"][19999] = -1;
+        root["large"].insert(100, -2);  // Chunked storage
+        root["large"].push_back(20000);
+        for (int i = 0; i < 10000; ++i) { root["extra" + std::to_string(i)] = i; }  // Index growth
+        CHECK(std::string(first->asYaml().c_str()) == initialYaml);
+        CHECK((*first)["services"]["db"]["image"].as<std::string>() == "postgres");
+        CHECK(!(*first)["services"].hasKey("cache"));
+        CHECK((*first)["services"]["web"]["ports"][1].as<int>() == 443);
+        CHECK((*first)["large"].size() == 20000);
+        CHECK((*first)["large"][19999].as<int>() == 19999);
+        CHECK(first->findPath("services.web.image").as<std::string>() == "nginx");
+        CHECK(!first->find("extra0"));
+
+        // Several versions, independent of the document lifetime
+        std::shared_ptr<const Document> second = root.snapshot();
+        root["name"]                           = "renamed";
+        std::string secondYaml                 = second->asYaml().c_str();
+        root                                   = Document();
+        CHECK((*first)["name"].as<std::string>() == "app");
+        CHECK((*second)["name"].as<std::string>() == "app");
+        CHECK((*second)["services"]["db"]["image"].as<std::string>() == "mysql");
+        CHECK((*second)["large"][100].as<int>() == -2);
+        CHECK((*second)["extra9999"].as<int>() == 9999);
+        CHECK((*second)["large"][19999].path() == "large[19999]");
+        CHECK(std::string(second->asYaml().c_str()) == secondYaml);
+        first.reset();
+        CHECK(std::string(second->asYaml().c_str()) == secondYaml);
+
+        // The document can still be modified after releasing its snapshots, and cloned from a snapshot
+        Document writer = parse("a: 1\nb:\n  - x\n");
+        writer.enableTypedValueCache();
+        CHECK(writer["a"].as<int>() == 1);
+        std::shared_ptr<const Document> view = writer.snapshot();
+        writer["a"]                          = 2;
+        CHECK(writer["a"].as<int>() == 2);
+        CHECK((*view)["a"].as<int>() == 1);
+        Document copy = view->clone();
+        copy["b"].push_back("y");
+        CHECK(copy["b"].size() == 2);
+        CHECK((*view)["b"].size() == 1);
+        view.reset();
+        writer["b"].push_back("z");
+        CHECK(std::string(writer.asYaml().c_str()) == "a: 2\nb:\n  - x\n  - z");
+
+        // A snapshot is read-only: writing through it throws, and neither the snapshot nor the document are changed
+        Document                        source     = parse("a: 1\nlist:\n  - x\n");
+        std::shared_ptr<const Document> frozen     = source.snapshot();
+        Node                            frozenRoot = *frozen;
+        Node                            frozenA    = (*frozen)["a"];
+        CHECK_THROWS_AS(frozenA = "x", AccessException);
+        CHECK_THROWS_AS(frozenRoot["b"] = 2, AccessException);
+        CHECK_THROWS_AS(frozenRoot["c"] = NodeType::MAP, AccessException);
+        CHECK_THROWS_AS(frozenRoot["list"].push_back("y"), AccessException);
+        CHECK_THROWS_AS(frozenRoot.remove("a"), AccessException);
+        CHECK_THROWS_AS(frozenRoot.parseInto("z: 0\n"), AccessException);
+        bool isAddingRejected = true;
+        for (int i = 0; i < 5000; ++i) {
+            try {
+                frozenRoot["key" + std::to_string(i)] = i;
+                isAddingRejected                      = false;
+            } catch (AccessException&) {
+            }
+        }
+        CHECK(isAddingRejected);
+        CHECK(std::string(frozen->asYaml().c_str()) == "a: 1\nlist:\n  - x");
+        CHECK(std::string(source.asYaml().c_str()) == "a: 1\nlist:\n  - x");
+        source["a"] = 3;
+        CHECK(source["a"].as<int>() == 3);
+        CHECK((*frozen)["a"].as<int>() == 1);
+
+        // The parent index of a snapshot is built once, whatever the quantity of concurrent readers
+        Document wide;
+        wide          = NodeType::MAP;
+        wide["large"] = NodeType::SEQUENCE;
+        for (int i = 0; i < 20000; ++i) { wide["large"].push_back(i); }
+        std::shared_ptr<const Document> shared = wide.snapshot();
+        std::atomic<int>                mismatchQty{0};
+        std::vector<std::thread>        readers;
+        for (int i = 0; i < 4; ++i) {
+            readers.emplace_back([&shared, &mismatchQty, i]() {
+                for (int j = i; j < 20000; j += 97) {
+                    Node item = (*shared)["large"][j];
+                    if (item.parent().size() != 20000 || item.path() != "large[" + std::to_string(j) + "]") { ++mismatchQty; }
+                }
+            });
+        }
+        for (std::thread& reader : readers) { reader.join(); }
+        CHECK(mismatchQty.load() == 0);
+
+        // Empty document
+        Document                        empty;
+        std::shared_ptr<const Document> emptyView = empty.snapshot();
+        empty                                     = NodeType::MAP;
+        empty["key"]                              = "value";
+        CHECK(std::string(emptyView->asYaml().c_str()).empty());
+        CHECK(empty["key"].as<std::string>() == "value");
+    }
+
+    TEST_CASE("2-Benchmark: Document snapshots")
+    {
+        constexpr int ItemQty    = 100000;
+        constexpr int VersionQty = 1000;
+        Document      root;
+        root = NodeType::MAP;
+        for (int i = 0; i < ItemQty; ++i) {
+            std::string key = "item" + std::to_string(i);
+            root[key]       = NodeType::MAP;
+            Node item       = root[key];
+            item["name"]    = key;
+            item["value"]   = i;
+        }
+
+        // Each version modifies a few values and is published, as a clone or as a snapshot
+        uint64_t startTimeUs = getTime();
+        for (int version = 0; version < VersionQty / 100; ++version) {
+            root["item" + std::to_string(version * 97)]["value"] = -version;
+            Document published                                    = root.clone();
+            CHECK(published["item0"]["value"].as<int>() == 0);
+        }
+        uint64_t                        midTimeUs = getTime();
+        std::shared_ptr<const Document> published;
+        for (int version = 0; version < VersionQty; ++version) {
+            root["item" + std::to_string(version * 97)]["value"] = -version;
+            published                                            = root.snapshot();
+        }
+        uint64_t endTimeUs = getTime();
+        CHECK((*published)["item" + std::to_string(97 * (VersionQty - 1))]["value"].as<int>() == 1 - VersionQty);
+
+        printf("  Publication of a new version of a document with %d maps\n", ItemQty);
+        printf("    Clone    : %.3f ms\n", 1e-3 * (double)(midTimeUs - startTimeUs) / (VersionQty / 100));
+        printf("    Snapshot : %.3f ms\n", 1e-3 * (double)(endTimeUs - midTimeUs) / VersionQty);
+    }
+
+    TEST_CASE("1-Sanity   : Shared document")
+    {
+        SharedDocument shared(parse("version: 0\ncopy: 0\nitems:\n  - a\n  - b\n"));
+        {
+            SharedDocument::Reader reader = shared.read();
+            CHECK((*reader)["version"].as<int>() == 0);
+            CHECK((*reader)["items"][1].path() == "items[1]");
+            CHECK(reader->findPath("items[0]").as<std::string>() == "a");
+        }
+
+        // The published versions are read-only
+        {
+            SharedDocument::Reader reader = shared.read();
+            Node                   node   = (*reader)["version"];
+            Node                   root   = *reader;
+            CHECK_THROWS_AS(node = 5, AccessException);
+            CHECK_THROWS_AS(root["added"] = 1, AccessException);
+            CHECK_THROWS_AS(root["items"].push_back("c"), AccessException);
+            CHECK((*reader)["version"].as<int>() == 0);
+            CHECK(!reader->hasKey("added"));
+            CHECK((*reader)["items"].size() == 2);
+        }
+
+        // A loaded version outlives its replacement
+        std::shared_ptr<const Document> previous = shared.load();
+        shared.publish(parse("version: 1\ncopy: 1\n"));
+        CHECK((*previous)["version"].as<int>() == 0);
+        CHECK((*shared.read())["version"].as<int>() == 1);
+        previous.reset();
+
+        // Snapshots of a document which keeps being modified
+        Document writer = parse("version: 2\ncopy: 2\nnested:\n  key: value\n");
+        shared.publishSnapshot(writer);
+        writer["version"] = 3;
+        writer["copy"]    = 3;
+        CHECK((*shared.read())["version"].as<int>() == 2);
+        CHECK((*shared.read())["nested"]["key"].parent().path() == "nested");
+        shared.publishSnapshot(writer);
+        CHECK((*shared.read())["copy"].as<int>() == 3);
+
+        // Concurrent readers always see a consistent version, while versions are published
+        constexpr int            ReaderQty = 3;
+        std::atomic<bool>        isDone{false};
+        std::atomic<int>         inconsistencyQty{0};
+        std::vector<std::thread> readers;
+        for (int i = 0; i < ReaderQty; ++i) {
+            readers.emplace_back([&shared, &isDone, &inconsistencyQty]() {
+                int lastVersion = 0;
+                while (!isDone.load()) {
+                    SharedDocument::Reader reader  = shared.read();
+                    int                    version = (*reader)["version"].as<int>();
+                    if (version != (*reader)["copy"].as<int>() || version < lastVersion) { ++inconsistencyQty; }
+                    lastVersion = version;
+                }
+            });
+        }
+        for (int version = 4; version < 400; ++version) {
+            if (version % 2) {
+                shared.publish(parse("version: " + std::to_string(version) + "\ncopy: " + std::to_string(version) + "\n"));
+            } else {
+                writer["version"] = version;
+                writer["copy"]    = version;
+                shared.publishSnapshot(writer);
+            }
+            std::this_thread::yield();
+        }
+        isDone.store(true);
+        for (std::thread& reader : readers) { reader.join(); }
+        CHECK(inconsistencyQty.load() == 0);
+        CHECK((*shared.read())["version"].as<int>() == 399);
+    }
+
+    TEST_CASE("2-Benchmark: Shared document")
+    {
+        constexpr int KeyQty    = 10000;
+        constexpr int LookupQty = 2000000;
+        Document      root;
+        root = NodeType::MAP;
+        std::vector<std::string> keys(KeyQty);
+        for (int i = 0; i < KeyQty; ++i) {
+            keys[i]       = "key" + std::to_string(i);
+            root[keys[i]] = i;
+        }
+        Document       copy = root.clone();
+        SharedDocument shared(std::move(copy));
+
+        // Same lookups on the document and through a read section each
+        int64_t  sum         = 0;
+        uint64_t startTimeUs = getTime();
+        for (int i = 0; i < LookupQty; ++i) { sum += root[keys[i % KeyQty]].as<int>(); }
+        uint64_t midTimeUs = getTime();
+        for (int i = 0; i < LookupQty; ++i) { sum -= (*shared.read())[keys[i % KeyQty]].as<int>(); }
+        uint64_t endTimeUs = getTime();
+        CHECK(sum == 0);
+
+        // Publication of a snapshot, which includes the grace period
+        constexpr int VersionQty       = 1000;
+        uint64_t      publishStartTime = getTime();
+        for (int version = 0; version < VersionQty; ++version) {
+            root[keys[version % KeyQty]] = -version;
+            shared.publishSnapshot(root);
+        }
+        uint64_t publishEndTime = getTime();
+        CHECK((*shared.read())[keys[VersionQty - 1]].as<int>() == 1 - VersionQty);
+
+        printf("  Lookup in a map of %d keys\n", KeyQty);
+        printf("    Document        : %.1f ns\n", 1e3 * (double)(midTimeUs - startTimeUs) / LookupQty);
+        printf("    Shared document : %.1f ns\n", 1e3 * (double)(endTimeUs - midTimeUs) / LookupQty);
+        printf("  Publication of a snapshot: %.1f us\n", (double)(publishEndTime - publishStartTime) / VersionQty);
+    }
+
+    TEST_CASE("1-Sanity   : Subtree grafting")
+    {
+        const char* text = R"END(
+# Service list
+services:
+  web:
+    image: nginx  # Front
+    ports:
+      - 80
+      - 443
+  db:
+    image: postgres
+)END";
+        Document response = parse("status: ok\n");
+
+        // Copy of a sub-tree, the source is unchanged
+        Document source = parse(text);
+        Node     web    = response.graft("web", source["services"]["web"]);
+        CHECK(web["image"].as<std::string>() == "nginx");
+        CHECK(response["web"]["ports"][1].as<int>() == 443);
+        CHECK(source["services"]["web"]["ports"].size() == 2);
+        response["web"]["image"] = "httpd";
+        CHECK(source["services"]["web"]["image"].as<std::string>() == "nginx");
+
+        // Move of a whole document, with comments, holes in a map and a chunked sequence
+        Document moved = parse(text);
+        moved["services"].remove("db");
+        moved["services"]["cache"] = "redis";
+        moved["large"]             = NodeType::SEQUENCE;
+        for (int i = 0; i < 5000; ++i) { moved["large"].push_back(i); }
+        moved["large"].insert(10, -1);
+        std::string movedYaml = moved.asYaml().c_str();
+        Node        all       = response.graft("all", std::move(moved));
+        CHECK(all["services"]["cache"].as<std::string>() == "redis");
+        CHECK(!all["services"].hasKey("db"));
+        CHECK(all["large"][10].as<int>() == -1);
+        CHECK(all["large"][4999].as<int>() == 4998);
+        CHECK(all["large"][20].path() == "all.large[20]");
+        CHECK(std::string(moved.asYaml().c_str()).empty());
+        Document check = parse(std::string(response.asYaml().c_str()));
+        Document extracted;
+        check["all"].cloneInto(extracted);
+        CHECK(std::string(extracted.asYaml().c_str()) == movedYaml.substr(movedYaml.find('\n') + 1));  // Without the header comment
+        CHECK(std::string(response.asYaml().c_str()).find("# Front") != std::string::npos);
+
+        // The moved document can be used again, and the grafted keys modified
+        moved                  = NodeType::MAP;
+        moved["key"]           = "value";
+        all["services"]["new"] = "key";
+        all["services"].remove("web");
+        CHECK(response["all"]["services"].size() == 2);
+
+        // Replacement of an existing key, snapshot of the source still alive, empty document
+        Document                        replacement = parse("a: 1\nb:\n  - x\n  - y\n");
+        std::shared_ptr<const Document> view        = replacement.snapshot();
+        response.graft("web", std::move(replacement));
+        CHECK(response["web"]["b"][1].as<std::string>() == "y");
+        CHECK((*view)["b"][0].as<std::string>() == "x");
+        response.graft("empty", Document());
+        CHECK(response["empty"].isValue());
+
+        // Move of a document built programmatically, whose root is not under a key
+        Document built;
+        built         = NodeType::MAP;
+        built["a"]    = 1;
+        built["list"] = NodeType::SEQUENCE;
+        built["list"].push_back("x");
+        Node builtGraft = response.graft("built", std::move(built));
+        CHECK(builtGraft.isMap());
+        CHECK(builtGraft["a"].as<int>() == 1);
+        CHECK(response["built"]["list"][0].as<std::string>() == "x");
+        CHECK(response["built"]["list"].path() == "built.list");
+        Document builtSequence;
+        builtSequence = NodeType::SEQUENCE;
+        builtSequence.push_back(2);
+        response.graft("sequence", std::move(builtSequence));
+        CHECK(response["sequence"][0].as<int>() == 2);
+        CHECK(response["status"].as<std::string>() == "ok");
+
+        // Errors
+        Document other = parse("- a\n");
+        CHECK_THROWS_AS(other.graft("key", source), AccessException);
+        CHECK_THROWS_AS(response.graft("", source), AccessException);
+    }
+
+    TEST_CASE("2-Benchmark: Subtree grafting")
+    {
+        constexpr int PieceQty = 100;
+        constexpr int ItemQty  = 1000;
+        std::string   text;
+        for (int i = 0; i < ItemQty; ++i) { text += "item" + std::to_string(i) + ":\n  name: piece\n  value: " + std::to_string(i) + "\n"; }
+        std::vector<Document> pieces;
+        for (int i = 0; i < PieceQty; ++i) { pieces.push_back(parse(text)); }
+
+        // Assembly of a response from the pieces, by re-parsing their YAML, by copy and by move
+        uint64_t startTimeUs = getTime();
+        Document reparsed    = parse("status: ok\n");
+        for (int i = 0; i < PieceQty; ++i) { reparsed["piece" + std::to_string(i)].parseInto(pieces[i].asYaml().c_str()); }
+        uint64_t reparseTimeUs = getTime();
+        Document copied        = parse("status: ok\n");
+        for (int i = 0; i < PieceQty; ++i) { copied.graft("piece" + std::to_string(i), pieces[i]); }
+        uint64_t copyTimeUs = getTime();
+        Document moved      = parse("status: ok\n");
+        for (int i = 0; i < PieceQty; ++i) { moved.graft("piece" + std::to_string(i), std::move(pieces[i])); }
+        uint64_t endTimeUs = getTime();
+        CHECK(reparsed["piece99"]["item999"]["value"].as<int>() == 999);
+        CHECK(copied["piece99"]["item999"]["value"].as<int>() == 999);
+        CHECK(moved["piece99"]["item999"]["value"].as<int>() == 999);
+
+        printf("  Assembly of %d documents of %d maps\n", PieceQty, ItemQty);
+        printf("    Re-parsing : %.3f ms\n", 1e-3 * (double)(reparseTimeUs - startTimeUs));
+        printf("    Graft copy : %.3f ms\n", 1e-3 * (double)(copyTimeUs - reparseTimeUs));
+        printf("    Graft move : %.3f ms\n", 1e-3 * (double)(endTimeUs - copyTimeUs));
+    }
+
+    TEST_CASE("1-Sanity   : Document merge")
+    {
+        const char* defaults = R"END(
+name: app
+server:
+  host: localhost
+  port: 8080
+  tls:
+    enabled: false
+plugins:
+  - auth
+  - log
+)END";
+        const char* environment = R"END(
+server:
+  port: 9090
+  tls:
+    enabled: true
+    cert: /etc/cert.pem  # Production certificate
+plugins:
+  - metrics
+replicas: 3
+)END";
+
+        // Maps merged key by key, sequences replaced, new keys appended in order
+        Document config = parse(defaults);
+        config.merge(parse(environment));
+        CHECK(config["name"].as<std::string>() == "app");
+        CHECK(config["server"]["host"].as<std::string>() == "localhost");
+        CHECK(config["server"]["port"].as<int>() == 9090);
+        CHECK(config["server"]["tls"]["enabled"].as<std::string>() == "true");
+        CHECK(config["server"]["tls"]["cert"].as<std::string>() == "/etc/cert.pem");
+        CHECK(config["plugins"].size() == 1);
+        CHECK(config["plugins"][0].as<std::string>() == "metrics");
+        CHECK(config["replicas"].as<int>() == 3);
+        CHECK(config["replicas"].path() == "replicas");
+        CHECK(std::string(config.asYaml().c_str()) == R"END(name: app
+server:
+  host: localhost
+  port: 9090
+  tls:
+    enabled: true
+    cert: /etc/cert.pem # Production certificate
+plugins:
+  - metrics
+replicas: 3)END");
+
+        // Appended sequences, merge of a sub-tree, typed value cache kept consistent
+        Document appended = parse(defaults);
+        appended.enableTypedValueCache();
+        CHECK(appended["server"]["port"].as<int>() == 8080);
+        Document overlay = parse(environment);
+        appended.merge(overlay, MergePolicy::AppendSequences);
+        CHECK(appended["server"]["port"].as<int>() == 9090);
+        CHECK(appended["plugins"].size() == 3);
+        CHECK(appended["plugins"][2].as<std::string>() == "metrics");
+        Document layers = parse("host:\n  server:\n    host: example.com\n");
+        appended.merge(layers["host"]);  // Overlay sub-tree, applied at the document root
+        CHECK(appended["server"]["host"].as<std::string>() == "example.com");
+        CHECK(appended["server"]["port"].as<int>() == 9090);
+        CHECK(!appended.hasKey("host"));
+
+        // Type changes replace the item, the merged document stays editable
+        Document changed = parse(defaults);
+        changed.merge(parse("server: none\nplugins:\n  auth: true\n"));
+        CHECK(changed["server"].as<std::string>() == "none");
+        CHECK(changed["plugins"]["auth"].as<std::string>() == "true");
+        changed["plugins"]["extra"] = 1;
+        changed["plugins"].remove("auth");
+        CHECK(changed["plugins"].size() == 1);
+        CHECK(overlay["server"]["port"].as<int>() == 9090);  // The overlay is unchanged
+
+        // Overlay from the same document, empty documents
+        Document self = parse("base:\n  a: 1\n  b: 2\nlayer:\n  base:\n    b: 3\n");
+        self.merge(self["layer"]);
+        CHECK(self["base"]["a"].as<int>() == 1);
+        CHECK(self["base"]["b"].as<int>() == 3);
+        Document empty;
+        empty.merge(parse(defaults));
+        CHECK(empty["server"]["port"].as<int>() == 8080);
+        empty.merge(Document());
+        CHECK(empty["name"].as<std::string>() == "app");
+        CHECK_THROWS_AS(empty.merge(Node()), AccessException);
+    }
+
+    TEST_CASE("2-Benchmark: Document merge")
+    {
+        constexpr int SectionQty = 200;
+        constexpr int KeyQty     = 50;
+        constexpr int LayerQty   = 20;
+        std::string   base, layer;
+        for (int i = 0; i < SectionQty; ++i) {
+            base += "section" + std::to_string(i) + ":\n";
+            layer += "section" + std::to_string(i) + ":\n";
+            for (int j = 0; j < KeyQty; ++j) {
+                base += "  key" + std::to_string(j) + ": " + std::to_string(j) + "\n";
+                if (j % 5 == 0) { layer += "  key" + std::to_string(j) + ": " + std::to_string(-j) + "\n"; }
+                if (j % 10 == 0) { layer += "  new" + std::to_string(j) + ": " + std::to_string(j) + "\n"; }
+            }
+        }
+        Document              overlay = parse(layer);
+        std::vector<Document> configs;
+        for (int l = 0; l < 2 * LayerQty; ++l) { configs.push_back(parse(base)); }
+
+        // Merge through the public API (lookup, insertion or assignment per key) versus the lockstep merge
+        uint64_t startTimeUs = getTime();
+        for (int l = 0; l < LayerQty; ++l) {
+            Document& config = configs[l];
+            for (Node section : overlay) {
+                Node target = config[section.keyName()];
+                for (Node item : section.value()) {
+                    std::string key = item.keyName();
+                    if (target.hasKey(key)) {
+                        target[key] = item.value().as<std::string>();
+                    } else {
+                        target.insert(key, item.value().as<std::string>());
+                    }
+                }
+            }
+            CHECK(config["section0"]["key5"].as<int>() == -5);
+        }
+        uint64_t midTimeUs = getTime();
+        for (int l = LayerQty; l < 2 * LayerQty; ++l) {
+            Document& config = configs[l];
+            config.merge(overlay);
+            CHECK(config["section0"]["key5"].as<int>() == -5);
+        }
+        uint64_t endTimeUs = getTime();
+
+        printf("  Merge of a layer with %d sections of %d keys\n", SectionQty, KeyQty);
+        printf("    Public API : %.3f ms\n", 1e-3 * (double)(midTimeUs - startTimeUs) / LayerQty);
+        printf("    Merge      : %.3f ms\n", 1e-3 * (double)(endTimeUs - midTimeUs) / LayerQty);
+    }
+
+    TEST_CASE("1-Sanity   : Layered view")
+    {
+        Document base        = parse("name: app\nserver:\n  host: localhost\n  port: 8080\n  tls:\n    enabled: false\n"
+                                     "plugins:\n  - auth\n  - log\n");
+        Document environment = parse("server:\n  port: 9090\n  tls:\n    enabled: true\n    cert: /etc/cert.pem\n"
+                                     "plugins:\n  - metrics\nreplicas: 3\n");
+        Document request     = parse("server:\n  port: 7000\n# Comment\nuser: alice\n");
+
+        // Keys resolved from the top layer, maps combined, sequences replaced
+        LayeredView view{base, environment, request};
+        CHECK(view["server"]["port"].as<int>() == 7000);
+        CHECK(view["server"]["host"].as<std::string>() == "localhost");
+        CHECK(view["server"]["tls"]["enabled"].as<std::string>() == "true");
+        CHECK(view["server"]["tls"]["cert"].as<std::string>() == "/etc/cert.pem");
+        CHECK(view["plugins"].size() == 1);
+        CHECK(view["plugins"][0].as<std::string>() == "metrics");
+        CHECK(!view["plugins"][1]);
+        CHECK(view["user"].as<std::string>() == "alice");
+        CHECK(view["server"]["port"].node().path() == "server.port");
+        CHECK(view["server"].type() == MAP);
+
+        // Absent items
+        CHECK(!view["missing"]);
+        CHECK(!view["missing"]["deeper"]);
+        CHECK(!view["name"]["deeper"]);
+        CHECK(view["missing"].as<int>(5) == 5);
+        CHECK_THROWS_AS(view["missing"].as<int>(), AccessException);
+        CHECK_THROWS_AS(view["name"].size(), AccessException);
+
+        // Iteration in the order of the lowest layer defining the keys
+        std::vector<std::string> keys;
+        for (LayeredView::Item item : view.root()) { keys.push_back(item.keyName()); }
+        CHECK(keys == std::vector<std::string>{"name", "server", "plugins", "replicas", "user"});
+        keys.clear();
+        for (LayeredView::Item item : view["server"]) { keys.push_back(item.keyName()); }
+        CHECK(keys == std::vector<std::string>{"host", "port", "tls"});
+        CHECK(view["server"]["tls"].size() == 2);
+
+        // Same content as the materialized merge
+        Document merged = base.clone();
+        merged.merge(environment);
+        merged.merge(request);
+        std::function<void(LayeredView::Item, Node)> compare = [&compare](LayeredView::Item item, Node node) {
+            REQUIRE(item.type() == node.type());
+            if (node.isMap()) {
+                CHECK(item.size() == node.size());
+                for (Node child : node) {
+                    if (child.isKey()) { compare(item[child.keyName()], child.value()); }
+                }
+            } else if (node.isSequence()) {
+                CHECK(item.size() == node.size());
+                for (uint32_t i = 0; i < node.size(); ++i) { compare(item[i], node[i]); }
+            } else {
+                CHECK(item.as<std::string>() == node.as<std::string>());
+            }
+        };
+        compare(view.root(), merged);
+
+        // A non-map item hides the lower layers, sub-trees and empty documents as layers
+        Document    overrides = parse("host:\n  server: none\n");
+        Document    empty;
+        LayeredView hidden{base, overrides["host"], empty};
+        CHECK(hidden["server"].as<std::string>() == "none");
+        CHECK(!hidden["server"]["port"]);
+        CHECK(hidden["name"].as<std::string>() == "app");
+        CHECK(!hidden["host"]);
+        LayeredView single{base};
+        CHECK(single["server"]["port"].as<int>() == 8080);
+
+        // A comment leading a sequence item is not a child
+        Document    commented = parse("plugins:\n  -\n    # c\n    name: auth\n  - name: log\n");
+        LayeredView withComment{base, commented};
+        CHECK(withComment["plugins"].size() == 2);
+        CHECK(withComment["plugins"][1]["name"].as<std::string>() == "log");
+        keys.clear();
+        for (LayeredView::Item item : withComment["plugins"]) { keys.push_back(item["name"].as<std::string>()); }
+        CHECK(keys == std::vector<std::string>{"auth", "log"});
+    }
+
+    TEST_CASE("2-Benchmark: Layered view")
+    {
+        constexpr int SectionQty = 200;
+        constexpr int KeyQty     = 50;
+        constexpr int RequestQty = 200;
+        std::string   text;
+        for (int i = 0; i < SectionQty; ++i) {
+            text += "section" + std::to_string(i) + ":\n";
+            for (int j = 0; j < KeyQty; ++j) { text += "  key" + std::to_string(j) + ": " + std::to_string(j) + "\n"; }
+        }
+        Document shared    = parse(text);
+        Document overrides = parse("section7:\n  key3: -3\n");
+
+        // Per-request configuration with a few lookups, materialized with a merge or as a layered view
+        int64_t  sum         = 0;
+        uint64_t startTimeUs = getTime();
+        for (int r = 0; r < RequestQty; ++r) {
+            Document config = shared.clone();
+            config.merge(overrides);
+            for (int i = 0; i < 10; ++i) { sum += config["section7"]["key" + std::to_string(i)].as<int>(); }
+        }
+        uint64_t midTimeUs = getTime();
+        for (int r = 0; r < RequestQty; ++r) {
+            LayeredView config{shared, overrides};
+            for (int i = 0; i < 10; ++i) { sum -= config["section7"]["key" + std::to_string(i)].as<int>(); }
+        }
+        uint64_t endTimeUs = getTime();
+        CHECK(sum == 0);
+
+        printf("  Request-scoped configuration over %d sections of %d keys, with 10 lookups\n", SectionQty, KeyQty);
+        printf("    Clone and merge : %.3f us\n", (double)(midTimeUs - startTimeUs) / RequestQty);
+        printf("    Layered view    : %.3f us\n", (double)(endTimeUs - midTimeUs) / RequestQty);
+    }
+
     TEST_CASE("2-Benchmark: Map access")
     {
         constexpr int MaxMapSize = 1000000;
@@ -211,6 +1754,71 @@ TEST_SUITE("Parsing")
                1e-3 * (double)(accessEndTimeUs - accessStartTimeUs));
     }
 
+    TEST_CASE("2-Benchmark: Map batch insertion")
+    {
+        constexpr int PatchSize = 50000;
+        constexpr int PassQty   = 20;
+
+        std::vector<std::string> keys(PatchSize);
+        for (int i = 0; i < PatchSize; ++i) { keys[i] = std::to_string(i); }
+
+        uint64_t directDurationUs = 0, batchDurationUs = 0;
+        for (int pass = 0; pass < PassQty; ++pass) {
+            Document direct;
+            direct             = NodeType::MAP;
+            uint64_t startTime = getTime();
+            for (int i = 0; i < PatchSize; ++i) { direct.insert(keys[i], i); }
+            directDurationUs += getTime() - startTime;
+
+            Document batched;
+            batched   = NodeType::MAP;
+            startTime = getTime();
+            auto tx   = batched.beginBatch();
+            for (int i = 0; i < PatchSize; ++i) { tx.insert(keys[i], i); }
+            tx.commit();
+            batchDurationUs += getTime() - startTime;
+            CHECK(batched.size() == direct.size());
+        }
+
+        printf("  Performance for the insertion of %d keys in a map\n", PatchSize);
+        printf("    Direct speed : %.3f Mitem/s\n", (double)(PassQty * PatchSize) / (double)std::max((uint64_t)1, directDurationUs));
+        printf("    Batch  speed : %.3f Mitem/s\n", (double)(PassQty * PatchSize) / (double)std::max((uint64_t)1, batchDurationUs));
+    }
+
+    TEST_CASE("2-Benchmark: Sequence middle edition")
+    {
+        constexpr int SequenceSize = 1000000;
+        constexpr int EditQty      = 100000;
+
+        Document root;
+        root = NodeType::SEQUENCE;
+        root.reserve(SequenceSize + EditQty);
+        for (int i = 0; i < SequenceSize; ++i) { root.push_back(i); }
+
+        // Front insertions and middle removals
+        uint64_t editStartTimeUs = getTime();
+        for (int i = 0; i < EditQty; ++i) {
+            root.insert(0, i);
+            root.remove((uint32_t)(testGetRandom() % root.size()));
+        }
+        uint64_t editEndTimeUs = getTime();
+
+        // Indexed access after edition
+        uint64_t accessStartTimeUs = getTime();
+        int64_t  dummyCount        = 0;
+        for (int i = 0; i < SequenceSize; ++i) { dummyCount += root[i].as<int>(); }
+        uint64_t accessEndTimeUs = getTime();
+
+        printf("  Performance for edits of a sequence of size %d\n", SequenceSize);
+        printf("    Edit   speed : %.3f Mitem/s (%.3f ms)\n",
+               (double)(2 * EditQty) / (double)std::max((uint64_t)1, editEndTimeUs - editStartTimeUs),
+               1e-3 * (double)(editEndTimeUs - editStartTimeUs));
+        printf("    Access speed : %.3f Mitem/s (%.3f ms)\n",
+               (double)SequenceSize / (double)std::max((uint64_t)1, accessEndTimeUs - accessStartTimeUs),
+               1e-3 * (double)(accessEndTimeUs - accessStartTimeUs));
+        CHECK(dummyCount != 0);
+    }
+
     TEST_CASE("2-Benchmark: Sequence access")
     {
         constexpr int MaxSequenceSize = 1000000;
@@ -245,4 +1853,133 @@ TEST_SUITE("Parsing")
                (double)MaxSequenceSize / (double)std::max((uint64_t)1, accessEndTimeUs - accessStartTimeUs),
                1e-3 * (double)(accessEndTimeUs - accessStartTimeUs));
     }
+    // Rebuilds a flow-like representation of the tree, to check the visit order
+    struct FlowVisitor : Visitor {
+        std::string text;
+        bool        enterMap(uint32_t keyQty)
+        {
+            text += "{" + std::to_string(keyQty) + ":";
+            return true;
+        }
+        void leaveMap() { text += "}"; }
+        bool enterSequence(uint32_t itemQty)
+        {
+            text += "[" + std::to_string(itemQty) + ":";
+            return true;
+        }
+        void leaveSequence() { text += "]"; }
+        bool enterKey(std::string_view key)
+        {
+            text += std::string(key) + "=";
+            return (key != "skipped");
+        }
+        void leaveKey(std::string_view /*key*/) { text += ","; }
+        void onValue(std::string_view value) { text += "'" + std::string(value) + "' "; }
+    };
+
+    // Counts the values and their total size
+    struct CountVisitor : Visitor {
+        uint64_t valueQty  = 0;
+        uint64_t valueSize = 0;
+        void     onValue(std::string_view value)
+        {
+            ++valueQty;
+            valueSize += value.size();
+        }
+    };
+
+    TEST_CASE("1-Sanity   : Tree walking")
+    {
+        const char* text = R"END(
+name: walker  # Comments are not visited, but counted in the map size
+empty:
+items:
+  - a
+  - - b
+    - c
+  - key: value
+skipped:
+  deep: value
+removed: x
+last:
+)END";
+        Document    root = parse(text);
+        root.remove("removed");  // Creates a hole in the map
+
+        FlowVisitor flow;
+        walk(root, flow);
+        CHECK(flow.text == "{6:name='walker' ,empty='' ,items=[3:'a' [2:'b' 'c' ]{1:key='value' ,}],skipped=,last='' ,}");
+
+        // Sub-trees and particular nodes
+        FlowVisitor subFlow;
+        walk(root["items"], subFlow);
+        CHECK(subFlow.text == "[3:'a' [2:'b' 'c' ]{1:key='value' ,}]");
+        FlowVisitor valueFlow;
+        walk(root["name"], valueFlow);
+        CHECK(valueFlow.text == "'walker' ");
+        FlowVisitor invalidFlow;
+        walk(root.find("absent"), invalidFlow);
+        walk(Document(), invalidFlow);
+        CHECK(invalidFlow.text.empty());
+
+        // Large sequence edited in its middle (chunked storage) with a reused walker
+        Document seq;
+        seq = NodeType::SEQUENCE;
+        for (int i = 0; i < 20000; ++i) { seq.push_back(i); }
+        for (int i = 0; i < 1000; ++i) { seq.insert(10000, i); }
+        seq.remove(5);
+        Walker       walker;
+        CountVisitor count;
+        walker.walk(seq, count);
+        CHECK(count.valueQty == 20999);
+        CountVisitor count2;
+        walker.walk(seq, count2);
+        CHECK(count2.valueSize == count.valueSize);
+        uint64_t expectedSize = 0;
+        for (Node item : seq) { expectedSize += item.as<std::string>().size(); }
+        CHECK(count.valueSize == expectedSize);
+    }
+
+    TEST_CASE("2-Benchmark: Tree walking")
+    {
+        constexpr int ItemQty = 200000;
+
+        Document root;
+        root = NodeType::SEQUENCE;
+        for (int i = 0; i < ItemQty; ++i) {
+            root.push_back(NodeType::MAP);
+            Node item     = root[i];
+            item["name"]  = "item" + std::to_string(i);
+            item["value"] = i;
+            item["tags"]  = NodeType::SEQUENCE;
+            item["tags"].push_back("a");
+            item["tags"].push_back("b");
+        }
+
+        // Recursive traversal with the Node API
+        std::function<void(Node, CountVisitor&)> visitNode = [&visitNode](Node node, CountVisitor& counter) {
+            if (node.isSequence()) {
+                for (Node child : node) { visitNode(child, counter); }
+            } else if (node.isMap()) {
+                for (Node child : node) { visitNode(child.value(), counter); }
+            } else {
+                counter.onValue(node.as<std::string>());
+            }
+        };
+
+        uint64_t     startTimeUs = getTime();
+        CountVisitor recursive;
+        visitNode(root, recursive);
+        uint64_t     midTimeUs = getTime();
+        CountVisitor walked;
+        walk(root, walked);
+        uint64_t endTimeUs = getTime();
+        CHECK(recursive.valueQty == walked.valueQty);
+        CHECK(recursive.valueSize == walked.valueSize);
+
+        double valueQty = (double)walked.valueQty;
+        printf("  Traversal of %d maps\n", ItemQty);
+        printf("    Recursive with Node : %.3f Mitem/s\n", valueQty / (double)std::max((uint64_t)1, midTimeUs - startTimeUs));
+        printf("    Walk                : %.3f Mitem/s\n", valueQty / (double)std::max((uint64_t)1, endTimeUs - midTimeUs));
+    }
 }
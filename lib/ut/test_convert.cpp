@@ -0,0 +1,569 @@
+// STYML - an efficient C++ single-header STrictYaML parser and emitter
+//
+// The MIT License (MIT)
+//
+// Copyright(c) 2023, Damien Feneyrou <dfeneyrou@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cmath>
+
+#include "test_main.h"
+
+using namespace styml;
+
+// Custom structure with an allocation-free encoder
+struct MyColor {
+    uint8_t r;
+    uint8_t g;
+    uint8_t b;
+};
+
+// Custom structure with a node level converter
+struct MyPoint {
+    int  x;
+    int  y;
+    bool operator==(const MyPoint& other) const { return x == other.x && y == other.y; }
+};
+
+namespace styml
+{
+template<>
+struct convert<MyColor> {
+    static void encodeTo(const MyColor& color, Writer& writer)
+    {
+        if (color.r == 0 && color.g == 0 && color.b == 0) { throwMessage<ConvertException>("Black is not a color"); }
+        writer.write("rgb(", 4);
+        convert<int>::encodeTo(color.r, writer);
+        writer.write(',');
+        convert<int>::encodeTo(color.g, writer);
+        writer.write(',');
+        convert<int>::encodeTo(color.b, writer);
+        writer.write(')');
+    }
+
+    static void decode(const char* strValue, MyColor& color)
+    {
+        int r = 0, g = 0, b = 0;
+        if (sscanf(strValue, "rgb(%d,%d,%d)", &r, &g, &b) != 3) {
+            throwMessage<ConvertException>("Cannot convert the following string into a MyColor structure: '%s'", strValue);
+        }
+        color = {(uint8_t)r, (uint8_t)g, (uint8_t)b};
+    }
+};
+
+template<>
+struct convert<MyPoint> {
+    static void encodeNode(const MyPoint& point, Node& node)
+    {
+        node      = NodeType::MAP;
+        node["x"] = point.x;
+        node["y"] = point.y;
+    }
+
+    static void decodeNode(const Node& node, MyPoint& point)
+    {
+        if (!node.isMap()) { throwMessage<ConvertException>("A map is expected for a MyPoint structure"); }
+        point = {node["x"].as<int>(), node["y"].as<int>()};
+    }
+};
+}  // namespace styml
+
+// Structures with bound fields
+struct MyService {
+    std::string              name;
+    int                      port  = 0;
+    double                   ratio = 0.;
+    std::vector<std::string> tags;
+    bool operator==(const MyService& o) const { return name == o.name && port == o.port && ratio == o.ratio && tags == o.tags; }
+};
+STYML_BIND(MyService, name, port, ratio, tags)
+
+struct MyCluster {
+    std::string            id;
+    std::vector<MyService> services;
+    MyPoint                origin{0, 0};
+};
+STYML_BIND(MyCluster, id, services, origin)
+
+TEST_SUITE("Convert")
+{
+    TEST_CASE("1-Sanity   : Integer conversions")
+    {
+        Document root;
+        root = NodeType::SEQUENCE;
+        root.push_back(-42);
+        root.push_back(INT64_MIN);
+        root.push_back(UINT64_MAX);
+        root.push_back("0x1F");
+        root.push_back("-010");
+        root.push_back("+7");
+
+        CHECK(root[0].as<std::string>() == "-42");
+        CHECK(root[0].as<int>() == -42);
+        CHECK(root[1].as<int64_t>() == INT64_MIN);
+        CHECK(root[2].as<uint64_t>() == UINT64_MAX);
+        CHECK(root[3].as<int>() == 31);
+        CHECK(root[4].as<int>() == -8);
+        CHECK(root[5].as<uint8_t>() == 7);
+
+        // Errors
+        root.push_back("12abc");
+        root.push_back("abc");
+        root.push_back("300");
+        CHECK_THROWS_AS(root[6].as<int>(), AccessException);
+        CHECK_THROWS_AS(root[7].as<int>(), AccessException);
+        CHECK_THROWS_AS(root[8].as<int8_t>(), AccessException);
+        CHECK_THROWS_AS(root[0].as<uint32_t>(), AccessException);
+        CHECK(root[8].as<int16_t>() == 300);
+    }
+
+    TEST_CASE("1-Sanity   : Floating point conversions")
+    {
+        Document root;
+        root = NodeType::SEQUENCE;
+        root.push_back(1e-9);
+        root.push_back(3.14159);
+        root.push_back(0.1f);
+        root.push_back("+2.5e3");
+
+        // Shortest representation, without loss of precision
+        CHECK(root[0].as<std::string>() == "1e-09");
+        CHECK(root[1].as<std::string>() == "3.14159");
+        CHECK(root[2].as<std::string>() == "0.1");
+        CHECK(root[0].as<double>() == 1e-9);
+        CHECK(root[2].as<float>() == 0.1f);
+        CHECK(root[3].as<double>() == 2500.);
+
+        // Exact round trip
+        for (int i = 0; i < 1000; ++i) {
+            double value = std::ldexp((double)testGetRandom(), -(int)(testGetRandom() % 128));
+            root[0]      = value;
+            CHECK(root[0].as<double>() == value);
+        }
+
+        // Errors
+        root.push_back("1.5.2");
+        root.push_back("1e999");
+        CHECK_THROWS_AS(root[4].as<double>(), AccessException);
+        CHECK_THROWS_AS(root[5].as<double>(), AccessException);
+    }
+
+    TEST_CASE("1-Sanity   : Typed value cache")
+    {
+        const char* document = R"END(
+int: 42
+float: 2.5
+text: abc
+)END";
+        Document    root     = parse(document);
+        root.enableTypedValueCache();
+
+        for (int pass = 0; pass < 2; ++pass) {
+            CHECK(root["int"].as<int>() == 42);
+            CHECK(root["int"].as<uint8_t>() == 42);
+            CHECK(root["float"].as<double>() == 2.5);
+            CHECK(root["float"].as<float>() == 2.5f);
+            CHECK(root["int"].as<double>() == 42.);
+            CHECK_THROWS_AS(root["text"].as<int>(), AccessException);
+            CHECK_THROWS_AS(root["float"].as<int>(), AccessException);
+        }
+
+        // Assignment invalidates the cached value
+        root["int"] = -7;
+        CHECK(root["int"].as<int>() == -7);
+        CHECK_THROWS_AS(root["int"].as<uint32_t>(), AccessException);
+        root["int"] = "not a number";
+        CHECK_THROWS_AS(root["int"].as<int>(), AccessException);
+
+        // Elements created after the cache are handled too
+        root["new"] = 1234;
+        CHECK(root["new"].as<int>() == 1234);
+        root["new"] = 4321;
+        CHECK(root["new"].as<int>() == 4321);
+    }
+
+    TEST_CASE("2-Benchmark: Typed value cache")
+    {
+        constexpr int MaxSequenceSize = 100000;
+        constexpr int ReadQty         = 10;
+
+        Document root;
+        root = NodeType::SEQUENCE;
+        for (int i = 0; i < MaxSequenceSize; ++i) { root.push_back(1e-3 * i); }
+
+        for (int pass = 0; pass < 2; ++pass) {
+            root.enableTypedValueCache(pass == 1);
+            uint64_t startTimeUs = testGetTimeUs();
+            double   sum         = 0.;
+            for (int r = 0; r < ReadQty; ++r) {
+                for (int i = 0; i < MaxSequenceSize; ++i) { sum += root[i].as<double>(); }
+            }
+            uint64_t endTimeUs = testGetTimeUs();
+            CHECK(sum > 0.);
+            printf("  Typed read of a sequence of size %d %s cache: %.3f Mitem/s\n", MaxSequenceSize, (pass == 1) ? "with" : "without",
+                   (double)(ReadQty * MaxSequenceSize) / (double)std::max((uint64_t)1, endTimeUs - startTimeUs));
+        }
+    }
+
+    TEST_CASE("1-Sanity   : Bulk sequence extraction")
+    {
+        const char* document = R"END(
+ints: [ 0, 12345678, -123456789012345678, 0x10, 99999999999999999999 ]
+numbers:
+  - 0
+  - 12345678
+  - -123456789012345678
+  - 0x10
+  - 2.5
+texts:
+  - a
+  -
+  - c
+)END";
+        Document    root     = parse(document);
+
+        std::vector<int64_t> ints;
+        CHECK_THROWS_AS(ints = root["numbers"].asVector<int64_t>(), AccessException);
+        root["numbers"].pop_back();
+        ints = root["numbers"].asVector<int64_t>();
+        CHECK(ints == std::vector<int64_t>{0, 12345678, -123456789012345678LL, 16});
+
+        double doubles[3] = {0., 0., 0.};
+        CHECK(root["numbers"].copyTo(doubles, 3) == 3);
+        CHECK(doubles[1] == 12345678.);
+        CHECK_THROWS_AS(root["numbers"].asVector<double>(), AccessException);  // Hexadecimal is for integers only
+
+        int32_t buffer[2] = {0, 0};
+        CHECK(root["numbers"].copyTo(buffer, 2) == 2);
+        CHECK(buffer[1] == 12345678);
+        CHECK_THROWS_AS(root["numbers"].copyTo(buffer, 3), AccessException);  // Out of range
+
+        std::vector<std::string> texts = root["texts"].asVector<std::string>();
+        CHECK(texts == std::vector<std::string>{"a", "", "c"});
+
+        CHECK_THROWS_AS(root["ints"].asVector<int>(), AccessException);  // Not a sequence (no flow style in StrictYAML)
+        root["ints"] = NodeType::SEQUENCE;
+        root["ints"].push_back(NodeType::MAP);
+        CHECK_THROWS_AS(root["ints"].asVector<int>(), AccessException);  // Not a value
+    }
+
+    TEST_CASE("2-Benchmark: Bulk sequence extraction")
+    {
+        constexpr int MaxSequenceSize = 1000000;
+
+        Document root;
+        root = NodeType::SEQUENCE;
+        for (int i = 0; i < MaxSequenceSize; ++i) { root.push_back((int64_t)(testGetRandom() % 10000000000ULL)); }
+
+        std::vector<int64_t> values1(MaxSequenceSize), values2(MaxSequenceSize);
+        uint64_t             startTimeUs = testGetTimeUs();
+        for (int i = 0; i < MaxSequenceSize; ++i) { values1[i] = root[i].as<int64_t>(); }
+        uint64_t midTimeUs = testGetTimeUs();
+        root.copyTo(values2.data(), values2.size());
+        uint64_t endTimeUs = testGetTimeUs();
+        CHECK(values1 == values2);
+
+        printf("  Integer extraction of a sequence of size %d\n", MaxSequenceSize);
+        printf("    Item by item : %.3f Mitem/s\n", (double)MaxSequenceSize / (double)std::max((uint64_t)1, midTimeUs - startTimeUs));
+        printf("    Bulk         : %.3f Mitem/s\n", (double)MaxSequenceSize / (double)std::max((uint64_t)1, endTimeUs - midTimeUs));
+    }
+
+    TEST_CASE("1-Sanity   : Encoding in place")
+    {
+        Document root;
+        root = NodeType::MAP;
+
+        root["color"] = MyColor{255, 128, 0};
+        CHECK(root["color"].as<std::string>() == "rgb(255,128,0)");
+        MyColor color = root["color"].as<MyColor>();
+        CHECK((color.r == 255 && color.g == 128 && color.b == 0));
+
+        root["list"] = NodeType::SEQUENCE;
+        root["list"].push_back(MyColor{1, 2, 3});
+        root["list"].insert(0, std::string("first"));
+        root["list"].push_back(-12.5);
+        root["list"].push_back("last");
+        CHECK(root["list"].asVector<std::string>() == std::vector<std::string>{"first", "rgb(1,2,3)", "-12.5", "last"});
+
+        // Failed encoding leaves the document unchanged
+        CHECK_THROWS_AS(root["black"] = MyColor({0, 0, 0}), AccessException);
+        CHECK(!root.hasKey("black"));
+        CHECK_THROWS_AS(root["list"].push_back(MyColor({0, 0, 0})), AccessException);
+        CHECK(root["list"].size() == 4);
+        CHECK_THROWS_AS(root["color"] = MyColor({0, 0, 0}), AccessException);
+        CHECK(root["color"].as<std::string>() == "rgb(255,128,0)");
+        CHECK(std::string(root.asYaml().c_str()) == "color: rgb(255,128,0)\nlist:\n  - first\n  - rgb(1,2,3)\n  - -12.5\n  - last");
+    }
+
+    TEST_CASE("1-Sanity   : Structural conversions")
+    {
+        Document root;
+        root = NodeType::MAP;
+
+        // Nested containers
+        std::vector<std::vector<int>> matrix = {{1, 2, 3}, {}, {4}};
+        root["matrix"]                       = matrix;
+        CHECK(root["matrix"].isSequence());
+        CHECK(root["matrix"][2][0].as<int>() == 4);
+        CHECK(root["matrix"].as<std::vector<std::vector<int>>>() == matrix);
+        CHECK(root["matrix"].asVector<std::vector<int>>() == matrix);
+
+        std::array<double, 3> vec3 = {1.5, -2., 0.25};
+        root["vec3"]               = vec3;
+        CHECK((root["vec3"].as<std::array<double, 3>>() == vec3));
+        CHECK_THROWS_AS((root["vec3"].as<std::array<double, 2>>()), AccessException);  // Size mismatch
+
+        std::vector<bool> flags = {true, false, true};
+        root["flags"]           = flags;
+        CHECK(root["flags"].as<std::vector<bool>>() == flags);
+        root["literals"] = NodeType::SEQUENCE;
+        for (const char* literal : {"true", "No", "ON", "n"}) { root["literals"].push_back(literal); }
+        CHECK(root["literals"].as<std::vector<bool>>() == std::vector<bool>({true, false, true, false}));
+        CHECK(root["literals"][0].as<bool>());
+        bool decoded[4] = {false, true, false, true};
+        CHECK(root["literals"].copyTo(decoded, 4) == 4);
+        CHECK((decoded[0] && !decoded[1] && decoded[2] && !decoded[3]));
+        root["literals"].push_back("maybe");
+        CHECK_THROWS_AS(root["literals"][4].as<bool>(), AccessException);
+
+        // Maps keep their iteration order in the document
+        std::map<std::string, int> ports = {{"http", 80}, {"https", 443}, {"ssh", 22}};
+        root["ports"]                    = ports;
+        CHECK(root["ports"].isMap());
+        CHECK(root["ports"]["https"].as<int>() == 443);
+        CHECK((root["ports"].as<std::map<std::string, int>>() == ports));
+        CHECK((root["ports"].as<std::unordered_map<std::string, int>>().at("ssh") == 22));
+
+        std::unordered_map<int, std::vector<std::string>> groups = {{1, {"a", "b"}}, {2, {}}};
+        root["groups"]                                           = groups;
+        CHECK(root["groups"]["1"][1].as<std::string>() == "b");
+        CHECK((root["groups"].as<std::unordered_map<int, std::vector<std::string>>>() == groups));
+
+        // Optional, pair and tuple
+        root["none"] = std::optional<int>();
+        root["some"] = std::optional<int>(12);
+        CHECK(!root["none"].as<std::optional<int>>().has_value());
+        CHECK(root["some"].as<std::optional<int>>() == 12);
+        CHECK(root["missing"].as<std::optional<int>>(std::nullopt) == std::nullopt);
+        root["empty"] = std::optional<std::string>("");
+        CHECK(!root["empty"].as<std::optional<std::string>>().has_value());  // An empty encoding is read as absent
+
+        root["pair"] = std::make_pair(std::string("key"), 3.5);
+        CHECK((root["pair"].as<std::pair<std::string, double>>() == std::make_pair(std::string("key"), 3.5)));
+        root["tuple"] = std::make_tuple(1, std::string("two"), MyColor{3, 3, 3});
+        auto tuple    = root["tuple"].as<std::tuple<int, std::string, MyColor>>();
+        CHECK(std::get<0>(tuple) == 1);
+        CHECK(std::get<1>(tuple) == "two");
+        CHECK(std::get<2>(tuple).b == 3);
+        CHECK_THROWS_AS((root["tuple"].as<std::tuple<int, std::string>>()), AccessException);  // Size mismatch
+
+        // Insertions and custom node level converters
+        root["points"] = NodeType::SEQUENCE;
+        root["points"].push_back(MyPoint{1, 2});
+        root["points"].insert(0, MyPoint{0, 0});
+        root["points"].push_back(std::vector<MyPoint>{{5, 6}});
+        CHECK(root["points"][1].as<MyPoint>() == MyPoint{1, 2});
+        CHECK(root["points"][2].as<std::vector<MyPoint>>() == std::vector<MyPoint>{{5, 6}});
+        root["points"].pop_back();
+        CHECK(root["points"].asVector<MyPoint>() == std::vector<MyPoint>{{0, 0}, {1, 2}});
+        root.insert("origin", MyPoint{0, 0});
+        root.beginBatch().insert("a", std::vector<int>{1}).insert("b", MyPoint{3, 4}).commit();
+        CHECK(root["b"].as<MyPoint>() == MyPoint{3, 4});
+
+        // Errors
+        CHECK_THROWS_AS(root["ports"].as<std::vector<int>>(), AccessException);        // Not a sequence
+        CHECK_THROWS_AS((root["matrix"].as<std::map<std::string, int>>()), AccessException);  // Not a map
+        CHECK_THROWS_AS(root["matrix"].as<std::vector<int>>(), AccessException);             // Items are not values
+        CHECK_THROWS_AS(root["none"].as<MyPoint>(), AccessException);
+        CHECK_THROWS_AS(root["unknown"].as<std::vector<int>>(), AccessException);  // Pending key
+
+        // Failed encodings leave the document unchanged
+        std::string yaml = root.asYaml().c_str();
+        CHECK_THROWS_AS((root["colors"] = std::vector<MyColor>{{0, 0, 0}}), AccessException);
+        CHECK(!root.hasKey("colors"));
+        CHECK_THROWS_AS((root["pair"] = std::make_pair(1, MyColor{0, 0, 0})), AccessException);
+        CHECK_THROWS_AS(root["points"].push_back(std::vector<MyColor>{{1, 1, 1}, {0, 0, 0}}), AccessException);
+        CHECK_THROWS_AS(root["points"].insert(0, std::vector<MyColor>{{0, 0, 0}}), AccessException);
+        CHECK_THROWS_AS(root.insert("colors", std::vector<MyColor>{{0, 0, 0}}), AccessException);
+        CHECK(std::string(root.asYaml().c_str()) == yaml);
+        CHECK(root["points"].size() == 2);
+
+        CHECK(std::string(root.asYaml().c_str()).find("\nports:\n  http: 80\n  https: 443\n  ssh: 22\n") != std::string::npos);
+        Document reparsed = parse(root.asYaml().c_str());
+        CHECK(reparsed["matrix"].as<std::vector<std::vector<int>>>() == matrix);
+        CHECK((reparsed["ports"].as<std::map<std::string, int>>() == ports));
+    }
+
+    TEST_CASE("1-Sanity   : Struct binding")
+    {
+        MyCluster cluster{"main", {{"web", 80, 0.5, {"front", "public"}}, {"db", 5432, 1., {}}}, {3, 4}};
+
+        Document root;
+        root         = NodeType::MAP;
+        root["main"] = cluster;
+        CHECK(root["main"]["services"][0]["port"].as<int>() == 80);
+        CHECK(root["main"]["origin"]["y"].as<int>() == 4);
+        CHECK(std::string(root.asYaml().c_str()).find("  services:\n    - name: web\n      port: 80\n") != std::string::npos);
+
+        MyCluster decoded = root["main"].as<MyCluster>();
+        CHECK(decoded.id == "main");
+        CHECK(decoded.services == cluster.services);
+        CHECK(decoded.origin == cluster.origin);
+
+        // Records with different key orders, missing keys and extra keys
+        const char* document = R"END(
+- name: a
+  port: 1
+- port: 2
+  # Comment
+  name: b
+  extra: ignored
+- ratio: 3.5
+-
+)END";
+        Document    parsed   = parse(document);
+        std::vector<MyService> services = parsed.as<std::vector<MyService>>();
+        CHECK(services.size() == 4);
+        CHECK((services[0].name == "a" && services[0].port == 1));
+        CHECK((services[1].name == "b" && services[1].port == 2));
+        CHECK((services[2].name.empty() && services[2].port == 0 && services[2].ratio == 3.5));
+        CHECK(services[3] == MyService());
+
+        // Errors
+        parsed[0]["port"] = "not a number";
+        CHECK_THROWS_AS(parsed.as<std::vector<MyService>>(), AccessException);
+        parsed[1] = "text";
+        CHECK_THROWS_AS(parsed[1].as<MyService>(), AccessException);
+
+        // Lookup with precomputed keys
+        Key      portKey("port");
+        uint32_t childIndexHint = 0;
+        CHECK(!root["main"].find(portKey));
+        CHECK(root["main"]["services"][1].find(portKey, childIndexHint).as<int>() == 5432);
+        CHECK(childIndexHint == 1);
+    }
+
+    TEST_CASE("2-Benchmark: Struct binding")
+    {
+        constexpr int RecordQty = 200000;
+
+        Document root;
+        root = NodeType::SEQUENCE;
+        root.reserve(RecordQty);
+        for (int i = 0; i < RecordQty; ++i) { root.push_back(MyService{"service" + std::to_string(i), i, 0.5 * i, {"a"}}); }
+
+        uint64_t               startTimeUs = testGetTimeUs();
+        std::vector<MyService> manual(RecordQty);
+        for (int i = 0; i < RecordQty; ++i) {
+            Node record     = root[i];
+            manual[i].name  = record["name"].as<std::string>();
+            manual[i].port  = record["port"].as<int>();
+            manual[i].ratio = record["ratio"].as<double>();
+            manual[i].tags  = record["tags"].as<std::vector<std::string>>();
+        }
+        uint64_t               midTimeUs = testGetTimeUs();
+        std::vector<MyService> bound     = root.as<std::vector<MyService>>();
+        uint64_t               endTimeUs = testGetTimeUs();
+        CHECK(manual == bound);
+
+        printf("  Decoding of %d structures\n", RecordQty);
+        printf("    Field by field : %.3f Mitem/s\n", (double)RecordQty / (double)std::max((uint64_t)1, midTimeUs - startTimeUs));
+        printf("    Bound          : %.3f Mitem/s\n", (double)RecordQty / (double)std::max((uint64_t)1, endTimeUs - midTimeUs));
+    }
+
+    TEST_CASE("1-Sanity   : Direct decoding")
+    {
+        const char* document = R"END(
+# Services
+- name: web
+  port: 80
+  tags:
+    - front
+    - public
+- port: 5432
+  extra:
+    - ignored: true
+  name: db
+  ratio: 1.5
+-
+)END";
+
+        // Same result as the decoding through a document
+        std::vector<MyService> services = decode<std::vector<MyService>>(document);
+        CHECK(services == parse(document).as<std::vector<MyService>>());
+        CHECK(services.size() == 3);
+        CHECK(services[0].tags == std::vector<std::string>{"front", "public"});
+        CHECK((services[1].name == "db" && services[1].ratio == 1.5));
+
+        // Containers and values
+        auto groups = decode<std::map<std::string, std::vector<int>>>("a:\n  - 1\n  - 2\nb:\nc: \"\"\n");
+        CHECK(groups["a"] == std::vector<int>{1, 2});
+        CHECK((groups.size() == 3 && groups["b"].empty() && groups["c"].empty()));
+        auto tuple = decode<std::tuple<int, std::string, std::optional<double>>>("- 1\n- two\n- ''\n");
+        CHECK((std::get<0>(tuple) == 1 && std::get<1>(tuple) == "two" && !std::get<2>(tuple)));
+        CHECK(decode<std::array<uint8_t, 2>>("- 1\n- 2\n") == std::array<uint8_t, 2>{1, 2});
+        CHECK(decode<int>("42\n") == 42);
+        CHECK(decode<MyColor>("rgb(1,2,3)\n").b == 3);
+
+        // The object is reused, and its containers are cleared
+        MyService service{"old", 1, 2., {"old"}};
+        const char* patch = "tags:\n  - new\n";
+        decode(patch, (uint32_t)strlen(patch), service);
+        CHECK((service.name == "old" && service.tags == std::vector<std::string>{"new"}));
+
+        // Errors
+        CHECK_THROWS_AS(decode<MyService>("name: a\nname: b\n"), ParseException);  // Duplicated key
+        CHECK_THROWS_AS((decode<std::map<std::string, int>>("a: 1\na: 2\n")), ParseException);
+        CHECK_THROWS_AS(decode<MyService>("port: x\n"), ParseException);        // Not a number
+        CHECK_THROWS_AS(decode<MyService>("port:\n  - 1\n"), ParseException);   // Not a value
+        CHECK_THROWS_AS(decode<MyService>("- 1\n"), ParseException);            // Not a map
+        CHECK_THROWS_AS((decode<std::array<int, 1>>("- 1\n- 2\n")), ParseException);  // Too many items
+        CHECK_THROWS_AS(decode<MyService>("name: a\n  b: c\n"), ParseException);      // Syntax error
+        CHECK(decode<MyService>("port: 7\n").port == 7);                                 // Working memory is reusable after errors
+        CHECK_THROWS_WITH_AS(decode<int>("x\n"), doctest::Contains("Decode error: "), ParseException);
+    }
+
+    TEST_CASE("2-Benchmark: Direct decoding")
+    {
+        constexpr int MessageQty = 100000;
+
+        const char* message = R"END(name: service
+port: 8080
+ratio: 0.75
+tags:
+  - alpha
+  - beta
+)END";
+        uint32_t messageSize = (uint32_t)strlen(message);
+
+        uint64_t  startTimeUs = testGetTimeUs();
+        MyService viaDocument;
+        for (int i = 0; i < MessageQty; ++i) { viaDocument = parse(message, messageSize).as<MyService>(); }
+        uint64_t  midTimeUs = testGetTimeUs();
+        MyService direct;
+        for (int i = 0; i < MessageQty; ++i) { direct = decode<MyService>(message, messageSize); }
+        uint64_t endTimeUs = testGetTimeUs();
+        CHECK(viaDocument == direct);
+
+        printf("  Decoding of %d small messages\n", MessageQty);
+        printf("    Parse and access : %.3f Mitem/s\n", (double)MessageQty / (double)std::max((uint64_t)1, midTimeUs - startTimeUs));
+        printf("    Direct decoding  : %.3f Mitem/s\n", (double)MessageQty / (double)std::max((uint64_t)1, endTimeUs - midTimeUs));
+    }
+}
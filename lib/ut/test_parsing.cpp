@@ -142,5 +142,198 @@ a:
             const char* document = "- a\n\t- b";
             CHECK_PARSING_EXCEPTION("Parse error: using tabulation is not accepted for indentation");
         }
+
+        {
+            // The tab after the trailing indentation is outside the parsed text
+            const char* document = "a:\n  \t";
+            Document    root     = parse(document, 5);
+            CHECK(root["a"].isValue());
+        }
+    }
+}
+
+#define CHECK_SCHEMA_EXCEPTION(messageChunk, lineNbr)                                       \
+    {                                                                                       \
+        bool hasException = false;                                                          \
+        try {                                                                               \
+            Document root = parse(document, schema);                                        \
+        } catch (styml::ParseException & e) {                                               \
+            CHECK(std::string(e.what()).find(messageChunk) != std::string::npos);           \
+            CHECK(std::string(e.what()).find("In line " lineNbr ":") != std::string::npos); \
+            if (false) { printf("What: %s\n", e.what()); }                                  \
+            hasException = true;                                                            \
+        }                                                                                   \
+        CHECK(hasException);                                                                \
+    }
+
+static bool
+isLowercase(std::string_view text)
+{
+    return !text.empty() && std::all_of(text.begin(), text.end(), [](char c) { return c >= 'a' && c <= 'z'; });
+}
+
+TEST_SUITE("Schema")
+{
+    TEST_CASE("1-Sanity   : Schema validation")
+    {
+        Schema schema = Schema::map({{"name", Schema::string()},
+                                     {"port", Schema::integer()},
+                                     Schema::optional("ratio", Schema::floating()),
+                                     Schema::optional("enabled", Schema::boolean()),
+                                     Schema::optional("mode", Schema::enumeration({"fast", "slow"})),
+                                     Schema::optional("tags", Schema::seq(Schema::check(isLowercase, "a lowercase word"))),
+                                     Schema::optional("env", Schema::mapOf(Schema::string())),
+                                     Schema::optional("extra", Schema::any())});
+
+        // Valid documents, keys in any order
+        {
+            const char* document = R"END(
+port: 8080  # Comments are ignored
+name: service
+ratio: 0.5
+enabled: 1
+mode: slow
+tags:
+  - alpha
+  - beta
+env:
+  HOME: /root
+  LEVEL: 3
+extra:
+  - a: b
+  - c
+)END";
+            Document root = parse(document, schema);
+            CHECK(root["port"].as<int>() == 8080);
+            CHECK(root["tags"][1].as<std::string>() == "beta");
+            CHECK(root["extra"][0]["a"].as<std::string>() == "b");
+        }
+        {
+            const char* document = "name: minimal\nport: 1\ntags:\nenv:\n";
+            CHECK(parse(document, schema)["name"].as<std::string>() == "minimal");
+        }
+        {
+            // StrictYAML boolean literals, in any case
+            std::vector<std::pair<std::string, bool>> flags = {{"true", true}, {"False", false}, {"YES", true}, {"no", false},
+                                                               {"on", true},   {"Off", false},   {"y", true},   {"N", false},
+                                                               {"1", true},    {"0", false}};
+            for (const auto& [flag, value] : flags) {
+                Document root = parse("name: a\nport: 1\nenabled: " + flag + "\n", schema);
+                CHECK(root["enabled"].as<bool>() == value);
+            }
+        }
+
+        {
+            std::string document = "name: a\nport: 1\ntags:\n  - " + std::string(100000, 'x') + "\n";  // Long checked string
+            CHECK(parse(document, schema)["tags"][0].as<std::string>().size() == 100000);
+        }
+
+        // Pre-decoded numbers
+        {
+            const char* document = "name: a\nport: -12\nratio: 2.5\n";
+            Document    root     = parse(document, schema, true);
+            CHECK(root["port"].as<int>() == -12);
+            CHECK(root["ratio"].as<double>() == 2.5);
+            root["port"] = 13;
+            CHECK(root["port"].as<int>() == 13);
+        }
+
+        // Invalid documents
+        {
+            const char* document = "name: a\nport: http\n";
+            CHECK_SCHEMA_EXCEPTION("Schema error: an integer is expected, not 'http'", "2");
+        }
+        {
+            const char* document = "name: a\nport: 1\nratio: half\n";
+            CHECK_SCHEMA_EXCEPTION("Schema error: a floating point is expected, not 'half'", "3");
+        }
+        {
+            const char* document = "name: a\nport: 1\nenabled: maybe\n";
+            CHECK_SCHEMA_EXCEPTION("Schema error: a boolean is expected, not 'maybe'", "3");
+        }
+        {
+            const char* document = "name: a\nport: 1\nmode: medium\n";
+            CHECK_SCHEMA_EXCEPTION("Schema error: one of 'fast', 'slow' is expected, not 'medium'", "3");
+        }
+        {
+            const char* document = "name: a\nport: 1\ntags:\n  - abc\n  - Abc\n";
+            CHECK_SCHEMA_EXCEPTION("Schema error: a lowercase word is expected, not 'Abc'", "5");
+        }
+        {
+            const char* document = "name: a\nport: 1\nhost: localhost\n";
+            CHECK_SCHEMA_EXCEPTION("Schema error: the key 'host' is not expected in this map", "3");
+        }
+        {
+            const char* document = "name: a\nratio: 1\n";
+            CHECK_SCHEMA_EXCEPTION("Schema error: the required key 'port' is missing", "2");
+        }
+        {
+            const char* document = "name:\n  - a\nport: 1\n";
+            CHECK_SCHEMA_EXCEPTION("Schema error: a string is expected, not a sequence", "2");
+        }
+        {
+            const char* document = "name: a\nport: 1\nenv:\n  - a\n";
+            CHECK_SCHEMA_EXCEPTION("Schema error: a map is expected, not a sequence", "4");
+        }
+        {
+            const char* document = "- a\n";
+            CHECK_SCHEMA_EXCEPTION("Schema error: a map is expected, not a sequence", "1");
+        }
+        {
+            const char* document = "name: a\nport:\n";
+            CHECK_SCHEMA_EXCEPTION("Schema error: an integer is expected, not ''", "2");
+        }
+        {
+            const char* document = "name: a\nport: 1\nport: 2\n";
+            CHECK_SCHEMA_EXCEPTION("Parse error: duplicated key", "3");
+        }
+
+        // Nested required keys
+        {
+            Schema child  = Schema::map({{"id", Schema::integer()}});
+            Schema nested = Schema::seq(Schema::map({{"id", Schema::integer()}, Schema::optional("child", child)}));
+            CHECK(parse("- id: 1\n  child:\n    id: 2\n- id: 3\n", nested).size() == 2);
+            const char* document = "- id: 1\n  child:\n    other: 2\n";
+            CHECK_THROWS_AS(parse(document, nested), ParseException);
+            try {
+                parse("- id: 1\n  child:\n- id: 2\n", nested);
+                CHECK(false);
+            } catch (ParseException& e) {
+                CHECK(std::string(e.what()).find("the required key 'id' is missing, as the map is empty") != std::string::npos);
+            }
+            try {
+                parse("- child:\n    id: 2\n- id: 3\n", nested);
+                CHECK(false);
+            } catch (ParseException& e) {
+                CHECK(std::string(e.what()).find("the required key 'id' is missing") != std::string::npos);
+            }
+        }
+
+        CHECK_THROWS_AS(Schema::map({{"a", Schema::string()}, {"a", Schema::integer()}}), AccessException);
+    }
+
+    TEST_CASE("2-Benchmark: Schema validation")
+    {
+        constexpr int ItemQty = 100000;
+
+        std::string document;
+        for (int i = 0; i < ItemQty; ++i) {
+            document += "- name: item" + std::to_string(i) + "\n  port: " + std::to_string(i) + "\n  ratio: 0.25\n  mode: fast\n";
+        }
+        Schema schema = Schema::seq(Schema::map({{"name", Schema::string()},
+                                                 {"port", Schema::integer()},
+                                                 {"ratio", Schema::floating()},
+                                                 {"mode", Schema::enumeration({"fast", "slow"})}}));
+
+        uint64_t startTimeUs = testGetTimeUs();
+        Document plain       = parse(document);
+        uint64_t midTimeUs   = testGetTimeUs();
+        Document validated   = parse(document, schema);
+        uint64_t endTimeUs   = testGetTimeUs();
+        CHECK(plain.size() == validated.size());
+
+        printf("  Parsing of %d items\n", ItemQty);
+        printf("    Without schema : %.3f Mitem/s\n", (double)ItemQty / (double)std::max((uint64_t)1, midTimeUs - startTimeUs));
+        printf("    With schema    : %.3f Mitem/s\n", (double)ItemQty / (double)std::max((uint64_t)1, endTimeUs - midTimeUs));
     }
 }